@@ -5,6 +5,15 @@ uniform sampler2D charge_tex;
 uniform sampler2D radius_tex;
 uniform sampler2D parent_id_tex;
 uniform sampler2D temperature_tex;
+uniform sampler2D type_tex; // Atom::Type, -1 for atoms whose radius doesn't match the force table rows
+uniform sampler2D force_table_tex; // x: vdW force / distance, y: Coulomb kernel / distance, rows: type pairs
+
+uniform bool use_force_table;
+uniform int force_table_num_samples;
+uniform int force_table_num_types;
+uniform vec2 force_table_range; // min and max squared distance
+uniform float force_table_coulomb_strength;
+uniform float force_table_vdw_strength; // 0 when the vdW force is disabled
 
 uniform vec2 tex_size;
 uniform int num_atoms;
@@ -16,6 +25,8 @@ layout(location = 0) out vec3 out_force;
 uniform float coulomb_factor; // = 155.0;
 uniform float vdw_factor; // = 2.0;
 uniform float vdw_radius_factor; // = 1.4;
+uniform float wendland_strength; // 0 when Wendland_force is disabled
+uniform float wendland_radius;
 
 const float pi = 3.141592;
 
@@ -30,13 +41,33 @@ float calc_coulomb_force(float distance, float charge_0, float charge_1)
     return coulomb_factor * charge_0 * charge_1 / (distance * distance);
 }
 
-float calc_van_der_waals_force(float distance, float radius_0, float radius_1)
+float calc_van_der_waals_force(float distance, float radius_0, float radius_1, float strength)
 {
     float vdw_radii = radius_0 + radius_1;
     float sigma = vdw_radius_factor * vdw_radii;
     float sigma_distance = sigma / distance;
     float pow_6 = sigma_distance * sigma_distance * sigma_distance * sigma_distance * sigma_distance * sigma_distance;
-    return vdw_factor * 4.0 * (pow_6 * pow_6 - pow_6);
+    return strength * 4.0 * (pow_6 * pow_6 - pow_6);
+}
+
+// same as Wendland_force::calc_force_magnitude()
+float calc_wendland_force(float distance, float charge_0, float charge_1)
+{
+    float x = distance / wendland_radius;
+    float a = 1.0 - x;
+    return charge_0 * charge_1 * wendland_strength * max(0.0, a * a * a * (3.0 * x + 1.0));
+}
+
+vec2 lookup_force_table(float distance_2, int type_0, int type_1)
+{
+    float t = clamp((distance_2 - force_table_range.x) / (force_table_range.y - force_table_range.x), 0.0, 1.0);
+    float num_samples = float(force_table_num_samples);
+    float num_rows = float(force_table_num_types * force_table_num_types);
+
+    vec2 table_coord = vec2((t * (num_samples - 1.0) + 0.5) / num_samples,
+                            (float(type_0 * force_table_num_types + type_1) + 0.5) / num_rows);
+
+    return texture(force_table_tex, table_coord).xy;
 }
 
 void main(void)
@@ -52,6 +83,7 @@ void main(void)
     float charge_receiver = texture2D(charge_tex, receiver_frag_coord).x;
     float radius_receiver = texture2D(radius_tex, receiver_frag_coord).x;
     int receiver_parent_id = int(texture2D(parent_id_tex, receiver_frag_coord).x);
+    int receiver_type = use_force_table ? int(floor(texture2D(type_tex, receiver_frag_coord).x + 0.5)) : 0;
 //    uint receiver_parent_id = texture(parent_id_tex, receiver_frag_coord).x;
 
     vec3 force = vec3(0.0, 0.0, 0.0);
@@ -79,6 +111,46 @@ void main(void)
         float radius_sender = texture2D(radius_tex, sender_frag_coord).x;
 
         vec3 direction = pos_receiver - pos_sender;
+
+        if (use_force_table)
+        {
+            float distance_2 = dot(direction, direction);
+
+            if (distance_2 < 0.000001) continue;
+
+            // not in the table
+            if (wendland_strength != 0.0 && distance_2 < wendland_radius * wendland_radius)
+            {
+                float distance = sqrt(distance_2);
+                force += direction * (calc_wendland_force(distance, charge_sender, charge_receiver) / distance);
+            }
+
+            if (distance_2 < force_table_range.y)
+            {
+                int sender_type = int(floor(texture2D(type_tex, sender_frag_coord).x + 0.5));
+
+                if (receiver_type < 0 || sender_type < 0)
+                {
+                    // same as Force_table::calc_analytic(), no vdW for Atom::Type::Charge (0)
+                    float distance = sqrt(distance_2);
+                    float vdw = (receiver_type == 0 || sender_type == 0) ? 0.0 : calc_van_der_waals_force(distance, radius_sender, radius_receiver, force_table_vdw_strength) / distance;
+                    force += direction * (vdw + force_table_coulomb_strength * charge_sender * charge_receiver / (distance_2 * distance));
+                }
+                else
+                {
+                    vec2 table_force = lookup_force_table(distance_2, receiver_type, sender_type);
+                    force += direction * (table_force.x + charge_sender * charge_receiver * table_force.y);
+                }
+            }
+            else
+            {
+                // outside of the table only the Coulomb tail is relevant
+                force += direction * (force_table_coulomb_strength * charge_sender * charge_receiver / (distance_2 * sqrt(distance_2)));
+            }
+
+            continue;
+        }
+
         float distance = length(direction);
 
         if (distance < 0.001) continue;
@@ -86,7 +158,12 @@ void main(void)
         direction = normalize(direction);
 
         force += direction * calc_coulomb_force(distance, charge_sender, charge_receiver);
-        force += direction * calc_van_der_waals_force(distance, radius_sender, radius_receiver);
+        force += direction * calc_van_der_waals_force(distance, radius_sender, radius_receiver, vdw_factor);
+
+        if (wendland_strength != 0.0)
+        {
+            force += direction * calc_wendland_force(distance, charge_sender, charge_receiver);
+        }
     }
 
     // temperature contribution
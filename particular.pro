@@ -28,6 +28,11 @@ CONFIG += \
 #DEFINES += EIGEN_DONT_VECTORIZE
 DEFINES += EIGEN_DISABLE_UNALIGNED_ARRAY_ASSERT
 
+# qmake CONFIG+=profiling enables the PROFILE_ZONE instrumentation, see Profiler.h
+profiling {
+    DEFINES += PARTICULAR_PROFILING
+}
+
 win32 {
     DEFINES += NOMINMAX BOOST_ALL_NO_LIB
 }
@@ -84,6 +89,18 @@ SOURCES += \
     src/Main_game_screen.cpp \
     src/Main_menu_screen.cpp \
     src/Screen.cpp \
+    src/Profiler.cpp \
+    src/Memory_accounting.cpp \
+    src/Input_recording.cpp \
+    src/Level_io.cpp \
+    src/Level_cache.cpp \
+    src/Texture_cache.cpp \
+    src/Asset_preloader.cpp \
+    src/Checkpoint_buffer.cpp \
+    src/Rewind_buffer.cpp \
+    src/Trajectory.cpp \
+    src/Playback_screen.cpp \
+    src/Performance_hud.cpp \
     src/Before_start_screen.cpp \
     src/Main_options_screen.cpp \
     src/After_finish_screen.cpp \
@@ -106,6 +123,8 @@ SOURCES += \
     src/Draggable_event.cpp \
     src/Level_element_draw_visitor.cpp \
     src/GPU_force.cpp \
+    src/Force_table.cpp \
+    src/Force_field.cpp \
     src/level_picker_screen.cpp \
     src/Picking.cpp \
     src/Icosphere.cpp \
@@ -153,6 +172,9 @@ HEADERS += \
     src/Renderer.h \
     src/GPU_force.h \
     src/Atomic_force.h \
+    src/Force_table.h \
+    src/Force_field.h \
+    src/Atom_soa.h \
 #    src/RegularBspTree.h \
     src/Draggable.h \
     src/Visitor.h \
@@ -160,6 +182,7 @@ HEADERS += \
     src/Eigen_Matrix_serializer.h \
     src/End_condition.h \
     src/Level_data.h \
+    src/Level_element_exports.h \
     src/Particle_system.h \
     src/unique_ptr_serialization.h \
     src/Sensor_data.h \
@@ -188,6 +211,22 @@ HEADERS += \
     src/Draggable_event.h \
     src/Random_generator.h \
     src/Fps.h \
+    src/Profiler.h \
+    src/Timing_window.h \
+    src/Time_series.h \
+    src/Memory_accounting.h \
+    src/Input_recording.h \
+    src/Level_io.h \
+    src/Level_cache.h \
+    src/Texture_cache.h \
+    src/Asset_preloader.h \
+    src/Checkpoint_buffer.h \
+    src/Rewind_buffer.h \
+    src/Trajectory.h \
+    src/Spsc_queue.h \
+    src/Mpsc_queue.h \
+    src/Playback_screen.h \
+    src/Performance_hud.h \
     src/level_picker_screen.h \
     src/widget_text_combination.h \
     src/FloatSlider.h \
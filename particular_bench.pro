@@ -0,0 +1,16 @@
+# Microbenchmarks of the physics kernels, see src/bench_main.cpp
+
+cache()
+
+TEMPLATE = app
+TARGET = particular_bench
+DEPENDPATH += src
+
+include(src/headless.pri)
+
+SOURCES += \
+    src/bench_main.cpp
+
+HEADERS += \
+    src/Spatial_hash.h \
+    src/RegularBspTree.h
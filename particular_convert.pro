@@ -0,0 +1,12 @@
+# Level file converter (XML <-> binary), see src/convert_main.cpp
+
+cache()
+
+TEMPLATE = app
+TARGET = particular_convert
+DEPENDPATH += src
+
+include(src/headless.pri)
+
+SOURCES += \
+    src/convert_main.cpp
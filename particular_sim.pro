@@ -0,0 +1,12 @@
+# Headless simulation runner, see src/sim_main.cpp
+
+cache()
+
+TEMPLATE = app
+TARGET = particular_sim
+DEPENDPATH += src
+
+include(src/headless.pri)
+
+SOURCES += \
+    src/sim_main.cpp
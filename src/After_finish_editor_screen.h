@@ -9,6 +9,7 @@ class After_finish_editor_screen : public Menu_screen
 {
 public:
     After_finish_editor_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "After_finish_editor_screen"; }
 
     void init();
 
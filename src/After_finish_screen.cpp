@@ -5,6 +5,7 @@
 #include "Before_start_screen.h"
 #include "Main_menu_screen.h"
 #include "Editor_screen.h"
+#include "Message_logger.h"
 
 After_finish_screen::After_finish_screen(My_viewer &viewer, Core &core, Main_game_screen::Ui_state const ui_state) : Menu_screen(viewer, core), _animate_score_time(-1.0f)
 {
@@ -160,7 +161,7 @@ void After_finish_screen::init(Main_game_screen::Ui_state const ui_state)
 
         if (is_new_highscore)
         {
-            std::cout << __FUNCTION__ << " new highscore" <<  std::endl;
+            LOG_INFO("new highscore");
         }
 
         scores.push_back(_score);
@@ -9,6 +9,7 @@ class After_finish_screen : public Menu_screen
 {
 public:
     After_finish_screen(My_viewer & viewer, Core & core, Main_game_screen::Ui_state const ui_state);
+    char const* get_name() const override { return "After_finish_screen"; }
 
     void init(Main_game_screen::Ui_state const ui_state);
 
@@ -0,0 +1,161 @@
+#include "Asset_preloader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+#include "Data_config.h"
+#include "GL_utilities.h"
+#include "Texture_cache.h"
+#include "Message_logger.h"
+
+
+namespace
+{
+
+// used by the renderers, the draw visitors and the UI renderer when the first screens are created
+char const* const Startup_meshes[] =
+{
+    "meshes/icosphere_3.obj",
+    "meshes/grid_10x10.obj",
+    "meshes/grid_cube.obj",
+    "meshes/bg_hemisphere.obj",
+    "meshes/molecule_releaser.obj",
+    "meshes/tractor_circle.obj"
+};
+
+char const* const Startup_textures[] =
+{
+    "textures/ice_texture.png",
+    "textures/iss_interior_1.png",
+    "textures/iss_interior_1_blurred.png",
+    "textures/background_grid.png",
+    "textures/molecule_releaser.png"
+};
+
+char const* const Startup_alpha_textures[] =
+{
+    "textures/brownian_panel.png",
+    "textures/tractor_panel.png",
+    "textures/panel_charged_barrier.png",
+    "textures/particle.png",
+    "textures/spinbox_arrowup.png",
+    "textures/spinbox_arrowdown.png"
+};
+
+}
+
+
+Asset_preloader *Asset_preloader::get_instance()
+{
+    static Asset_preloader * const instance = new Asset_preloader;
+
+    return instance;
+}
+
+Asset_preloader::Asset_preloader() :
+    _start_time(std::chrono::steady_clock::now())
+{ }
+
+void Asset_preloader::start()
+{
+    _start_time = std::chrono::steady_clock::now();
+
+    Data_config const* data_config = Data_config::get_instance();
+
+    QStringList shader_file_names;
+
+    for (QString const& name : QDir(data_config->get_absolute_qfilename("shaders")).entryList(QStringList() << "*.vert" << "*.frag" << "*.geom", QDir::Files))
+    {
+        shader_file_names.push_back(data_config->get_absolute_qfilename("shaders/" + name));
+    }
+
+    std::vector<std::string> mesh_file_names;
+
+    for (char const* name : Startup_meshes)
+    {
+        mesh_file_names.push_back(data_config->get_absolute_filename(name));
+    }
+
+    _shader_sources = std::async(std::launch::async, &Asset_preloader::read_shader_sources, shader_file_names).share();
+    set_shader_source_reader([this](QString const& file_name) { return get_shader_source(file_name); });
+    _meshes = std::async(std::launch::async, &Asset_preloader::load_meshes, mesh_file_names).share();
+
+    for (char const* name : Startup_textures)
+    {
+        Texture_cache::get_instance()->prefetch(data_config->get_absolute_qfilename(name));
+    }
+
+    for (char const* name : Startup_alpha_textures)
+    {
+        Texture_cache::get_instance()->prefetch(data_config->get_absolute_qfilename(name), Texture_options::alpha());
+    }
+}
+
+MyMesh Asset_preloader::get_mesh(const std::string &file_name)
+{
+    if (_meshes.valid())
+    {
+        Mesh_map const& meshes = _meshes.get();
+        Mesh_map::const_iterator const iter = meshes.find(file_name);
+
+        if (iter != meshes.end()) return iter->second;
+    }
+
+    return load_mesh<MyMesh>(file_name);
+}
+
+QByteArray Asset_preloader::get_shader_source(const QString &file_name)
+{
+    if (_shader_sources.valid())
+    {
+        Shader_source_map const& sources = _shader_sources.get();
+        Shader_source_map::const_iterator const iter = sources.find(file_name);
+
+        if (iter != sources.end()) return iter->second;
+    }
+
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LOG_WARNING("Couldn't read shader " << file_name.toStdString());
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+float Asset_preloader::get_time_since_start() const
+{
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _start_time).count();
+}
+
+Asset_preloader::Mesh_map Asset_preloader::load_meshes(const std::vector<std::string> &file_names)
+{
+    Mesh_map meshes;
+
+    for (std::string const& file_name : file_names)
+    {
+        meshes[file_name] = load_mesh<MyMesh>(file_name);
+    }
+
+    return meshes;
+}
+
+Asset_preloader::Shader_source_map Asset_preloader::read_shader_sources(const QStringList &file_names)
+{
+    Shader_source_map sources;
+
+    for (QString const& file_name : file_names)
+    {
+        QFile file(file_name);
+
+        if (file.open(QIODevice::ReadOnly))
+        {
+            sources[file_name] = file.readAll();
+        }
+    }
+
+    return sources;
+}
@@ -0,0 +1,51 @@
+#ifndef ASSET_PRELOADER_H
+#define ASSET_PRELOADER_H
+
+#include <chrono>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "MyOpenMesh.h"
+
+// Startup pipeline: start() reads the shader sources and parses the OBJ meshes on worker threads and has the
+// Texture_cache decode the textures of the first screens, while the GL context and the screens are set up.
+// The renderers ask for meshes here and init_program() for shader sources (set_shader_source_reader()), they get
+// the prefetched data or, for anything not in the startup set, read it themselves. Compiling shaders and uploading
+// meshes and textures stays on the thread of the GL context. get_mesh() and get_shader_source() are for the GUI thread.
+class Asset_preloader
+{
+public:
+    static Asset_preloader * get_instance();
+
+    // also the reference point of get_time_since_start()
+    void start();
+
+    // copies, the renderers keep and modify their meshes
+    MyMesh get_mesh(std::string const& file_name);
+    QByteArray get_shader_source(QString const& file_name);
+
+    float get_time_since_start() const; // ms
+
+private:
+    Asset_preloader();
+
+    typedef std::map<std::string, MyMesh> Mesh_map;
+    typedef std::map<QString, QByteArray> Shader_source_map;
+
+    // sequentially, the OpenMesh readers aren't thread safe
+    static Mesh_map load_meshes(std::vector<std::string> const& file_names);
+    static Shader_source_map read_shader_sources(QStringList const& file_names);
+
+    std::chrono::steady_clock::time_point _start_time;
+
+    std::shared_future<Mesh_map> _meshes;
+    std::shared_future<Shader_source_map> _shader_sources;
+};
+
+#endif // ASSET_PRELOADER_H
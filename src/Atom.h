@@ -16,6 +16,7 @@
 #include "Color.h"
 #include "Eigen_Matrix_serializer.h"
 #include "Level_element.h"
+#include "Message_logger.h"
 
 typedef OpenMesh::Vec3f Vec;
 
@@ -81,6 +82,13 @@ public:
         return a;
     }
 
+    static Atom create_nitrogen(Eigen::Vector3f const& position)
+    {
+        Atom a(position, 14.01f, 0.0f, 155.0f / 100.f);
+        a._type = Type::N;
+        return a;
+    }
+
     static Atom create_natrium(Eigen::Vector3f const& position)
     {
         Atom a(position, 22.99f, 1.0f, 227.0f / 100.f);
@@ -267,7 +275,7 @@ public:
 
     Molecule()
     {
-        std::cout << "Molecule() should not be used outside serialization" << std::endl;
+        LOG_WARNING("Molecule() should not be used outside serialization");
     }
 
 private:
@@ -0,0 +1,241 @@
+#ifndef ATOM_SOA_H
+#define ATOM_SOA_H
+
+#include <vector>
+#include <list>
+
+#include <Eigen/Core>
+
+#include "Atom.h"
+
+// Structure-of-arrays views on atoms for the batch force kernels (Atomic_force::calc_forces()).
+// The spans don't own anything, Atom_soa and Force_soa hold the storage.
+
+struct Atom_span
+{
+    float const* x;
+    float const* y;
+    float const* z;
+    float const* charge;
+    float const* radius;
+    int const* type;
+    int const* parent_id;
+    int size;
+
+    Atom_span sub_span(int const offset, int const count) const
+    {
+        assert(offset + count <= size);
+
+        Atom_span result = { x + offset, y + offset, z + offset, charge + offset, radius + offset, type + offset, parent_id + offset, count };
+        return result;
+    }
+};
+
+struct Force_span
+{
+    float * x;
+    float * y;
+    float * z;
+    int size;
+
+    Force_span sub_span(int const offset, int const count) const
+    {
+        assert(offset + count <= size);
+
+        Force_span result = { x + offset, y + offset, z + offset, count };
+        return result;
+    }
+};
+
+// the per-atom properties the force kernels read, so a kernel can be written once for Atom and for spans
+struct Atom_span_element
+{
+    Atom_span_element(Atom_span const& span, int const i) :
+        _charge(span.charge[i]), _radius(span.radius[i]), _type(Atom::Type(span.type[i]))
+    { }
+
+    float _charge;
+    float _radius;
+    Atom::Type _type;
+};
+
+
+class Atom_soa
+{
+public:
+    void clear()
+    {
+        _x.clear();
+        _y.clear();
+        _z.clear();
+        _charge.clear();
+        _radius.clear();
+        _type.clear();
+        _parent_id.clear();
+    }
+
+    void reserve(int const size)
+    {
+        _x.reserve(size);
+        _y.reserve(size);
+        _z.reserve(size);
+        _charge.reserve(size);
+        _radius.reserve(size);
+        _type.reserve(size);
+        _parent_id.reserve(size);
+    }
+
+    void add(Atom const& a)
+    {
+        Eigen::Vector3f const& p = a.get_position();
+
+        _x.push_back(p[0]);
+        _y.push_back(p[1]);
+        _z.push_back(p[2]);
+        _charge.push_back(a._charge);
+        _radius.push_back(a._radius);
+        _type.push_back(int(a._type));
+        _parent_id.push_back(a._parent_id);
+    }
+
+    // atoms in the same order as the force vectors returned by GPU_force::calc_forces()
+    void assign(std::list<Molecule> const& molecules)
+    {
+        clear();
+
+        for (Molecule const& m : molecules)
+        {
+            for (Atom const& a : m._atoms)
+            {
+                add(a);
+            }
+        }
+    }
+
+    int size() const { return int(_x.size()); }
+
+    size_t get_memory_usage() const
+    {
+        return _x.capacity() * sizeof(float) * 5 + _type.capacity() * sizeof(int) * 2;
+    }
+
+    Atom_span get_span() const
+    {
+        Atom_span result = { _x.data(), _y.data(), _z.data(), _charge.data(), _radius.data(), _type.data(), _parent_id.data(), size() };
+        return result;
+    }
+
+private:
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _z;
+    std::vector<float> _charge;
+    std::vector<float> _radius;
+    std::vector<int> _type;
+    std::vector<int> _parent_id;
+};
+
+
+class Force_soa
+{
+public:
+    void resize(int const size)
+    {
+        _x.resize(size);
+        _y.resize(size);
+        _z.resize(size);
+    }
+
+    void set_zero()
+    {
+        std::fill(_x.begin(), _x.end(), 0.0f);
+        std::fill(_y.begin(), _y.end(), 0.0f);
+        std::fill(_z.begin(), _z.end(), 0.0f);
+    }
+
+    int size() const { return int(_x.size()); }
+
+    size_t get_memory_usage() const
+    {
+        return _x.capacity() * sizeof(float) * 3;
+    }
+
+    Eigen::Vector3f get(int const i) const
+    {
+        return Eigen::Vector3f(_x[i], _y[i], _z[i]);
+    }
+
+    Force_span get_span()
+    {
+        Force_span result = { _x.data(), _y.data(), _z.data(), size() };
+        return result;
+    }
+
+    // AoS copy in the layout Core::compute_force_and_torque() expects
+    void to_vectors(std::vector<Eigen::Vector3f> & forces) const
+    {
+        forces.resize(_x.size());
+
+        for (size_t i = 0; i < _x.size(); ++i)
+        {
+            forces[i] = Eigen::Vector3f(_x[i], _y[i], _z[i]);
+        }
+    }
+
+private:
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _z;
+};
+
+
+// Adds the force of every sender on every receiver to forces, pairs of the same molecule are skipped.
+// kernel(distance, Atom_span_element const& receiver, Atom_span_element const& sender) returns the
+// force magnitude along the sender -> receiver direction, like Atomic_force::calc_force().
+// The inner loop is branch-free apart from the selects, so it can be vectorized.
+template <class Kernel>
+void accumulate_pair_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces, Kernel const& kernel)
+{
+    assert(receivers.size == forces.size);
+
+    for (int i = 0; i < receivers.size; ++i)
+    {
+        float const r_x = receivers.x[i];
+        float const r_y = receivers.y[i];
+        float const r_z = receivers.z[i];
+        int const r_parent_id = receivers.parent_id[i];
+
+        Atom_span_element const receiver(receivers, i);
+
+        float f_x = 0.0f;
+        float f_y = 0.0f;
+        float f_z = 0.0f;
+
+        for (int j = 0; j < senders.size; ++j)
+        {
+            float const d_x = r_x - senders.x[j];
+            float const d_y = r_y - senders.y[j];
+            float const d_z = r_z - senders.z[j];
+
+            float const distance_2 = d_x * d_x + d_y * d_y + d_z * d_z;
+            float const norm = std::sqrt(distance_2);
+            float const distance = std::max(1e-5f, norm); // the kernel also runs for skipped pairs, keep it finite
+
+            float const magnitude = kernel(distance, receiver, Atom_span_element(senders, j));
+
+            // same cut-off as force_calc.frag and Force_table (distance < 0.001)
+            bool const skip = (senders.parent_id[j] == r_parent_id || distance_2 < 1e-6f);
+            float const force_over_norm = skip ? 0.0f : magnitude / norm;
+
+            f_x += d_x * force_over_norm;
+            f_y += d_y * force_over_norm;
+            f_z += d_z * force_over_norm;
+        }
+
+        forces.x[i] += f_x;
+        forces.y[i] += f_y;
+        forces.z[i] += f_z;
+    }
+}
+
+#endif // ATOM_SOA_H
@@ -2,6 +2,7 @@
 #define ATOMIC_FORCE_H
 
 #include "Atom.h"
+#include "Atom_soa.h"
 
 class Atomic_force
 {
@@ -33,6 +34,21 @@ public:
         return force;
     }
 
+    // batch version of calc_force_between_atoms(), adds the forces of all senders on each receiver to forces
+    virtual void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const = 0;
+
+protected:
+    // evaluates the derived class' calc_force_magnitude() with accumulate_pair_forces(), call from calc_forces()
+    template <class Force>
+    static void calc_forces_with_kernel(Force const& force, Atom_span const& receivers, Atom_span const& senders, Force_span const& forces)
+    {
+        accumulate_pair_forces(receivers, senders, forces,
+                               [&force](float const distance, Atom_span_element const& a_0, Atom_span_element const& a_1)
+        {
+            return force.calc_force_magnitude(distance, a_0, a_1);
+        });
+    }
+
 private:
     virtual float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const = 0;
 };
@@ -56,6 +72,9 @@ public:
         return parameters;
     }
 
+    void calc_forces(Atom_span const& , Atom_span const& , Force_span const& ) const override
+    { }
+
 private:
     float calc_force(float const , Atom const& , Atom const& ) const override
     {
@@ -102,16 +121,28 @@ public:
         return parameters;
     }
 
-private:
     // http://en.wikipedia.org/wiki/Coulomb's_law
 
     // k_e * q1 * q2 * dir / distance**2
 
-    float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const override
+    // non-virtual so Force_field and the batch kernels can inline it, Atom_type is Atom or Atom_span_element
+    template <class Atom_type>
+    float calc_force_magnitude(float const distance, Atom_type const& a_0, Atom_type const& a_1) const
     {
         return _strength * a_0._charge * a_1._charge / (distance * distance);
     }
 
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const override
+    {
+        calc_forces_with_kernel(*this, receivers, senders, forces);
+    }
+
+private:
+    float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const override
+    {
+        return calc_force_magnitude(distance, a_0, a_1);
+    }
+
     float _strength;
 };
 
@@ -125,6 +156,11 @@ public:
         return "Wendland_force";
     }
 
+    std::string get_instance_name() const override
+    {
+        return name();
+    }
+
     static Atomic_force * create()
     {
         return new Wendland_force;
@@ -150,17 +186,28 @@ public:
         return parameters;
     }
 
+    template <class Atom_type>
+    float calc_force_magnitude(float const distance, Atom_type const& a_0, Atom_type const& a_1) const
+    {
+        return a_0._charge * a_1._charge * _strength * std::max(0.0f, wendland_2_1(distance / _radius));
+    }
+
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const override
+    {
+        calc_forces_with_kernel(*this, receivers, senders, forces);
+    }
+
 private:
     float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const override
     {
-        return a_0._charge * a_1._charge * _strength * std::max(0.0f, wendland_2_1(distance / _radius));
+        return calc_force_magnitude(distance, a_0, a_1);
     }
 
     float _strength;
     float _radius;
 };
 
-//REGISTER_CLASS_WITH_PARAMETERS(Atomic_force, Wendland_force);
+REGISTER_CLASS_WITH_PARAMETERS(Atomic_force, Wendland_force);
 
 class Lennard_jones_force : public Atomic_force
 {
@@ -201,8 +248,8 @@ public:
         return parameters;
     }
 
-private:
-    float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const override
+    template <class Atom_type>
+    float calc_force_magnitude(float const distance, Atom_type const& a_0, Atom_type const& a_1) const
     {
         if (a_0._type == Atom::Type::Charge || a_1._type == Atom::Type::Charge) return 0.0f;
 
@@ -214,6 +261,17 @@ private:
         return _strength * 4.0f * (pow_6 * pow_6 - pow_6);
     }
 
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const override
+    {
+        calc_forces_with_kernel(*this, receivers, senders, forces);
+    }
+
+private:
+    float calc_force(float const distance, Atom const& a_0, Atom const& a_1) const override
+    {
+        return calc_force_magnitude(distance, a_0, a_1);
+    }
+
     float _strength;
     float _radius_factor;
 };
@@ -5,7 +5,8 @@
 #include "Main_menu_screen.h"
 
 
-Before_start_screen::Before_start_screen(My_viewer &viewer, Core &core) : Menu_screen(viewer, core)
+Before_start_screen::Before_start_screen(My_viewer &viewer, Core &core) : Menu_screen(viewer, core),
+    _loading_percent(-1)
 {
     _type = Screen::Type::Modal;
 
@@ -40,6 +41,10 @@ void Before_start_screen::init()
         _renderer.generate_button_texture(button.get());
     }
 
+    _loading_label = boost::shared_ptr<Draggable_label>(new Draggable_label(Eigen::Vector3f(0.5f, 0.5f, 0.0f), Eigen::Vector2f(0.3f, 0.06f), ""));
+    _labels.push_back(_loading_label);
+    update_loading_label();
+
     _particle_system = Targeted_particle_system(3.0f);
     _particle_system.generate(_core.get_level_base_name(_core.get_current_level_index()), _viewer.get_particle_font(), QRectF(0.0f, 0.1f, 1.0f, 0.3f), _renderer.get_aspect_ratio());
 //    _particle_system.generate(QString("LEVEL %1").arg(_core.get_current_level_index() + 1).toStdString(), _viewer.get_particle_font(), QRectF(0.0f, 0.1f, 1.0f, 0.3f), _renderer.get_aspect_ratio());
@@ -60,6 +65,8 @@ void Before_start_screen::return_to_main_menu()
 
 void Before_start_screen::start_level()
 {
+    if (_core.is_level_loading()) return;
+
     _core.start_level();
 
     for (Targeted_particle & p : _particle_system.get_particles())
@@ -76,4 +83,23 @@ void Before_start_screen::update_event(const float time_step)
     Menu_screen::update_event(time_step);
 
     _particle_system.animate(time_step);
+
+    update_loading_label();
+}
+
+void Before_start_screen::update_loading_label()
+{
+    int const percent = _core.is_level_loading() ? int(_core.get_level_loading_progress() * 100.0f) : 100;
+
+    if (percent == _loading_percent) return;
+
+    _loading_percent = percent;
+
+    _loading_label->set_visible(percent < 100);
+
+    if (percent < 100)
+    {
+        _loading_label->set_text(QString("Loading %1%").arg(percent).toStdString());
+        _renderer.generate_label_texture(_loading_label.get());
+    }
 }
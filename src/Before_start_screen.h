@@ -7,6 +7,7 @@ class Before_start_screen : public Menu_screen
 {
 public:
     Before_start_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "Before_start_screen"; }
 
     void draw() override;
 
@@ -18,7 +19,13 @@ public:
     void update_event(const float time_step) override;
 
 private:
+    void update_loading_label();
+
     Targeted_particle_system _particle_system;
+
+    // progress of the asynchronous level load, hidden when the level is ready
+    boost::shared_ptr<Draggable_label> _loading_label;
+    int _loading_percent;
 };
 
 
@@ -0,0 +1,49 @@
+#include "Checkpoint_buffer.h"
+
+#include "Atom.h"
+
+
+Checkpoint_buffer::Checkpoint_buffer() :
+    _num_molecules(0)
+{ }
+
+Checkpoint_buffer::~Checkpoint_buffer()
+{ }
+
+void Checkpoint_buffer::clear()
+{
+    _bytes.clear();
+    _num_molecules = 0;
+}
+
+size_t Checkpoint_buffer::get_memory_usage() const
+{
+    size_t result = _bytes.capacity();
+
+    for (std::unique_ptr<Molecule> const& m : _molecules)
+    {
+        result += sizeof(Molecule) + m->_atoms.capacity() * sizeof(Atom);
+    }
+
+    return result;
+}
+
+void Checkpoint_buffer::write_molecule(const Molecule &molecule)
+{
+    if (_num_molecules < _molecules.size())
+    {
+        *_molecules[_num_molecules] = molecule;
+    }
+    else
+    {
+        _molecules.push_back(std::unique_ptr<Molecule>(new Molecule(molecule)));
+    }
+
+    ++_num_molecules;
+}
+
+
+const Molecule &Checkpoint_reader::read_molecule()
+{
+    return *_buffer._molecules[_molecule_position++];
+}
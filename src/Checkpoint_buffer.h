@@ -0,0 +1,92 @@
+#ifndef CHECKPOINT_BUFFER_H
+#define CHECKPOINT_BUFFER_H
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+class Molecule;
+
+// Flat storage for the runtime state of the level elements in Core's simulation checkpoints. Plain values
+// (PODs and fixed size Eigen types) are appended as bytes, molecules are copied into a side list. clear() keeps
+// the allocations, so taking a checkpoint again doesn't allocate for the same level.
+class Checkpoint_buffer
+{
+public:
+    Checkpoint_buffer();
+    ~Checkpoint_buffer();
+
+    void clear();
+
+    size_t get_size() const { return _bytes.size(); }
+    size_t get_num_molecules() const { return _num_molecules; }
+    size_t get_memory_usage() const;
+
+    template <typename T>
+    void write(T const& value)
+    {
+        size_t const position = _bytes.size();
+        _bytes.resize(position + sizeof(T));
+        std::memcpy(&_bytes[position], &value, sizeof(T));
+    }
+
+    template <typename T>
+    void write_vector(std::vector<T> const& values)
+    {
+        write(values.size());
+
+        if (values.empty()) return;
+
+        size_t const position = _bytes.size();
+        _bytes.resize(position + values.size() * sizeof(T));
+        std::memcpy(&_bytes[position], values.data(), values.size() * sizeof(T));
+    }
+
+    void write_molecule(Molecule const& molecule);
+
+private:
+    friend class Checkpoint_reader;
+
+    std::vector<char> _bytes;
+    std::vector< std::unique_ptr<Molecule> > _molecules;
+    size_t _num_molecules; // in use, the rest are kept for reuse
+};
+
+
+// reads back in the order of writing, starting at the given positions (see Checkpoint_buffer::get_size())
+class Checkpoint_reader
+{
+public:
+    Checkpoint_reader(Checkpoint_buffer const& buffer, size_t const byte_position, size_t const molecule_position) :
+        _buffer(buffer), _byte_position(byte_position), _molecule_position(molecule_position)
+    { }
+
+    template <typename T>
+    void read(T & value)
+    {
+        std::memcpy(&value, &_buffer._bytes[_byte_position], sizeof(T));
+        _byte_position += sizeof(T);
+    }
+
+    template <typename T>
+    void read_vector(std::vector<T> & values)
+    {
+        size_t size;
+        read(size);
+        values.resize(size);
+
+        if (size == 0) return;
+
+        std::memcpy(values.data(), &_buffer._bytes[_byte_position], size * sizeof(T));
+        _byte_position += size * sizeof(T);
+    }
+
+    Molecule const& read_molecule();
+
+private:
+    Checkpoint_buffer const& _buffer;
+    size_t _byte_position;
+    size_t _molecule_position;
+};
+
+#endif // CHECKPOINT_BUFFER_H
@@ -1,5 +1,9 @@
 #include "Core.h"
 
+#include <limits>
+#include <sstream>
+
+#ifndef PARTICULAR_HEADLESS
 #include <QMessageBox>
 #include <QFrame>
 #include <QVBoxLayout>
@@ -7,8 +11,31 @@
 #include "Q_parameter_bridge.h"
 
 #include "Main_options_window.h"
+#include "Renderer.h"
+#endif
+
 #include "Molecule_releaser.h"
 #include "Data_config.h"
+#include "Profiler.h"
+#include "Level_io.h"
+#include "Level_cache.h"
+#include "Rewind_buffer.h"
+#include "Trajectory.h"
+#include "Message_logger.h"
+
+// sets a Parameter from a variant holding one of its value types, for replayed parameter changes
+struct Parameter_value_setter : public boost::static_visitor<>
+{
+    explicit Parameter_value_setter(Parameter * parameter) : _parameter(parameter) { }
+
+    template <class T>
+    void operator() (T const& value) const
+    {
+        _parameter->set_value(value);
+    }
+
+    Parameter * _parameter;
+};
 
 struct Atom_averager
 {
@@ -41,7 +68,7 @@ struct Atom_averager
 
         if (charge_abssum < 0.001f)
         {
-            std::cout << "charge_abssum " << charge_abssum << " #atoms " << atoms.size() << std::endl;
+            LOG_DEBUG("charge_abssum " << charge_abssum << " #atoms " << atoms.size());
             assert(false);
         }
 
@@ -63,13 +90,36 @@ Core::Core(bool const use_unstable_options) :
     _game_state(Game_state::Unstarted),
     _previous_game_state(Game_state::Unstarted),
     _molecule_id_counter(0),
+    _wendland_force(nullptr),
+    _use_force_table(false),
+    _force_table_interpolation(Force_table::Interpolation::Linear),
+    _force_backend(Force_backend::GPU),
+    _last_forces_on_atoms(nullptr),
+    _num_evaluated_atom_pairs(0),
+    _force_evaluation_milliseconds(0.0f),
+    _molecule_memory(Memory_subsystem::Molecules),
+    _atom_memory(Memory_subsystem::Atoms),
+    _level_element_memory(Memory_subsystem::Level_elements),
+    _particle_system_memory(Memory_subsystem::Particle_systems),
+    _sensor_data_memory(Memory_subsystem::Sensor_data),
+    _force_buffer_memory(Memory_subsystem::Force_buffers),
     _current_time(0.0f),
     _last_sensor_check(0.0f),
     _animation_interval(0.04f),
-    _last_animation_time(0.0f)
+    _last_animation_time(0.0f),
+    _input_mode(Input_mode::None),
+    _next_input_command(0),
+    _num_steps(0),
+    _rewind_buffer(new Rewind_buffer),
+    _rewind_interval_steps(10),
+    _rewind_preview_time(-1.0f),
+    _trajectory_interval_steps(1),
+    _level_loading_done(false),
+    _level_loading_progress(1.0f)
   //        _molecule_hash(Molecule_atom_hash(100, 4.0f))
 {
-    std::function<void(void)> update_variables = std::bind(&Core::update_variables, this);
+    // the same id for all, so a Parameter_batch updates the variables only once
+    Parameter_callback const update_variables(std::bind(&Core::update_variables, this), this);
 
     _parameters.add_parameter(new Parameter("levels", std::string(""), update_variables));
 
@@ -84,11 +134,29 @@ Core::Core(bool const use_unstable_options) :
     _parameters.add_parameter(new Parameter("physics_speed", 1.0f, -10.0f, 100.0f, update_variables));
     _parameters["physics_speed"]->set_hidden(true);
     _parameters.add_parameter(new Parameter("Use midpoint", true, update_variables));
-
+    _parameters.add_parameter(new Parameter("Use force table", false, update_variables));
+    _parameters.add_parameter(new Parameter("Force table interpolation", 0, std::vector<std::string>({ "Linear", "Cubic" }), update_variables));
+    _parameters.add_parameter(new Parameter("Force backend", 0, std::vector<std::string>({ "GPU", "CPU" }), update_variables));
+    // 0 turns the history off, particular_sim and particular_bench do so to keep it out of their timings
+    _parameters.add_parameter(new Parameter("rewind_budget_mb", 64, 0, 1024, update_variables));
+    _parameters.add_parameter(new Parameter("rewind_interval_steps", 10, 1, 100, update_variables));
+    _parameters.add_parameter(new Parameter("rewind_keyframe_interval", 20, 1, 200, update_variables));
 
     Parameter_registry<Atomic_force>::create_multi_select_instance(&_parameters, "Atomic Force Type", update_variables);
 
+    _simulation_toggle_handle.bind(&_parameters, "Toggle simulation");
+    _use_midpoint_handle.bind(&_parameters, "Use midpoint");
+    _physics_timestep_handle.bind(&_parameters, "physics_timestep_ms");
+    _physics_speed_handle.bind(&_parameters, "physics_speed");
+    _coulomb_strength_handle.bind(&_parameters, "Atomic Force Type/Coulomb Force/Strength");
+    _vdw_strength_handle.bind(&_parameters, "Atomic Force Type/Van der Waals Force/Strength");
+    _vdw_radius_factor_handle.bind(&_parameters, "Atomic Force Type/Van der Waals Force/Radius Factor");
+    _wendland_strength_handle.bind(&_parameters, "Atomic Force Type/Wendland_force/strength");
+    _wendland_radius_handle.bind(&_parameters, "Atomic Force Type/Wendland_force/radius");
+
+#ifndef PARTICULAR_HEADLESS
     Main_options_window::get_instance()->add_parameter_list("Core", _parameters);
+#endif
 
     _physics_timer.setTimerType(Qt::PreciseTimer);
     _physics_timer.setInterval(_parameters["physics_timestep_ms"]->get_value<int>());
@@ -107,12 +175,22 @@ Core::Core(bool const use_unstable_options) :
 
 Core::~Core()
 {
+    cancel_level_loading();
+    stop_trajectory_recording();
+
+#ifndef PARTICULAR_HEADLESS
     Main_options_window::get_instance()->remove_parameter_list("Core");
+#endif
 }
 
 
 Eigen::Vector3f Core::apply_forces_brute_force(const Atom &receiver_atom) const
 {
+    if (!_use_force_table)
+    {
+        return _force_field->apply_forces_brute_force(receiver_atom, _level_data._molecules, _max_force_distance);
+    }
+
     Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
 
     for (Molecule const& sender : _level_data._molecules)
@@ -138,6 +216,11 @@ Eigen::Vector3f Core::apply_forces_brute_force(const Atom &receiver_atom) const
 
 Eigen::Vector3f Core::apply_forces_from_vector(const Atom &receiver_atom, const std::vector<const Atom *> &atoms) const
 {
+    if (!_use_force_table)
+    {
+        return _force_field->apply_forces_from_vector(receiver_atom, atoms);
+    }
+
     Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
 
     for (Atom const* a : atoms)
@@ -163,7 +246,7 @@ Eigen::Vector3f Core::force_on_atom(const Atom &receiver_atom) const
 
     if (std::isnan(force_i[0]))
     {
-        std::cout << __FUNCTION__ << " isnan, atom: " << &receiver_atom << std::endl;
+        LOG_WARNING("isnan, atom: " << &receiver_atom);
         force_i = Eigen::Vector3f::Zero();
     }
 
@@ -205,16 +288,14 @@ void Core::compute_force_and_torque(Molecule &receiver, int & atom_index, std::v
 //    receiver._force  += std::max(0.0f, brownian_translation_factor) * random_dir_f;
 //    receiver._torque += std::max(0.0f, brownian_rotation_factor)    * random_dir_t;
 
-    for (auto const& f : _level_data._external_forces)
-    {
-        receiver._force += f.second._force * receiver._mass * _mass_factor; // FIXME: using mass here only true if "force" is actually an acceleration (F = m * a)
-        //            receiver._torque += (f._origin - receiver._x).cross(f._force);
-    }
+    // sum of all _level_data._external_forces, see Level_data::update_combined_external_force()
+    receiver._force += _level_data._combined_external_force * receiver._mass * _mass_factor; // FIXME: using mass here only true if "force" is actually an acceleration (F = m * a)
 
-    // TODO: do the search for affected molecules somewhat less brute force
-    for (Molecule_external_force const& f : _molecule_external_forces)
+    auto const molecule_forces_iter = _molecule_external_forces.find(receiver.get_id());
+
+    if (molecule_forces_iter != _molecule_external_forces.end())
     {
-        if (receiver.get_id() == f._molecule_id)
+        for (Molecule_external_force const& f : molecule_forces_iter->second)
         {
             receiver._force += f._force;
             receiver._torque += translation_to_rotation_ratio * (f._origin - receiver._x).cross(f._force);
@@ -267,6 +348,8 @@ void Core::compute_force_and_torque(Molecule &receiver, int & atom_index, std::v
 
 void Core::check_molecules_in_portals()
 {
+    PROFILE_ZONE("Core::check_molecules_in_portals");
+
     for (Portal * p : _level_data._portals)
     {
         p->start_update();
@@ -315,79 +398,125 @@ void Core::check_molecules_in_portals()
 
 void update_temperature_grid(Level_data const& level_data, Frame_buffer<float> & grid)
 {
-    float const game_field_width  = level_data._parameters["Game Field Width"]->get_value<float>();
-    float const game_field_height = level_data._parameters["Game Field Height"]->get_value<float>();
+    float const game_field_width  = level_data._game_field_width_handle.get();
+    float const game_field_height = level_data._game_field_height_handle.get();
+
+    Parameter const* temperature = level_data._temperature_handle.get_parameter();
 
-    float const temp_min = level_data._parameters["Temperature"]->get_min<float>();
-    float const temp_max = level_data._parameters["Temperature"]->get_max<float>();
+    float const temp_min = temperature->get_min<float>();
+    float const temp_max = temperature->get_max<float>();
 
-    float const overall_temperature = level_data._parameters["Temperature"]->get_value<float>();
+    float const overall_temperature = temperature->get_value<float>();
 
-    for (int i = 0; i < grid.get_size(); ++i)
+    for (int y = 0; y < grid.get_height(); ++y)
     {
-        int x, y;
-        grid.get_coordinates(i, x, y);
+        float * row = grid.get_row(y);
 
-        float const normalized_x = x / float(grid.get_width() - 1)  * 2.0f - 1.0f;
         float const normalized_z = y / float(grid.get_height() - 1) * 2.0f - 1.0f;
 
-        Eigen::Vector3f pos(normalized_x * game_field_width * 0.5f, 0.0f, normalized_z * game_field_height * 0.5f);
+        for (int x = 0; x < grid.get_width(); ++x)
+        {
+            float const normalized_x = x / float(grid.get_width() - 1)  * 2.0f - 1.0f;
 
-        float temperature = overall_temperature;
+            Eigen::Vector3f pos(normalized_x * game_field_width * 0.5f, 0.0f, normalized_z * game_field_height * 0.5f);
 
-        for (Brownian_element const* element : level_data._brownian_elements)
-        {
-            temperature += element->get_brownian_motion_factor(pos);
-        }
+            float temperature = overall_temperature;
+
+            for (Brownian_element const* element : level_data._brownian_elements)
+            {
+                temperature += element->get_brownian_motion_factor(pos);
+            }
 
-        grid.set_data(i, into_range(temperature, temp_min, temp_max));
+            row[x] = into_range(temperature, temp_min, temp_max);
+        }
     }
 }
 
 
 void Core::update(const float time_step)
 {
-    _current_time += time_step;
+    PROFILE_ZONE("Core::update");
 
-    float const time_since_animation_update = _current_time - _last_animation_time;
+    if (_input_mode == Input_mode::Replaying)
+    {
+        apply_input_commands();
+    }
+
+    float step_milliseconds = 0.0f;
+    _force_evaluation_milliseconds = 0.0f;
 
-    if (time_since_animation_update > _animation_interval)
     {
-//        std::cout << __FUNCTION__ << " " << time_since_animation_update << std::endl;
+        Scoped_timer const step_timer(step_milliseconds);
+
+        _current_time += time_step;
 
-        _last_animation_time = _current_time;
+        float const time_since_animation_update = _current_time - _last_animation_time;
 
-        update_level_elements(time_since_animation_update);
+        if (time_since_animation_update > _animation_interval)
+        {
+//            std::cout << __FUNCTION__ << " " << time_since_animation_update << std::endl;
+
+            _last_animation_time = _current_time;
+
+            update_level_elements(time_since_animation_update);
+        }
+
+        if (_use_midpoint_handle.get())
+        {
+            midpoint_integration(_level_data._molecules, time_step);
+        }
+        else
+        {
+            update_physics_elements(time_step);
+        }
     }
 
-    if (_parameters["Use midpoint"]->get_value<bool>())
+    _physics_step_times.add(step_milliseconds);
+    _force_evaluation_times.add(_force_evaluation_milliseconds);
+
+    ++_num_steps;
+
+    if (_input_mode == Input_mode::None && _rewind_buffer->is_enabled() && _num_steps % _rewind_interval_steps == 0)
     {
-        midpoint_integration(_level_data._molecules, time_step);
+        PROFILE_ZONE("Core::capture_rewind_frame");
+        _rewind_buffer->capture(*this, time_step);
     }
-    else
+
+    if (_trajectory_recorder && _num_steps % _trajectory_interval_steps == 0)
     {
-        update_physics_elements(time_step);
+        _trajectory_recorder->add_frame(*this, _last_forces_on_atoms);
+    }
+
+    if (_input_mode == Input_mode::Recording && _game_state == Game_state::Running)
+    {
+        _input_recording._num_steps = _num_steps;
+    }
+    else if (_input_mode == Input_mode::Replaying && _num_steps >= _input_recording._num_steps)
+    {
+        LOG_INFO("Input replay finished after " << _num_steps << " steps");
+        _input_mode = Input_mode::None;
     }
 }
 
 
 void Core::update_level_elements(const float time_step)
 {
-    if (!_parameters["Toggle simulation"]->get_value<bool>()) return;
+    if (!_simulation_toggle_handle.get()) return;
+
+    PROFILE_ZONE("Core::update_level_elements");
 
     _level_data._particle_system_elements.erase(std::remove_if(_level_data._particle_system_elements.begin(), _level_data._particle_system_elements.end(), Particle_system_element::check_if_dead()),
                                                 _level_data._particle_system_elements.end());
 
-    _molecule_external_forces.erase(std::remove_if(_molecule_external_forces.begin(), _molecule_external_forces.end(), Check_duration(_current_time)),
-                                    _molecule_external_forces.end());
+    remove_expired_molecule_external_forces();
 
     for (Molecule_releaser * m : _level_data._molecule_releasers)
     {
         bool release_allowed = true;
 
-        if (_num_atoms + m->get_num_prepared_molecules_atoms() > _gpu_force->get_max_num_atoms())
+        if (_num_atoms + m->get_num_prepared_molecules_atoms() > get_max_num_atoms())
         {
-            std::cout << __func__ << " Reached max number of atoms" << std::endl;
+            LOG_WARNING("Reached max number of atoms");
             release_allowed = false;
         }
 
@@ -408,7 +537,10 @@ void Core::update_level_elements(const float time_step)
     }
 
     update_temperature_grid(_level_data, _level_data._temperature_grid);
-    _gpu_force->update_temperature_tex(_level_data._temperature_grid);
+
+#ifndef PARTICULAR_HEADLESS
+    if (_gpu_force) _gpu_force->update_temperature_tex(_level_data._temperature_grid);
+#endif
 
     if (_current_time - _last_sensor_check > _sensor_data.get_check_interval())
     {
@@ -425,16 +557,400 @@ void Core::update_level_elements(const float time_step)
     {
         set_new_game_state(Game_state::Finished);
     }
+
+    update_memory_usage();
+}
+
+
+void Core::remove_expired_molecule_external_forces()
+{
+    while (!_molecule_external_force_expiries.empty() && _molecule_external_force_expiries.top()._end_time < _current_time)
+    {
+        int const molecule_id = _molecule_external_force_expiries.top()._molecule_id;
+        _molecule_external_force_expiries.pop();
+
+        auto const iter = _molecule_external_forces.find(molecule_id);
+
+        if (iter == _molecule_external_forces.end()) continue; // already removed with an earlier expiry
+
+        std::vector<Molecule_external_force> & forces = iter->second;
+        forces.erase(std::remove_if(forces.begin(), forces.end(), Check_duration(_current_time)), forces.end());
+
+        if (forces.empty())
+        {
+            _molecule_external_forces.erase(iter);
+        }
+    }
+}
+
+
+void Core::update_memory_usage()
+{
+    std::list<Molecule> const& molecules = _level_data._molecules;
+
+    // list nodes and the id lookup, the atoms live in each molecule's vector
+    _molecule_memory.set(molecules.size() * (sizeof(Molecule) + 2 * sizeof(void*)) +
+                         _molecule_id_to_molecule_map.size() * (sizeof(std::pair<int const, Molecule*>) + 2 * sizeof(void*)));
+    _atom_memory.set(size_t(_num_atoms) * sizeof(Atom));
+
+    // the concrete element types differ in size, the base class size is a lower bound
+    Frame_buffer<float> const& temperature_grid = _level_data._temperature_grid;
+    _level_element_memory.set(_level_data._level_elements.size() * sizeof(Level_element) +
+                              size_t(temperature_grid.get_width()) * size_t(temperature_grid.get_height()) * sizeof(float));
+
+    size_t particle_system_bytes = 0;
+
+    for (Particle_system_element const* p : _level_data._particle_system_elements)
+    {
+        particle_system_bytes += sizeof(Particle_system_element) + p->get_particles().capacity() * sizeof(Particle);
+    }
+
+    _particle_system_memory.set(particle_system_bytes);
+
+    _sensor_data_memory.set(_sensor_data.get_memory_usage());
+
+    _force_buffer_memory.set(_cpu_atoms.get_memory_usage() + _cpu_forces.get_memory_usage() +
+                             _cpu_forces_on_atoms.capacity() * sizeof(Eigen::Vector3f) +
+                             _force_table.get_samples().capacity() * sizeof(float));
+}
+
+
+void Core::start_input_recording()
+{
+    _input_mode = Input_mode::Recording;
+    _input_recording.clear();
+}
+
+
+bool Core::save_input_recording(const std::string &file_name)
+{
+    if (_input_mode != Input_mode::Recording) return false;
+
+    return _input_recording.save(file_name);
+}
+
+
+bool Core::start_input_replay(const std::string &file_name)
+{
+    Input_recording recording;
+
+    if (!recording.load(file_name)) return false;
+
+    _input_mode = Input_mode::None;
+
+    try
+    {
+        std::istringstream settings_in(recording._simulation_settings_archive);
+        boost::archive::xml_iarchive ia(settings_in);
+
+        Parameter_list settings;
+        ia >> boost::serialization::make_nvp("simulation_settings", settings);
+
+        _parameters.load(settings);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't read the simulation settings of " << file_name << ": " << e.what());
+        return false;
+    }
+
+    std::istringstream level_in(recording._level_archive);
+    load_level(level_in, file_name);
+
+    start_level();
+    seed_random_generators(recording._seed);
+
+    _input_recording = recording;
+    _next_input_command = 0;
+    _input_mode = Input_mode::Replaying;
+
+    return true;
+}
+
+
+bool Core::is_replaying_input() const
+{
+    return _input_mode == Input_mode::Replaying;
+}
+
+
+void Core::record_element_change(Level_element *element, const Parameter_list &properties)
+{
+    Input_command command;
+    command._type = int(Input_command::Type::Change_element);
+    command._element_index = get_level_element_index(element);
+    command._element_state = get_level_element_state(element, properties);
+
+    add_input_command(command);
+}
+
+
+void Core::record_element_addition(Level_element *element)
+{
+    // skip writing the archive when it would be dropped anyway
+    if (_input_mode != Input_mode::Recording) return;
+
+    Input_command command;
+    command._type = int(Input_command::Type::Add_element);
+    command._name = save_level_element(element);
+
+    add_input_command(command);
+}
+
+
+void Core::record_element_deletion(const Level_element *element)
+{
+    Input_command command;
+    command._type = int(Input_command::Type::Delete_element);
+    command._element_index = get_level_element_index(element);
+
+    add_input_command(command);
+}
+
+
+void Core::record_molecule_addition(const std::string &molecule_type, const Eigen::Vector3f &position)
+{
+    Input_command command;
+    command._type = int(Input_command::Type::Add_molecule);
+    command._name = molecule_type;
+    command._position = position;
+
+    add_input_command(command);
+}
+
+
+void Core::record_parameter_change(const std::string &name)
+{
+    Parameter const* parameter = _parameters[name];
+
+    if (!parameter) return;
+
+    Input_command command;
+    command._type = int(Input_command::Type::Set_parameter);
+    command._name = name;
+    command._value = parameter->get_variant_value();
+
+    add_input_command(command);
+}
+
+
+void Core::begin_input_recording()
+{
+    _input_recording.clear();
+
+    _input_recording._seed = (unsigned int)(std::chrono::system_clock::now().time_since_epoch().count());
+    seed_random_generators(_input_recording._seed);
+
+    std::ostringstream level_out;
+    save_level(level_out);
+    _input_recording._level_archive = level_out.str();
+
+    std::ostringstream settings_out;
+
+    {
+        boost::archive::xml_oarchive oa(settings_out);
+        oa << boost::serialization::make_nvp("simulation_settings", _parameters);
+    }
+
+    _input_recording._simulation_settings_archive = settings_out.str();
+}
+
+
+void Core::add_input_command(Input_command &command)
+{
+    if (_input_mode != Input_mode::Recording || _game_state != Game_state::Running) return;
+
+    command._step = _num_steps;
+
+    std::vector<Input_command> & commands = _input_recording._commands;
+
+    // dragging changes an element every mouse move, only the last state before a step matters
+    if (command.get_type() == Input_command::Type::Change_element && !commands.empty() &&
+            commands.back().get_type() == Input_command::Type::Change_element &&
+            commands.back()._step == command._step && commands.back()._element_index == command._element_index)
+    {
+        commands.back() = command;
+        return;
+    }
+
+    commands.push_back(command);
+}
+
+
+void Core::apply_input_commands()
+{
+    std::vector<Input_command> const& commands = _input_recording._commands;
+
+    bool elements_changed = false;
+
+    while (_next_input_command < commands.size() && commands[_next_input_command]._step <= _num_steps)
+    {
+        Input_command const& command = commands[_next_input_command];
+
+        apply_input_command(command);
+
+        elements_changed = elements_changed || command.get_type() != Input_command::Type::Set_parameter;
+        ++_next_input_command;
+    }
+
+    if (elements_changed)
+    {
+        Q_EMIT level_elements_changed();
+    }
+}
+
+
+void Core::apply_input_command(const Input_command &command)
+{
+    std::vector< boost::shared_ptr<Level_element> > const& elements = _level_data._level_elements;
+    bool const valid_index = command._element_index >= 0 && command._element_index < int(elements.size());
+
+    switch (command.get_type())
+    {
+    case Input_command::Type::Change_element:
+        if (valid_index)
+        {
+            set_level_element_state(elements[command._element_index].get(), command._element_state);
+        }
+        break;
+    case Input_command::Type::Add_element:
+        if (Level_element * element = load_level_element(command._name))
+        {
+            _level_data.add_level_element(element);
+        }
+        break;
+    case Input_command::Type::Delete_element:
+        if (valid_index)
+        {
+            _level_data.delete_level_element(elements[command._element_index].get());
+        }
+        break;
+    case Input_command::Type::Add_molecule:
+        add_molecule(Molecule::create(command._name, command._position));
+        break;
+    case Input_command::Type::Set_parameter:
+        if (Parameter * parameter = _parameters[command._name])
+        {
+            boost::apply_visitor(Parameter_value_setter(parameter), command._value);
+        }
+        break;
+    }
+}
+
+
+void Core::seed_random_generators(const unsigned int seed)
+{
+    _random_generator.seed(seed);
+
+    for (size_t i = 0; i < _level_data._molecule_releasers.size(); ++i)
+    {
+        _level_data._molecule_releasers[i]->set_random_seed(seed + (unsigned int)(i) + 1);
+    }
+}
+
+
+int Core::get_level_element_index(const Level_element *element) const
+{
+    std::vector< boost::shared_ptr<Level_element> > const& elements = _level_data._level_elements;
+
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        if (elements[i].get() == element) return int(i);
+    }
+
+    return -1;
+}
+
+
+std::vector<Eigen::Vector3f> const& Core::calc_forces_on_atoms(std::list<Molecule> const& molecules, float const time)
+{
+    PROFILE_ZONE("Core::calc_forces_on_atoms");
+    Scoped_timer const force_timer(_force_evaluation_milliseconds);
+
+    // ordered pairs of atoms in different molecules, the backends skip the rest
+    unsigned long long num_atoms = 0;
+    unsigned long long num_same_molecule_pairs = 0;
+
+    for (Molecule const& m : molecules)
+    {
+        unsigned long long const n = m._atoms.size();
+        num_atoms += n;
+        num_same_molecule_pairs += n * n;
+    }
+
+    _num_evaluated_atom_pairs += num_atoms * num_atoms - num_same_molecule_pairs;
+
+#ifndef PARTICULAR_HEADLESS
+    if (_gpu_force && _force_backend == Force_backend::GPU)
+    {
+        _last_forces_on_atoms = &_gpu_force->calc_forces(molecules,
+                                                         _coulomb_strength_handle.get(),
+                                                         _vdw_strength_handle.get(),
+                                                         _vdw_radius_factor_handle.get(),
+                                                         _wendland_force ? _wendland_strength_handle.get() : 0.0f,
+                                                         _wendland_radius_handle.get(),
+                                                         time, QVector2D(_level_data._game_field_width, _level_data._game_field_height));
+        return *_last_forces_on_atoms;
+    }
+#endif
+
+    _last_forces_on_atoms = &calc_forces_on_atoms_cpu(molecules, time);
+
+    return *_last_forces_on_atoms;
+}
+
+
+// same as force_calc.frag: pair forces from the force table or the force field, plus the random temperature contribution
+std::vector<Eigen::Vector3f> const& Core::calc_forces_on_atoms_cpu(std::list<Molecule> const& molecules, float const /* time */)
+{
+    _cpu_atoms.assign(molecules);
+
+    _cpu_forces.resize(_cpu_atoms.size());
+    _cpu_forces.set_zero();
+
+    Atom_span const atoms = _cpu_atoms.get_span();
+    Force_span const forces = _cpu_forces.get_span();
+
+    if (_use_force_table)
+    {
+        _force_table.calc_forces(atoms, atoms, forces, _force_table_interpolation);
+
+        // the table only has the Coulomb and vdW forces
+        if (_wendland_force) _wendland_force->calc_forces(atoms, atoms, forces);
+    }
+    else
+    {
+        _force_field->calc_forces(atoms, atoms, forces);
+    }
+
+    _cpu_forces.to_vectors(_cpu_forces_on_atoms);
+
+    int atom_index = 0;
+
+    for (Molecule const& m : molecules)
+    {
+        for (Atom const& a : m._atoms)
+        {
+            float const temperature = _level_data.get_temperature(a.get_position());
+
+            if (temperature > 0.0f)
+            {
+                _cpu_forces_on_atoms[atom_index] += _random_generator.generator_unit_vector() * temperature;
+            }
+
+            ++atom_index;
+        }
+    }
+
+    return _cpu_forces_on_atoms;
 }
 
 
 void Core::do_physics_step(std::list<Molecule> & molecules, float const current_time, float const time_step)
 {
-    std::vector<Eigen::Vector3f> const& forces_on_atoms = _gpu_force->calc_forces(molecules,
-            _parameters["Atomic Force Type/Coulomb Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Radius Factor"]->get_value<float>(),
-            current_time, QVector2D(_level_data._game_field_width, _level_data._game_field_height));
+    std::vector<Eigen::Vector3f> const& forces_on_atoms = calc_forces_on_atoms(molecules, current_time);
+
+    PROFILE_ZONE("Core::integrate_half_step");
 
     int atom_index = 0;
 
@@ -461,19 +977,21 @@ void Core::midpoint_integration(std::list<Molecule> & molecules, float const tim
     std::list<Molecule> molecules_at_half_time = molecules;
     do_physics_step(molecules_at_half_time, _current_time, time_step * 0.5f);
 
-    std::vector<Eigen::Vector3f> const& forces_on_atoms_at_half_time = _gpu_force->calc_forces(molecules_at_half_time,
-            _parameters["Atomic Force Type/Coulomb Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Radius Factor"]->get_value<float>(),
-            _current_time + 0.5f * time_step, QVector2D(_level_data._game_field_width, _level_data._game_field_height));
-
-    int atom_index = 0;
+    std::vector<Eigen::Vector3f> const& forces_on_atoms_at_half_time = calc_forces_on_atoms(molecules_at_half_time, _current_time + 0.5f * time_step);
 
-    for (Molecule & m : molecules_at_half_time)
     {
-        compute_force_and_torque(m, atom_index, forces_on_atoms_at_half_time);
+        PROFILE_ZONE("Core::compute_force_and_torque");
+
+        int atom_index = 0;
+
+        for (Molecule & m : molecules_at_half_time)
+        {
+            compute_force_and_torque(m, atom_index, forces_on_atoms_at_half_time);
+        }
     }
 
+    PROFILE_ZONE("Core::integrate");
+
     auto iter_molecule = molecules.begin();
     auto iter_molecule_half_time = molecules_at_half_time.cbegin();
 
@@ -500,62 +1018,20 @@ void Core::midpoint_integration(std::list<Molecule> & molecules, float const tim
 
 void Core::update_physics_elements(const float time_step)
 {
-    bool const time_debug = false;
-
-    int elapsed_milliseconds;
-    std::chrono::steady_clock::time_point timer_start, timer_end;
-
-    if (time_debug)
-    {
-        timer_start = std::chrono::steady_clock::now();
-    }
-
-    std::vector<Eigen::Vector3f> const& forces_on_atoms = _gpu_force->calc_forces(_level_data._molecules,
-            _parameters["Atomic Force Type/Coulomb Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Strength"]->get_value<float>(),
-            _parameters["Atomic Force Type/Van der Waals Force/Radius Factor"]->get_value<float>(),
-            _current_time, QVector2D(_level_data._game_field_width, _level_data._game_field_height));
+    std::vector<Eigen::Vector3f> const& forces_on_atoms = calc_forces_on_atoms(_level_data._molecules, _current_time);
 
-    if (time_debug)
     {
-        timer_end = std::chrono::steady_clock::now();
+        PROFILE_ZONE("Core::compute_force_and_torque");
 
-        elapsed_milliseconds = std::chrono::duration <double, std::milli>(timer_end - timer_start).count();
+        int atom_index = 0;
 
-        if (elapsed_milliseconds > 1)
+        for (Molecule & m : _level_data._molecules)
         {
-            std::cout << "gpu_force update: " << elapsed_milliseconds << std::endl;
+            compute_force_and_torque(m, atom_index, forces_on_atoms);
         }
     }
 
-    if (time_debug)
-    {
-        timer_start = std::chrono::steady_clock::now();
-    }
-
-    int atom_index = 0;
-
-    for (Molecule & m : _level_data._molecules)
-    {
-        compute_force_and_torque(m, atom_index, forces_on_atoms);
-    }
-
-    if (time_debug)
-    {
-        timer_end = std::chrono::steady_clock::now();
-
-        elapsed_milliseconds = std::chrono::duration <double, std::milli>(timer_end - timer_start).count();
-
-        if (elapsed_milliseconds > 1)
-        {
-            std::cout << "compute_force_and_torque(): " << elapsed_milliseconds << std::endl;
-        }
-    }
-
-    if (time_debug)
-    {
-        timer_start = std::chrono::steady_clock::now();
-    }
+    PROFILE_ZONE("Core::integrate");
 
     for (Molecule & molecule : _level_data._molecules)
     {
@@ -586,30 +1062,19 @@ void Core::update_physics_elements(const float time_step)
 
         molecule._P += molecule._force * time_step;
 
-        molecule._L += molecule._torque * time_step;
-
-//        std::cout << "L: " << molecule._L << std::endl;
-
-        molecule.from_state(Body_state(), _mass_factor);
-    }
-
-    if (time_debug)
-    {
-        timer_end = std::chrono::steady_clock::now();
+        molecule._L += molecule._torque * time_step;
 
-        elapsed_milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>
-                (timer_end-timer_start).count();
+//        std::cout << "L: " << molecule._L << std::endl;
 
-        if (elapsed_milliseconds > 1)
-        {
-            std::cout << "update molecules: " << elapsed_milliseconds << std::endl;
-        }
+        molecule.from_state(Body_state(), _mass_factor);
     }
 }
 
 
 void Core::do_sensor_check()
 {
+    PROFILE_ZONE("Core::do_sensor_check");
+
     float num_collected_molecules = 0.0f;
     float num_released_molecules = 0.0f;
     float average_temperature = 0.0f;
@@ -701,14 +1166,12 @@ void Core::add_molecule(Molecule const& molecule)
 
 Eigen::Vector3f Core::calc_forces_between_atoms(const Atom &a_0, const Atom &a_1) const
 {
-    Eigen::Vector3f resulting_force(0.0f, 0.0f, 0.0f);
-
-    for (std::unique_ptr<Atomic_force> const& force : _atomic_forces)
+    if (_use_force_table)
     {
-        resulting_force += force->calc_force_between_atoms(a_0, a_1);
+        return _force_table.calc_force(a_0, a_1, _force_table_interpolation);
     }
 
-    return resulting_force;
+    return _force_field->calc_force_between_atoms(a_0, a_1);
 }
 
 
@@ -727,12 +1190,26 @@ Eigen::Vector3f Core::calc_forces_between_atoms(const Atom &a_0, const Atom &a_1
 
 void Core::start_level()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
+
+    finish_level_loading(true);
 
     set_new_game_state(Game_state::Running);
 
     reset_level();
 
+    _num_steps = 0;
+
+    if (_input_mode == Input_mode::Recording)
+    {
+        begin_input_recording();
+    }
+
+    save_checkpoint(_level_start_checkpoint);
+    _user_checkpoint._valid = false;
+    _rewind_buffer->clear();
+    _rewind_preview_time = -1.0f;
+
     set_simulation_state(true);
 }
 
@@ -812,43 +1289,57 @@ void Core::clear()
     _level_data._molecule_releasers.clear();
     _level_data._particle_system_elements.clear();
     _level_data._external_forces.clear();
+    _level_data.update_combined_external_force();
     _molecule_external_forces.clear();
+    _molecule_external_force_expiries = Molecule_external_force_expiry_queue();
     _molecule_id_to_molecule_map.clear();
 
     _num_atoms = 0;
     _molecule_id_counter = 0;
     //        _molecule_hash.clear();
+
+    _level_start_checkpoint._valid = false;
+    _user_checkpoint._valid = false;
+    _rewind_buffer->clear();
+    _rewind_preview_time = -1.0f;
+
+    // a trajectory covers one continuous run of one level
+    stop_trajectory_recording();
+
+    update_memory_usage();
 }
 
 
 void Core::reset_level(bool const keep_molecules)
 {
-    delete_non_persistent_objects();
-
-    std::list<Molecule> molecules_tmp;
-
-    if (keep_molecules)
-    {
-        molecules_tmp = _level_data._molecules;
-    }
+    stop_trajectory_recording();
 
-    _level_data._molecules.clear();
+    delete_non_persistent_objects();
 
     _num_atoms = 0;
     _molecule_id_counter = 0;
 
     _molecule_external_forces.clear();
+    _molecule_external_force_expiries = Molecule_external_force_expiry_queue();
 
     //        _molecule_hash.clear();
     _molecule_id_to_molecule_map.clear();
 
     if (keep_molecules)
     {
-        for (Molecule const& m : molecules_tmp)
+        // renumbered in place, same ids as re-adding them with add_molecule()
+        for (Molecule & m : _level_data._molecules)
         {
-            add_molecule(m);
+            m.set_id(_molecule_id_counter);
+            _molecule_id_to_molecule_map[_molecule_id_counter] = &m;
+            ++_molecule_id_counter;
+            _num_atoms += int(m._atoms.size());
         }
     }
+    else
+    {
+        _level_data._molecules.clear();
+    }
 
     _sensor_data.clear();
     _sensor_data.set_game_field_volume(_level_data._game_field_height * _level_data._game_field_width);
@@ -859,7 +1350,262 @@ void Core::reset_level(bool const keep_molecules)
     _last_animation_time = 0.0f;
     _last_sensor_check = 0.0f;
 
+    update_memory_usage();
+
+#ifndef PARTICULAR_HEADLESS
     change_level_state(Main_game_screen::Level_state::Running);
+#endif
+}
+
+void Core::save_checkpoint(Checkpoint &checkpoint) const
+{
+    PROFILE_ZONE("Core::save_checkpoint");
+
+    checkpoint._molecules = _level_data._molecules;
+    checkpoint._molecule_id_counter = _molecule_id_counter;
+    checkpoint._num_atoms = _num_atoms;
+
+    checkpoint._molecule_external_forces = _molecule_external_forces;
+    checkpoint._molecule_external_force_expiries = _molecule_external_force_expiries;
+
+    checkpoint._sensor_data = _sensor_data;
+
+    checkpoint._current_time = _current_time;
+    checkpoint._last_animation_time = _last_animation_time;
+    checkpoint._last_sensor_check = _last_sensor_check;
+    checkpoint._num_steps = _num_steps;
+
+    checkpoint._random_generator = _random_generator;
+
+    checkpoint._elements.clear();
+    checkpoint._element_states.clear();
+
+    for (boost::shared_ptr<Level_element> const& e : _level_data._level_elements)
+    {
+        if (!e->is_persistent()) continue;
+
+        Level_element const& element = *e;
+
+        Checkpoint::Element_entry entry;
+        entry._element = &element;
+        entry._type = &typeid(element);
+        entry._byte_position = checkpoint._element_states.get_size();
+        entry._molecule_position = checkpoint._element_states.get_num_molecules();
+
+        checkpoint._elements.push_back(entry);
+
+        element.save_state(checkpoint._element_states);
+    }
+
+    checkpoint._valid = true;
+}
+
+void Core::restore_checkpoint(const Checkpoint &checkpoint)
+{
+    PROFILE_ZONE("Core::restore_checkpoint");
+
+    assert(checkpoint._valid);
+
+    stop_trajectory_recording();
+
+    delete_non_persistent_objects();
+
+    // assigning lists reuses the existing nodes
+    _level_data._molecules = checkpoint._molecules;
+    _molecule_id_counter = checkpoint._molecule_id_counter;
+    _num_atoms = checkpoint._num_atoms;
+
+    _molecule_id_to_molecule_map.clear();
+
+    for (Molecule & m : _level_data._molecules)
+    {
+        _molecule_id_to_molecule_map[m.get_id()] = &m;
+    }
+
+    _molecule_external_forces = checkpoint._molecule_external_forces;
+    _molecule_external_force_expiries = checkpoint._molecule_external_force_expiries;
+
+    _sensor_data = checkpoint._sensor_data;
+
+    _current_time = checkpoint._current_time;
+    _last_animation_time = checkpoint._last_animation_time;
+    _last_sensor_check = checkpoint._last_sensor_check;
+    _num_steps = checkpoint._num_steps;
+
+    _random_generator = checkpoint._random_generator;
+
+    // elements placed after the checkpoint are reset, the entries are usually in the same order as the elements
+    size_t entry_index = 0;
+
+    for (boost::shared_ptr<Level_element> const& e : _level_data._level_elements)
+    {
+        Level_element & element = *e;
+
+        if (entry_index >= checkpoint._elements.size() || checkpoint._elements[entry_index]._element != &element)
+        {
+            entry_index = std::find_if(checkpoint._elements.begin(), checkpoint._elements.end(),
+                                       [&element](Checkpoint::Element_entry const& entry) { return entry._element == &element; })
+                    - checkpoint._elements.begin();
+        }
+
+        if (entry_index < checkpoint._elements.size() && *checkpoint._elements[entry_index]._type == typeid(element))
+        {
+            Checkpoint::Element_entry const& entry = checkpoint._elements[entry_index];
+            Checkpoint_reader reader(checkpoint._element_states, entry._byte_position, entry._molecule_position);
+            element.load_state(reader);
+
+            ++entry_index;
+        }
+        else
+        {
+            element.reset();
+        }
+    }
+
+    update_memory_usage();
+
+    Q_EMIT level_elements_changed();
+}
+
+void Core::save_checkpoint()
+{
+    if (_input_mode != Input_mode::None)
+    {
+        LOG_WARNING("not available while recording or replaying input");
+        return;
+    }
+
+    save_checkpoint(_user_checkpoint);
+}
+
+bool Core::restore_checkpoint()
+{
+    if (!_user_checkpoint._valid || _input_mode != Input_mode::None) return false;
+
+    restore_checkpoint(_user_checkpoint);
+
+    return true;
+}
+
+void Core::restart_level()
+{
+    if (_level_start_checkpoint._valid && _input_mode == Input_mode::None)
+    {
+        restore_checkpoint(_level_start_checkpoint);
+
+#ifndef PARTICULAR_HEADLESS
+        change_level_state(Main_game_screen::Level_state::Running);
+#endif
+    }
+    else
+    {
+        reset_level();
+    }
+}
+
+bool Core::start_trajectory_recording(const std::string &file_name, const int interval_steps, const bool record_forces)
+{
+    std::unique_ptr<Trajectory_recorder> recorder(new Trajectory_recorder);
+
+    if (!recorder->start(file_name, _level_data, record_forces))
+    {
+        return false;
+    }
+
+    stop_trajectory_recording();
+
+    _trajectory_recorder = std::move(recorder);
+    _trajectory_interval_steps = std::max(1, interval_steps);
+
+    return true;
+}
+
+void Core::stop_trajectory_recording()
+{
+    if (_trajectory_recorder)
+    {
+        _trajectory_recorder->stop();
+    }
+}
+
+bool Core::preview_rewind(const float time)
+{
+    if (_input_mode != Input_mode::None) return false;
+
+    Checkpoint const* keyframe = _rewind_buffer->find_keyframe(time);
+
+    if (!keyframe) return false;
+
+    if (!is_previewing_rewind())
+    {
+        save_checkpoint(_rewind_live_checkpoint);
+        set_simulation_state(false);
+    }
+
+    restore_checkpoint(*keyframe);
+    _rewind_buffer->apply_frame(time, _level_data._molecules);
+
+    _rewind_preview_time = time;
+
+    return true;
+}
+
+void Core::end_rewind_preview(const bool commit)
+{
+    if (!is_previewing_rewind()) return;
+
+    float const time = _rewind_preview_time;
+    _rewind_preview_time = -1.0f;
+
+    if (!commit || !rewind(time))
+    {
+        restore_checkpoint(_rewind_live_checkpoint);
+    }
+
+    set_simulation_state(true);
+}
+
+bool Core::rewind(const float time)
+{
+    if (_input_mode != Input_mode::None) return false;
+
+    Checkpoint const* keyframe = _rewind_buffer->find_keyframe(time);
+
+    if (!keyframe) return false;
+
+    PROFILE_ZONE("Core::rewind");
+
+    // taken before the truncation drops the frames after the keyframe
+    std::vector<Rewind_buffer::Step_size> const step_sizes = _rewind_buffer->get_step_sizes(time);
+
+    restore_checkpoint(*keyframe);
+
+    // the replayed steps capture the history after the keyframe again
+    _rewind_buffer->truncate(_num_steps);
+
+    // the trajectory already has these steps
+    std::unique_ptr<Trajectory_recorder> trajectory_recorder = std::move(_trajectory_recorder);
+
+    size_t step_size_index = 0;
+
+    while (true)
+    {
+        // the steps up to a frame were taken with the step size recorded with it
+        while (step_size_index + 1 < step_sizes.size() && step_sizes[step_size_index]._step <= _num_steps)
+        {
+            ++step_size_index;
+        }
+
+        float const time_step = step_sizes[step_size_index]._time_step;
+
+        if (time_step <= 0.0f || _current_time + 0.5f * time_step >= time) break;
+
+        update(time_step);
+    }
+
+    _trajectory_recorder = std::move(trajectory_recorder);
+
+    return true;
 }
 
 
@@ -873,7 +1619,7 @@ void Core::save_simulation_settings()
     }
     catch (std::exception const& e)
     {
-        std::cout << "Couldn't save sim settings: " << e.what() << std::endl;
+        LOG_WARNING("Couldn't save sim settings: " << e.what());
     }
 }
 
@@ -884,14 +1630,17 @@ void Core::load_simulation_settings()
     {
         std::string file_name = Data_config::get_instance()->get_absolute_filename("simulation_settings.data");
         _parameters.load(file_name);
-        update_variables();
     }
     catch (std::runtime_error const& e)
     {
-        std::cout << "Couldn't load simulation settings file: simulation_settings.data, " << e.what() << std::endl;
+        LOG_WARNING("Couldn't load simulation settings file: simulation_settings.data, " << e.what());
 
         load_default_simulation_settings();
+        return;
     }
+
+    // after the load's batch ran the callbacks, a missing file runs none and leaves the derived variables unset
+    update_variables();
 }
 
 void Core::load_default_simulation_settings()
@@ -900,20 +1649,29 @@ void Core::load_default_simulation_settings()
     {
         std::string file_name = Data_config::get_instance()->get_absolute_filename("default_simulation_settings.data");
         _parameters.load(file_name);
-        update_variables();
     }
     catch (std::runtime_error const& e)
     {
-        std::cout << "Couldn't load simulation settings file: default_simulation_settings.data, " << e.what() << std::endl;
+        LOG_WARNING("Couldn't load simulation settings file: default_simulation_settings.data, " << e.what());
     }
+
+    update_variables();
 }
 
 void Core::save_level(const std::string &file_name) const
 {
     //        std::ofstream out_file(file_name.c_str(), std::ios_base::binary);
     std::ofstream out_file(file_name.c_str(), std::fstream::binary | std::fstream::out);
+
+    save_level(out_file);
+
+    out_file.close();
+}
+
+void Core::save_level(std::ostream &out) const
+{
     //        boost::archive::text_oarchive oa(out_file);
-    boost::archive::xml_oarchive oa(out_file);
+    boost::archive::xml_oarchive oa(out);
 
     //        std::cout << "Parameter_list::save: " << out_file << std::endl;
 
@@ -923,8 +1681,6 @@ void Core::save_level(const std::string &file_name) const
 //    oa << boost::serialization::make_nvp("Core", *this);
 
     oa << BOOST_SERIALIZATION_NVP(_level_data);
-
-    out_file.close();
 }
 
 
@@ -954,7 +1710,7 @@ void Core::load_progress()
         }
         catch (std::exception e)
         {
-            std::cout << "Failed to load progress file, progress reset: " << e.what() << std::endl;
+            LOG_WARNING("Failed to load progress file, progress reset: " << e.what());
             _progress = Progress();
         }
 
@@ -962,7 +1718,7 @@ void Core::load_progress()
     }
     else
     {
-        std::cout << "No progress file found" << std::endl;
+        LOG_WARNING("No progress file found");
     }
 }
 
@@ -986,7 +1742,16 @@ void Core::set_simulation_state(const bool s)
 
 bool Core::get_simulation_state() const
 {
-    return _parameters["Toggle simulation"]->get_value<bool>();
+    return _simulation_toggle_handle.get();
+}
+
+int Core::get_max_num_atoms() const
+{
+#ifndef PARTICULAR_HEADLESS
+    if (_gpu_force) return _gpu_force->get_max_num_atoms();
+#endif
+
+    return std::numeric_limits<int>::max();
 }
 
 void Core::update_physics_timestep()
@@ -1006,6 +1771,60 @@ void Core::update_variables()
     _max_force_distance = _parameters["max_force_distance"]->get_value<float>();
 
     _atomic_forces = std::vector< std::unique_ptr<Atomic_force> >(Parameter_registry<Atomic_force>::get_unique_ptr_classes_from_multi_select_instance(_parameters.get_child("Atomic Force Type")));
+    _force_field = create_force_field(_atomic_forces);
+
+    _wendland_force = nullptr;
+
+    for (std::unique_ptr<Atomic_force> const& f : _atomic_forces)
+    {
+        if (f->get_instance_name() == Wendland_force::name()) _wendland_force = f.get();
+    }
+
+    _use_force_table = _parameters["Use force table"]->get_value<bool>();
+    _force_table_interpolation = Force_table::Interpolation(_parameters["Force table interpolation"]->get_index());
+    _force_backend = Force_backend(_parameters["Force backend"]->get_index());
+
+    _rewind_buffer->set_budget(size_t(_parameters["rewind_budget_mb"]->get_value<int>()) * 1024 * 1024);
+    _rewind_buffer->set_keyframe_interval(_parameters["rewind_keyframe_interval"]->get_value<int>());
+    _rewind_interval_steps = _parameters["rewind_interval_steps"]->get_value<int>();
+
+    update_force_table();
+}
+
+
+void Core::update_force_table()
+{
+    if (!_use_force_table)
+    {
+#ifndef PARTICULAR_HEADLESS
+        if (_gpu_force) _gpu_force->update_force_table(nullptr);
+#endif
+        return;
+    }
+
+    // disabled forces are built into the table with zero strength
+    Parameter_list const* force_types = _parameters.get_child("Atomic Force Type");
+
+    bool const coulomb_enabled = force_types->get_child(Coulomb_force::name())->get_parameter("multi_enable")->get_value<bool>();
+    bool const vdw_enabled     = force_types->get_child(Lennard_jones_force::name())->get_parameter("multi_enable")->get_value<bool>();
+
+    float const coulomb_strength  = coulomb_enabled ? _coulomb_strength_handle.get() : 0.0f;
+    float const vdw_strength      = vdw_enabled     ? _vdw_strength_handle.get()     : 0.0f;
+    float const vdw_radius_factor = _vdw_radius_factor_handle.get();
+
+    bool const rebuild = _force_table.needs_rebuild(coulomb_strength, vdw_strength, vdw_radius_factor);
+
+    if (rebuild)
+    {
+        _force_table.build(coulomb_strength, vdw_strength, vdw_radius_factor);
+    }
+
+#ifndef PARTICULAR_HEADLESS
+    if (_gpu_force && (rebuild || !_gpu_force->is_using_force_table()))
+    {
+        _gpu_force->update_force_table(&_force_table);
+    }
+#endif
 }
 
 
@@ -1055,36 +1874,9 @@ const QStringList &Core::get_level_names() const
 
 void Core::update_physics()
 {
-    float const time_debug = false;
-
-    if (time_debug)
-    {
-        _fps_meter.update();
-    }
-
-    std::chrono::steady_clock::time_point const timer_start = std::chrono::steady_clock::now();
-
     // FIXME: currently constant update time step, not regarding at all the actually elapsed time
     // some updates are really far away from the set time step, not sure why
-    update(_parameters["physics_timestep_ms"]->get_value<int>() / 1000.0f * _parameters["physics_speed"]->get_value<float>());
-
-    if (time_debug)
-    {
-        std::chrono::steady_clock::time_point const timer_end = std::chrono::steady_clock::now();
-
-        int const elapsed_milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>
-                (timer_end-timer_start).count();
-
-        if (elapsed_milliseconds > 1)
-        {
-            std::cout << __func__ << " time elapsed: " << elapsed_milliseconds << std::endl;
-        }
-
-        if (_fps_meter.has_new_value())
-        {
-            std::cout << __func__ << " Physics fps: " << _fps_meter.get_fps() << std::endl;
-        }
-    }
+    update(_physics_timestep_handle.get() / 1000.0f * _physics_speed_handle.get());
 }
 
 
@@ -1123,10 +1915,14 @@ float Core::get_current_time() const
     return _current_time;
 }
 
+#ifndef PARTICULAR_HEADLESS
 void Core::gl_init(QGLContext * /* context */)
 {
     _gpu_force = std::unique_ptr<GPU_force>(new GPU_force(_level_data._temperature_grid.get_width()));
+
+    update_force_table();
 }
+#endif
 
 
 //void Core::add_external_force(const std::string &name, const External_force &force)
@@ -1137,7 +1933,8 @@ void Core::gl_init(QGLContext * /* context */)
 
 void Core::add_molecule_external_force(const Molecule_external_force &force)
 {
-    _molecule_external_forces.push_back(force);
+    _molecule_external_forces[force._molecule_id].push_back(force);
+    _molecule_external_force_expiries.push(Molecule_external_force_expiry(force._end_time, force._molecule_id));
 }
 
 
@@ -1153,57 +1950,78 @@ void Core::load_level_defaults()
     clear();
     _level_data.load_defaults();
 
+#ifndef PARTICULAR_HEADLESS
     Main_options_window::get_instance()->add_parameter_list("Level Data", _level_data._parameters);
 
     change_level_state(Main_game_screen::Level_state::Running);
+#endif
 }
 
 void Core::load_level(std::string const& file_name)
 {
-    std::cout << __FUNCTION__ << " " << file_name << std::endl;
+    LOG_DEBUG(file_name);
+
+    read_level([&file_name](Level_data & level_data) { load_level_file(level_data, file_name); }, file_name);
+}
+
+void Core::load_level(std::istream & in, std::string const& file_name)
+{
+    read_level([&in](Level_data & level_data)
+    {
+        boost::archive::xml_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("_level_data", level_data);
+    }, file_name);
+}
+
+void Core::read_level(std::function<void(Level_data &)> const& read_level_data, std::string const& file_name)
+{
+    cancel_level_loading();
 
     clear();
     set_simulation_state(false);
 
-    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in);
-    boost::archive::xml_iarchive ia(in_file);
-
     try
     {
-        ia >> BOOST_SERIALIZATION_NVP(_level_data);
-        std::cout << __FUNCTION__ << " A " << _level_data._parameters["gravity"]->get_value<float>() << std::endl;
+        read_level_data(_level_data);
+        LOG_DEBUG("A " << _level_data._parameters["gravity"]->get_value<float>());
     }
     catch (boost::archive::archive_exception & e)
     {
-        std::cout << "Boost Archive Exception. Failed to load level file: " << file_name << ", reason: " << e.what() << std::endl;
+        LOG_WARNING("Boost Archive Exception. Failed to load level file: " << file_name << ", reason: " << e.what());
         load_level_defaults();
     }
     catch (std::exception & e)
     {
-        std::cout << "Failed to load level file: " << file_name << ", level reset: " << e.what() << std::endl;
+        LOG_WARNING("Failed to load level file: " << file_name << ", level reset: " << e.what());
         load_level_defaults();
     }
     catch (...)
     {
         load_level_defaults();
+#ifndef PARTICULAR_HEADLESS
         QMessageBox::warning(nullptr, "Error", QString("Error reading the specified level file ") + QString::fromStdString(file_name) + "\nLoading defaults.");
+#else
+        LOG_WARNING("Error reading the specified level file " << file_name << ", loading defaults.");
+#endif
     }
 
-    in_file.close();
-
 //    update_parameters();
     _level_data.update_parameters();
 
+#ifndef PARTICULAR_HEADLESS
     Main_options_window::get_instance()->add_parameter_list("Level Data", _level_data._parameters);
+#endif
 
 
     assert(_level_data.validate_elements());
 
     reset_level(true);
 
-    std::cout << __FUNCTION__ << " B " << _level_data._parameters["gravity"]->get_value<float>() << std::endl;
+    LOG_DEBUG("B " << _level_data._parameters["gravity"]->get_value<float>());
 
+#ifndef PARTICULAR_HEADLESS
     change_level_state(Main_game_screen::Level_state::Running);
+#endif
 }
 
 void Core::load_level(const int level_index)
@@ -1214,14 +2032,90 @@ void Core::load_level(const int level_index)
 
         std::string const filename = get_level_file_name(_current_level_index);
 
-        load_level(filename);
+        load_level_async(filename);
     }
 }
 
+void Core::load_level_async(const std::string &file_name)
+{
+    LOG_DEBUG(file_name);
+
+    cancel_level_loading();
+
+    set_simulation_state(false);
+
+    _loading_level_data.reset(new Level_data);
+    _loading_level_file_name = file_name;
+    _level_loading_error = nullptr;
+    _level_loading_done = false;
+    _level_loading_progress = 0.0f;
+
+    Level_data * level_data = _loading_level_data.get();
+
+    _level_loading_thread = std::thread([this, level_data, file_name]()
+    {
+        try
+        {
+            // parsing is most of the work, the rest is the swap and reset_level() on the GUI thread
+            load_level_file(*level_data, file_name, [this](float const fraction) { _level_loading_progress = 0.9f * fraction; });
+
+#ifndef PARTICULAR_HEADLESS
+            // decoded while the level start screen is shown
+            Shader_renderer::prefetch_backdrop(level_data->_background_name);
+#endif
+        }
+        catch (...)
+        {
+            _level_loading_error = std::current_exception();
+        }
+
+        _level_loading_progress = 0.9f;
+        _level_loading_done = true;
+    });
+}
+
+bool Core::finish_level_loading(const bool wait)
+{
+    if (!_level_loading_thread.joinable() || (!wait && !_level_loading_done)) return false;
+
+    _level_loading_thread.join();
+
+    std::unique_ptr<Level_data> const loaded_level_data = std::move(_loading_level_data);
+    std::exception_ptr const error = _level_loading_error;
+    _level_loading_error = nullptr;
+
+    // errors of the worker end up in read_level()'s handlers like those of a synchronous load
+    read_level([&loaded_level_data, &error](Level_data & level_data)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        level_data.swap_level_contents(*loaded_level_data);
+    }, _loading_level_file_name);
+
+    _level_loading_progress = 1.0f;
+
+    return true;
+}
+
+void Core::cancel_level_loading()
+{
+    if (!_level_loading_thread.joinable()) return;
+
+    _level_loading_thread.join();
+    _loading_level_data.reset();
+    _level_loading_error = nullptr;
+    _level_loading_progress = 1.0f;
+}
+
+#ifndef PARTICULAR_HEADLESS
 void Core::change_level_state(const Main_game_screen::Level_state new_level_state)
 {
     Q_EMIT level_changed(new_level_state);
 }
+#endif
 
 int Core::get_current_level_index() const
 {
@@ -1240,11 +2134,11 @@ void Core::load_next_level()
 {
     int const next_level_index = _current_level_index + 1;
 
-    std::cout << __FUNCTION__ << " next level: " << next_level_index << std::endl;
+    LOG_INFO("next level: " << next_level_index);
 
     if (_level_names.size() <= next_level_index)
     {
-        std::cout << "No more levels." << std::endl;
+        LOG_WARNING("No more levels.");
         return;
     }
 
@@ -2,9 +2,19 @@
 #define CORE_H
 
 #include <QObject>
+#include <QTimer>
+#include <QStringList>
 
 #include <vector>
+#include <queue>
+#include <unordered_map>
 #include <chrono>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <typeinfo>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -17,20 +27,33 @@
 
 #include "Registry_parameters.h"
 #include "unique_ptr_serialization.h"
+#ifndef PARTICULAR_HEADLESS
 #include "GPU_force.h"
+#endif
 #include "Atom.h"
 #include "Atomic_force.h"
+#include "Atom_soa.h"
+#include "Timing_window.h"
+#include "Input_recording.h"
+#include "Checkpoint_buffer.h"
+#include "Memory_accounting.h"
+#include "Force_field.h"
+#include "Force_table.h"
 #include "Level_element.h"
 #include "Level_data.h"
 #include "End_condition.h"
 #include "Sensor_data.h"
 #include "Progress.h"
+#ifndef PARTICULAR_HEADLESS
 #include "Main_game_screen.h"
+#endif
 #include "Random_generator.h"
-#include "Fps.h"
 
 void update_temperature_grid(Level_data const& level_data, Frame_buffer<float> & grid);
 
+class Rewind_buffer;
+class Trajectory_recorder;
+
 class Core : public QObject
 {
     Q_OBJECT
@@ -38,6 +61,8 @@ public:
 
     enum class Game_state { Unstarted, Running, Finished };
 
+    enum class Force_backend { GPU = 0, CPU };
+
     struct Molecule_atom_id
     {
         Molecule_atom_id(int const m, int const a) : m_id(m), a_id(a)
@@ -79,6 +104,60 @@ public:
         float _end_time;
     };
 
+    struct Molecule_external_force_expiry
+    {
+        Molecule_external_force_expiry(float const end_time, int const molecule_id) : _end_time(end_time), _molecule_id(molecule_id)
+        { }
+
+        bool operator> (Molecule_external_force_expiry const& rhs) const
+        {
+            return _end_time > rhs._end_time;
+        }
+
+        float _end_time;
+        int _molecule_id;
+    };
+
+    // expiry times in a min-heap so only expired buckets are touched
+    typedef std::priority_queue< Molecule_external_force_expiry, std::vector<Molecule_external_force_expiry>, std::greater<Molecule_external_force_expiry> > Molecule_external_force_expiry_queue;
+
+    // Complete simulation state in memory: molecules, external forces, sensor data, times and step count, the random
+    // generator and the runtime state of the level elements (Level_element::save_state()). Taking one again reuses
+    // its allocations. Placement and properties of the elements are not part of it.
+    struct Checkpoint
+    {
+        Checkpoint() : _valid(false) { }
+
+        struct Element_entry
+        {
+            Level_element const* _element;
+            std::type_info const* _type;
+            size_t _byte_position;
+            size_t _molecule_position;
+        };
+
+        bool _valid;
+
+        std::list<Molecule> _molecules;
+        int _molecule_id_counter;
+        int _num_atoms;
+
+        std::unordered_map< int, std::vector<Molecule_external_force> > _molecule_external_forces;
+        Molecule_external_force_expiry_queue _molecule_external_force_expiries;
+
+        Sensor_data _sensor_data;
+
+        float _current_time;
+        float _last_animation_time;
+        float _last_sensor_check;
+        unsigned long long _num_steps;
+
+        Random_generator _random_generator;
+
+        std::vector<Element_entry> _elements;
+        Checkpoint_buffer _element_states;
+    };
+
     void check_molecules_in_portals();
 
     void update(float const time_step);
@@ -135,7 +214,9 @@ public:
 
     float get_current_time() const;
 
+#ifndef PARTICULAR_HEADLESS
     void gl_init(QGLContext *);
+#endif
 
     Molecule_external_force & get_user_force();
     Molecule_external_force const& get_user_force() const;
@@ -157,15 +238,56 @@ public:
     void clear();
     void reset_level(bool const keep_molecules = false);
 
+    void save_checkpoint(Checkpoint & checkpoint) const;
+    void restore_checkpoint(Checkpoint const& checkpoint);
+
+    // "retry from checkpoint" in the game, not while recording or replaying input
+    void save_checkpoint();
+    bool restore_checkpoint();
+    bool has_checkpoint() const { return _user_checkpoint._valid; }
+
+    // back to the state at start_level() from the checkpoint taken there, falls back to reset_level()
+    void restart_level();
+
+    // history captured every "rewind_interval_steps" physics steps when "rewind_budget_mb" > 0, not while recording or replaying input
+    Rewind_buffer const& get_rewind_buffer() const { return *_rewind_buffer; }
+    // approximate state at the given time from the history, pauses the simulation and keeps the live state
+    bool preview_rewind(float const time);
+    bool is_previewing_rewind() const { return _rewind_preview_time >= 0.0f; }
+    float get_rewind_preview_time() const { return _rewind_preview_time; }
+    // commit continues from the previewed time (see rewind()), otherwise the live state comes back
+    void end_rewind_preview(bool const commit);
+    // exact: restores the keyframe before the time and replays the physics steps up to it with the current time step
+    bool rewind(float const time);
+
+    // streams the molecule states every interval_steps physics steps to a file in the background, see Trajectory.h.
+    // The atom forces are the last evaluated ones, at the half step with the midpoint integration.
+    // Stops when the level is reset, replaced or a checkpoint restored.
+    bool start_trajectory_recording(std::string const& file_name, int const interval_steps, bool const record_forces);
+    void stop_trajectory_recording();
+    Trajectory_recorder const* get_trajectory_recorder() const { return _trajectory_recorder.get(); }
+
     void save_simulation_settings();
     void load_simulation_settings();
     void load_default_simulation_settings();
 
     void save_level(std::string const& file_name) const;
+    void save_level(std::ostream & out) const;
     void load_level(std::string const& file_name);
+    void load_level(std::istream & in, std::string const& file_name);
     void load_level(const int level_index);
     void load_next_level();
+
+    // reads the level on a worker thread into a second Level_data, the current level stays untouched until
+    // finish_level_loading() swaps the loaded one in; load_level(level_index) and load_next_level() use it in the game
+    void load_level_async(std::string const& file_name);
+    // once per frame on the GUI thread, returns true when a loaded level was swapped in; wait blocks until the worker is done
+    bool finish_level_loading(bool const wait = false);
+    bool is_level_loading() const { return _level_loading_thread.joinable(); }
+    float get_level_loading_progress() const { return _level_loading_progress; }
+#ifndef PARTICULAR_HEADLESS
     void change_level_state(Main_game_screen::Level_state const new_level_state);
+#endif
 
     int get_current_level_index() const;
 //    void set_current_level_index(int const level_index);
@@ -185,6 +307,33 @@ public:
     bool get_simulation_state() const;
     void update_physics_timestep();
 
+    // deterministic input record / replay, see Input_recording.h
+    // recording takes the level, settings and seed at the next start_level() and the commands after it
+    void start_input_recording();
+    bool save_input_recording(std::string const& file_name);
+    bool start_input_replay(std::string const& file_name);
+    bool is_replaying_input() const; // until the recorded number of steps is reached
+
+    // user commands, only stored while recording a running level
+    void record_element_change(Level_element * element, Parameter_list const& properties);
+    void record_element_addition(Level_element * element);
+    void record_element_deletion(Level_element const* element);
+    void record_molecule_addition(std::string const& molecule_type, Eigen::Vector3f const& position);
+    void record_parameter_change(std::string const& name);
+
+    // physics steps since start_level()
+    unsigned long long get_num_steps() const { return _num_steps; }
+
+    int get_num_atoms() const { return _num_atoms; }
+    int get_max_num_atoms() const;
+
+    // number of atom pairs (receiver, sender of another molecule) evaluated by the force backend since construction
+    unsigned long long get_num_evaluated_atom_pairs() const { return _num_evaluated_atom_pairs; }
+
+    // wall time of the last physics steps and of the force evaluations within them, in milliseconds
+    Timing_window const& get_physics_step_times() const { return _physics_step_times; }
+    Timing_window const& get_force_evaluation_times() const { return _force_evaluation_times; }
+
 //    void set_parameters(Parameter_list const& parameters);
 //    QWidget * get_parameter_widget() const;
     Parameter_list & get_parameters() { return _parameters; }
@@ -192,6 +341,7 @@ public:
 
     void update_variables();
     void update_parameters();
+    void update_force_table();
 
     void load_level_defaults();
 
@@ -222,9 +372,15 @@ public Q_SLOTS:
 
 Q_SIGNALS:
     void game_state_changed();
+    void level_elements_changed(); // by a replayed command or a restored checkpoint
+#ifndef PARTICULAR_HEADLESS
     void level_changed(Main_game_screen::Level_state);
+#endif
 
 private:
+    std::vector<Eigen::Vector3f> const& calc_forces_on_atoms(std::list<Molecule> const& molecules, float const time);
+    std::vector<Eigen::Vector3f> const& calc_forces_on_atoms_cpu(std::list<Molecule> const& molecules, float const time);
+
     Level_data _level_data;
 
     Game_state _game_state;
@@ -232,7 +388,29 @@ private:
 
 //    std::vector<Force_indicator> _indicators;
 
-    std::vector<Molecule_external_force> _molecule_external_forces;
+    void remove_expired_molecule_external_forces();
+
+    // estimates the level data, sensor data and CPU force buffer sizes for the memory accounting
+    void update_memory_usage();
+
+    enum class Input_mode { None, Recording, Replaying };
+
+    // clears the level, reads it with the given function and prepares it for playing, see load_level()
+    void read_level(std::function<void(Level_data &)> const& read_level_data, std::string const& file_name);
+
+    // waits for a running asynchronous load and drops its result
+    void cancel_level_loading();
+
+    void begin_input_recording();
+    void add_input_command(Input_command & command);
+    void apply_input_commands();
+    void apply_input_command(Input_command const& command);
+    void seed_random_generators(unsigned int const seed);
+    int get_level_element_index(Level_element const* element) const;
+
+    // forces per molecule id
+    std::unordered_map< int, std::vector<Molecule_external_force> > _molecule_external_forces;
+    Molecule_external_force_expiry_queue _molecule_external_force_expiries;
 
     std::unordered_map<int, Molecule*> _molecule_id_to_molecule_map;
 
@@ -242,6 +420,33 @@ private:
     Molecule_external_force _user_force;
 
     std::vector< std::unique_ptr<Atomic_force> > _atomic_forces;
+    std::unique_ptr<Force_field_base> _force_field; // specialized for the enabled _atomic_forces
+    Atomic_force const* _wendland_force; // in _atomic_forces when enabled, not part of the force table
+
+    Force_table _force_table;
+    bool _use_force_table;
+    Force_table::Interpolation _force_table_interpolation;
+
+    Force_backend _force_backend; // GPU falls back to CPU without a GL context
+
+    // CPU backend buffers, kept to avoid reallocation every step
+    Atom_soa _cpu_atoms;
+    Force_soa _cpu_forces;
+    std::vector<Eigen::Vector3f> _cpu_forces_on_atoms;
+    std::vector<Eigen::Vector3f> const* _last_forces_on_atoms; // CPU or GPU buffer of the last calc_forces_on_atoms()
+
+    unsigned long long _num_evaluated_atom_pairs;
+
+    Timing_window _physics_step_times;
+    Timing_window _force_evaluation_times;
+    float _force_evaluation_milliseconds; // of the current step
+
+    Memory_account _molecule_memory;
+    Memory_account _atom_memory;
+    Memory_account _level_element_memory;
+    Memory_account _particle_system_memory;
+    Memory_account _sensor_data_memory;
+    Memory_account _force_buffer_memory;
 
     float _mass_factor;
 
@@ -257,6 +462,17 @@ private:
 
     Parameter_list _parameters;
 
+    // resolved once in the constructor, read every physics step
+    Parameter_handle<bool>  _simulation_toggle_handle;
+    Parameter_handle<bool>  _use_midpoint_handle;
+    Parameter_handle<int>   _physics_timestep_handle;
+    Parameter_handle<float> _physics_speed_handle;
+    Parameter_handle<float> _coulomb_strength_handle;
+    Parameter_handle<float> _vdw_strength_handle;
+    Parameter_handle<float> _vdw_radius_factor_handle;
+    Parameter_handle<float> _wendland_strength_handle;
+    Parameter_handle<float> _wendland_radius_handle;
+
     Progress _progress;
 
     QTimer _physics_timer;
@@ -269,11 +485,34 @@ private:
     int _current_level_index;
 //    std::string _current_level_name;
 
+#ifndef PARTICULAR_HEADLESS
     std::unique_ptr<GPU_force> _gpu_force;
+#endif
 
     Random_generator _random_generator;
 
-    Fps_meter _fps_meter;
+    Input_mode _input_mode;
+    Input_recording _input_recording;
+    size_t _next_input_command; // when replaying
+    unsigned long long _num_steps;
+
+    Checkpoint _level_start_checkpoint;
+    Checkpoint _user_checkpoint;
+
+    std::unique_ptr<Rewind_buffer> _rewind_buffer;
+    int _rewind_interval_steps;
+    Checkpoint _rewind_live_checkpoint; // while previewing
+    float _rewind_preview_time;         // negative when not previewing
+
+    std::unique_ptr<Trajectory_recorder> _trajectory_recorder; // nullptr when not recording
+    int _trajectory_interval_steps;
+
+    std::thread _level_loading_thread;
+    std::unique_ptr<Level_data> _loading_level_data;
+    std::string _loading_level_file_name;
+    std::exception_ptr _level_loading_error;
+    std::atomic<bool> _level_loading_done;
+    std::atomic<float> _level_loading_progress;
 };
 
 //REGISTER_BASE_CLASS_WITH_PARAMETERS(Core);
@@ -1,6 +1,14 @@
 #include "Data_config.h"
 
-Data_config * Data_config::_data_config = nullptr;
+#include "Message_logger.h"
+
+Data_config *Data_config::create()
+{
+    Data_config * data_config = new Data_config;
+    data_config->init();
+
+    return data_config;
+}
 
 
 QString Data_config::get_absolute_qfilename(const QString &relative_path, const bool check_existence) const
@@ -58,19 +66,23 @@ void Data_config::init()
 
     if (_data_paths.empty())
     {
-        std::cout << __FUNCTION__ << " no data paths found" << std::endl;
+        LOG_ERROR("no data paths found");
 
+#ifndef PARTICULAR_HEADLESS
         QMessageBox e;
         e.setText("Data path could not be found. Make sure the folder data is in the same directory as the executable.");
         e.exec();
+#endif
 
+        // the writer thread doesn't get to it otherwise
+        Message_logger::get_instance()->shutdown();
         abort();
     }
     else
     {
         for (QString const p : _data_paths)
         {
-            std::cout << __FUNCTION__ << " data path found: " << p.toStdString() << std::endl;
+            LOG_INFO("data path found: " << p.toStdString());
         }
     }
 }
@@ -5,7 +5,9 @@
 #include <cassert>
 #include <QCoreApplication>
 #include <QDir>
+#ifndef PARTICULAR_HEADLESS
 #include <QMessageBox>
+#endif
 #include <vector>
 
 class Data_config
@@ -13,13 +15,10 @@ class Data_config
 public:
     static Data_config * get_instance()
     {
-        if (!_data_config)
-        {
-            _data_config = new Data_config;
-            _data_config->init();
-        }
+        // the level loading thread can be the first user
+        static Data_config * const data_config = create();
 
-        return _data_config;
+        return data_config;
     }
 
 //    std::string const& get_data_path() const
@@ -42,9 +41,9 @@ public:
 //    }
 
 private:
-    void init();
+    static Data_config * create();
 
-    static Data_config * _data_config;
+    void init();
 
     std::string _data_path;
     QStringList _data_paths;
@@ -50,7 +50,7 @@ GLuint generate_info_label_texture(Info_label const& label, int const text_align
     GL_functions f;
     f.init();
 
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(img);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(img);
     return f.create_texture(texture_fb, false);
 }
 
@@ -58,6 +58,7 @@ GLuint generate_info_label_texture(Info_label const& label, int const text_align
 void Info_label::set_text(std::string const& text, QFont const& font)
 {
     _text = text;
+    Memory_accounting::get_instance()->remove_texture(_texture_id);
     glDeleteTextures(1, &_texture_id);
     _texture_id = generate_info_label_texture(*this, Qt::AlignLeft | Qt::AlignVCenter, font);
 }
@@ -1,5 +1,8 @@
 #include "Draggable.h"
 
+#include "Memory_accounting.h"
+#include "Message_logger.h"
+
 
 Draggable_slider::Draggable_slider(const Eigen::Vector3f &position, const Eigen::Vector2f &size, Parameter *parameter, std::function<void ()> callback) :
     Draggable_label(position, size, ""), _callback(callback), _parameter(parameter)
@@ -125,7 +128,7 @@ Draggable_slider::~Draggable_slider()
 
 Draggable_tooltip::~Draggable_tooltip()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 }
 
 void Draggable_tooltip::start_fade_in()
@@ -333,6 +336,7 @@ std::vector<Draggable *> Draggable_label::get_draggables(const Level_element::Ed
 
 Draggable_label::~Draggable_label()
 {
+    Memory_accounting::get_instance()->remove_texture(_texture);
     glDeleteTextures(1, &_texture);
 }
 
@@ -1022,7 +1026,7 @@ void Draggable_box::init()
 
 void Draggable_box::visit(Molecule_releaser *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1031,7 +1035,7 @@ void Draggable_box::visit(Molecule_releaser *b) const
 
 void Draggable_box::visit(Plane_barrier *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_extent(Eigen::Vector2f(_extent_2[0] * 2.0f, _extent_2[1] * 2.0f));
@@ -1040,7 +1044,7 @@ void Draggable_box::visit(Plane_barrier *b) const
 
 void Draggable_box::visit(Sphere_portal *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1049,7 +1053,7 @@ void Draggable_box::visit(Sphere_portal *b) const
 
 void Draggable_box::visit(Box_portal *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1058,7 +1062,7 @@ void Draggable_box::visit(Box_portal *b) const
 
 void Draggable_box::visit(Blow_barrier *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1067,7 +1071,7 @@ void Draggable_box::visit(Blow_barrier *b) const
 
 void Draggable_box::visit(Charged_barrier *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1076,7 +1080,7 @@ void Draggable_box::visit(Charged_barrier *b) const
 
 void Draggable_box::visit(Box_barrier *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1085,7 +1089,7 @@ void Draggable_box::visit(Box_barrier *b) const
 
 void Draggable_box::visit(Moving_box_barrier *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1094,7 +1098,7 @@ void Draggable_box::visit(Moving_box_barrier *b) const
 
 void Draggable_box::visit(Brownian_box *b) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     b->set_transform(_transform);
     b->set_position(get_position());
     b->set_size(_extent_2 * 2.0f);
@@ -1124,7 +1128,7 @@ void Draggable_spinbox::init()
 
 void Draggable_spinbox::update()
 {
-    std::cout << __FUNCTION__ << " implement!" << std::endl;
+    LOG_WARNING("implement!");
 
     int new_value = _parameter->get_value<int>();
 
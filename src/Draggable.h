@@ -504,6 +504,9 @@ public:
     void set_transform(Eigen::Transform<float, 3, Eigen::Affine> const& transform);
     Eigen::Transform<float, 3, Eigen::Affine> get_transform() const override;
 
+    // edited property values, written into the element on accept()
+    Parameter_list const& get_properties() const { return _properties; }
+
     void visit(Brownian_box * b) const override;
     void visit(Moving_box_barrier * b) const override;
     void visit(Box_barrier * b) const override;
@@ -3,6 +3,7 @@
 #include "Editor_screen.h"
 #include "My_viewer.h"
 #include "Main_menu_screen.h"
+#include "Message_logger.h"
 
 Editor_pause_screen::Editor_pause_screen(My_viewer &viewer, Core &core, Screen *calling_state) : Menu_screen(viewer, core), _calling_screen(calling_state)
 {
@@ -18,7 +19,7 @@ bool Editor_pause_screen::keyPressEvent(QKeyEvent *event)
 {
     bool handled = false;
 
-    std::cout << __FUNCTION__ << " " << event->key() << " state: " << int(get_state()) << std::endl;
+    LOG_DEBUG(event->key() << " state: " << int(get_state()));
 
     if (event->key() == Qt::Key_Escape)
     {
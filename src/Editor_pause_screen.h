@@ -7,6 +7,7 @@ class Editor_pause_screen : public Menu_screen
 {
 public:
     Editor_pause_screen(My_viewer & viewer, Core & core, Screen * calling_state);
+    char const* get_name() const override { return "Editor_pause_screen"; }
 
     bool keyPressEvent(QKeyEvent * event) override;
 
@@ -2,6 +2,7 @@
 
 #include "Editor_pause_screen.h"
 #include "My_viewer.h"
+#include "Message_logger.h"
 
 
 std::string get_element_description(std::string const& element_type)
@@ -67,7 +68,7 @@ Editor_screen::Editor_screen(My_viewer &viewer, Core &core) : Main_game_screen(v
 
 Editor_screen::~Editor_screen()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     Main_options_window::get_instance()->remove_parameter_list("Editor_screen");
 }
 
@@ -91,7 +92,7 @@ bool Editor_screen::mousePressEvent(QMouseEvent * event)
     _picked_index = _picking.do_pick(event->pos().x() / float(_viewer.camera()->screenWidth()), (_viewer.camera()->screenHeight() - event->pos().y())  / float(_viewer.camera()->screenHeight()),
                                      std::bind(&Main_game_screen::draw_draggables_for_picking, this));
 
-    std::cout << __FUNCTION__ << " picked_index: " << _picked_index << std::endl;
+    LOG_DEBUG("picked_index: " << _picked_index);
 
     if (_picked_index != -1)
     {
@@ -108,7 +109,7 @@ bool Editor_screen::mousePressEvent(QMouseEvent * event)
         qglviewer::Vec const world_pos = _viewer.camera()->pointUnderPixel(event->pos(), found);
 
         _mouse_state = Mouse_state::Init_drag_handle;
-        std::cout << __FUNCTION__ << " Init_drag_handle" << std::endl;
+        LOG_DEBUG("Init_drag_handle");
 
         if (found)
         {
@@ -178,7 +179,7 @@ bool Editor_screen::mouseMoveEvent(QMouseEvent * event)
 
             //            if (!check_for_collision(level_element))
             {
-                std::cout << __FUNCTION__ << ": " << parent << std::endl;
+                LOG_DEBUG(parent);
 
                 level_element->accept(parent);
             }
@@ -196,7 +197,7 @@ bool Editor_screen::mouseMoveEvent(QMouseEvent * event)
             if (_picked_index != -1)
             {
                 // stopped hovering over item
-                std::cout << __FUNCTION__ << " stopped hovering" << std::endl;
+                LOG_DEBUG("stopped hovering");
 
                 Draggable * parent = _active_draggables[_picked_index]->get_parent();
                 _labels.erase(std::remove(_labels.begin(), _labels.end(), _tooltips_map[parent]), _labels.end());
@@ -210,7 +211,7 @@ bool Editor_screen::mouseMoveEvent(QMouseEvent * event)
                 // entered new picked item
 
                 _picked_index = new_picking_index;
-                std::cout << __FUNCTION__ << " started hovering" << std::endl;
+                LOG_DEBUG("started hovering");
 
                 Draggable * parent = _active_draggables[_picked_index]->get_parent();
 
@@ -238,7 +239,7 @@ bool Editor_screen::mouseReleaseEvent(QMouseEvent * event)
 
     if (_mouse_state == Mouse_state::Init_drag_handle)
     {
-        std::cout << __FUNCTION__ << " click on handle" << std::endl;
+        LOG_DEBUG("click on handle");
 
         _mouse_state = Mouse_state::None;
 
@@ -316,7 +317,7 @@ bool Editor_screen::keyPressEvent(QKeyEvent * event)
 {
     bool handled = false;
 
-    std::cout << __FUNCTION__ << " " << event->key() << std::endl;
+    LOG_DEBUG(event->key());
 
     if (event->key() == Qt::Key_Escape)
     {
@@ -346,7 +347,7 @@ bool Editor_screen::keyPressEvent(QKeyEvent * event)
     }
     else if (event->key() == Qt::Key_F11)
     {
-        std::cout << __func__ << " re-init screen" << std::endl;
+        LOG_DEBUG("re-init screen");
 
         _renderer->init(_viewer.context(), QSize(_viewer.camera()->screenWidth(), _viewer.camera()->screenHeight()));
 
@@ -358,7 +359,7 @@ bool Editor_screen::keyPressEvent(QKeyEvent * event)
 
 void Editor_screen:: init_controls()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     int i = 0;
 
@@ -386,7 +387,7 @@ void Editor_screen:: init_controls()
         button->set_tooltip_text(get_element_description(iter.first));
 //        button->set_texture(_viewer.bindTexture(button_img));
 
-        Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(button_img);
+        Frame_buffer<Color4> texture_fb = convert_to_color4(button_img);
         button->set_texture(f.create_texture(texture_fb));
 
         _buttons.push_back(button);
@@ -712,7 +713,7 @@ void Editor_screen::level_element_button_pressed(const std::string &type)
 
 void Editor_screen::molecule_button_right_click_event(std::string const& type)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     QMenu menu;
 
@@ -738,7 +739,7 @@ void Editor_screen::molecule_button_right_click_event(std::string const& type)
 
 void Editor_screen::parameter_slider_right_click_event(std::string const& parameter_name)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     Parameter * parameter = _slider_parameter_names_to_parameters[parameter_name];
 
@@ -816,7 +817,7 @@ void Editor_screen::toggle_simulation()
 
 void Editor_screen::slider_changed()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 }
 
 void Editor_screen::reset_level()
@@ -840,7 +841,7 @@ void Editor_screen::reset_level()
 
 void Editor_screen::hide_controls()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     for (boost::shared_ptr<Draggable> const& d : _normal_controls)
     {
@@ -860,7 +861,7 @@ void Editor_screen::hide_controls()
 
 void Editor_screen::show_controls()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
 //    for (boost::shared_ptr<Draggable_button> const& b : _buttons)
 //    {
@@ -11,6 +11,7 @@ class Editor_screen : public Main_game_screen
 public:
     Editor_screen(My_viewer & viewer, Core & core);
     ~Editor_screen();
+    char const* get_name() const override { return "Editor_screen"; }
 
     bool mousePressEvent(QMouseEvent *event) override;
     bool mouseMoveEvent(QMouseEvent *) override;
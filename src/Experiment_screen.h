@@ -7,6 +7,7 @@ class Experiment_screen : public Menu_screen
 {
 public:
     Experiment_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "Experiment_screen"; }
 
     void draw() override;
 
@@ -3,6 +3,8 @@
 
 #include <QtGui>
 
+#include "Message_logger.h"
+
 template <class State>
 class StateLabel : public QLabel
 {
@@ -105,7 +107,7 @@ public:
     {
         if (_widget)
         {
-            std::cout << "Already have a widget" << std::endl;
+            LOG_WARNING("Already have a widget");
             return;
         }
 
@@ -155,7 +157,7 @@ public:
 
     static void test()
     {
-        std::cout << "FoldableGroupBox::test();" << std::endl;
+        LOG_DEBUG("FoldableGroupBox::test();");
 
         QLabel* l1 = new QLabel("Label1");
         QLabel* l2 = new QLabel("Label2");
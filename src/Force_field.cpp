@@ -0,0 +1,125 @@
+#include "Force_field.h"
+
+
+Eigen::Vector3f Generic_force_field::calc_force_between_atoms(const Atom &a_0, const Atom &a_1) const
+{
+    Eigen::Vector3f resulting_force(0.0f, 0.0f, 0.0f);
+
+    for (std::unique_ptr<Atomic_force> const& force : _forces)
+    {
+        resulting_force += force->calc_force_between_atoms(a_0, a_1);
+    }
+
+    return resulting_force;
+}
+
+
+Eigen::Vector3f Generic_force_field::apply_forces_brute_force(const Atom &receiver_atom, const std::list<Molecule> &molecules, const float max_distance) const
+{
+    Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
+
+    for (Molecule const& sender : molecules)
+    {
+        if (sender.get_id() == receiver_atom._parent_id) continue;
+
+        for (Atom const& sender_atom : sender._atoms)
+        {
+            float const dist = (receiver_atom.get_position() - sender_atom.get_position()).norm();
+
+            if (dist > 1e-4f && dist < max_distance)
+            {
+                force_i += calc_force_between_atoms(receiver_atom, sender_atom);
+            }
+        }
+    }
+
+    return force_i;
+}
+
+
+Eigen::Vector3f Generic_force_field::apply_forces_from_vector(const Atom &receiver_atom, const std::vector<const Atom *> &atoms) const
+{
+    Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
+
+    for (Atom const* a : atoms)
+    {
+        force_i += calc_force_between_atoms(receiver_atom, *a);
+    }
+
+    return force_i;
+}
+
+
+void Generic_force_field::calc_forces(const Atom_span &receivers, const Atom_span &senders, const Force_span &forces) const
+{
+    for (std::unique_ptr<Atomic_force> const& force : _forces)
+    {
+        force->calc_forces(receivers, senders, forces);
+    }
+}
+
+
+namespace
+{
+
+// Instantiates Force_field<...> for every subset of the listed forces: each step either takes the force
+// (if it is enabled) or skips it, the selected ones are passed on and become the Force_field's parameters.
+template <class... Remaining>
+struct Force_field_factory;
+
+template <>
+struct Force_field_factory<>
+{
+    static bool is_known(Atomic_force const* )
+    {
+        return false;
+    }
+
+    template <class... Selected>
+    static std::unique_ptr<Force_field_base> create(std::vector< std::unique_ptr<Atomic_force> > const& , Selected const&... selected)
+    {
+        return std::unique_ptr<Force_field_base>(new Force_field<Selected...>(selected...));
+    }
+};
+
+template <class Force, class... Remaining>
+struct Force_field_factory<Force, Remaining...>
+{
+    static bool is_known(Atomic_force const* force)
+    {
+        return dynamic_cast<Force const*>(force) || Force_field_factory<Remaining...>::is_known(force);
+    }
+
+    template <class... Selected>
+    static std::unique_ptr<Force_field_base> create(std::vector< std::unique_ptr<Atomic_force> > const& forces, Selected const&... selected)
+    {
+        for (std::unique_ptr<Atomic_force> const& f : forces)
+        {
+            if (Force const* force = dynamic_cast<Force const*>(f.get()))
+            {
+                return Force_field_factory<Remaining...>::create(forces, selected..., *force);
+            }
+        }
+
+        return Force_field_factory<Remaining...>::create(forces, selected...);
+    }
+};
+
+// all registered Atomic_forces
+typedef Force_field_factory<Coulomb_force, Lennard_jones_force, Wendland_force> Registered_force_field_factory;
+
+}
+
+
+std::unique_ptr<Force_field_base> create_force_field(const std::vector<std::unique_ptr<Atomic_force> > &forces)
+{
+    for (std::unique_ptr<Atomic_force> const& f : forces)
+    {
+        if (!Registered_force_field_factory::is_known(f.get()))
+        {
+            return std::unique_ptr<Force_field_base>(new Generic_force_field(forces));
+        }
+    }
+
+    return Registered_force_field_factory::create(forces);
+}
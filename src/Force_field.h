@@ -0,0 +1,146 @@
+#ifndef FORCE_FIELD_H
+#define FORCE_FIELD_H
+
+#include <tuple>
+#include <memory>
+#include <list>
+
+#include "Atomic_force.h"
+
+// A set of atomic forces evaluated together. Concrete Force_field<...> instances call the
+// non-virtual calc_force_magnitude() of each force, so the pair loop is inlined and the
+// distance is computed once per pair instead of once per force. The virtual call happens
+// once per receiving atom, the combination is chosen once per parameter change in create_force_field().
+class Force_field_base
+{
+public:
+    virtual ~Force_field_base() {}
+
+    virtual Eigen::Vector3f calc_force_between_atoms(Atom const& a_0, Atom const& a_1) const = 0;
+
+    virtual Eigen::Vector3f apply_forces_brute_force(Atom const& receiver_atom, std::list<Molecule> const& molecules, float const max_distance) const = 0;
+
+    virtual Eigen::Vector3f apply_forces_from_vector(Atom const& receiver_atom, std::vector<Atom const*> const& atoms) const = 0;
+
+    // batch evaluation of all forces, see Atomic_force::calc_forces()
+    virtual void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const = 0;
+};
+
+
+template <std::size_t N, class Tuple>
+struct Force_magnitude_sum
+{
+    template <class Atom_type>
+    static float calc(Tuple const& forces, float const distance, Atom_type const& a_0, Atom_type const& a_1)
+    {
+        return std::get<N - 1>(forces).calc_force_magnitude(distance, a_0, a_1) + Force_magnitude_sum<N - 1, Tuple>::calc(forces, distance, a_0, a_1);
+    }
+};
+
+template <class Tuple>
+struct Force_magnitude_sum<0, Tuple>
+{
+    template <class Atom_type>
+    static float calc(Tuple const& , float const , Atom_type const& , Atom_type const& )
+    {
+        return 0.0f;
+    }
+};
+
+
+template <class... Forces>
+class Force_field : public Force_field_base
+{
+public:
+    explicit Force_field(Forces const&... forces) : _forces(forces...)
+    { }
+
+    Eigen::Vector3f calc_force_between_atoms(Atom const& a_0, Atom const& a_1) const override
+    {
+        return calc_pair_force(a_0, a_1);
+    }
+
+    Eigen::Vector3f apply_forces_brute_force(Atom const& receiver_atom, std::list<Molecule> const& molecules, float const max_distance) const override
+    {
+        Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
+
+        for (Molecule const& sender : molecules)
+        {
+            if (sender.get_id() == receiver_atom._parent_id) continue;
+
+            for (Atom const& sender_atom : sender._atoms)
+            {
+                float const dist = (receiver_atom.get_position() - sender_atom.get_position()).norm();
+
+                if (dist > 1e-4f && dist < max_distance)
+                {
+                    force_i += calc_pair_force(receiver_atom, sender_atom);
+                }
+            }
+        }
+
+        return force_i;
+    }
+
+    Eigen::Vector3f apply_forces_from_vector(Atom const& receiver_atom, std::vector<Atom const*> const& atoms) const override
+    {
+        Eigen::Vector3f force_i = Eigen::Vector3f::Zero();
+
+        for (Atom const* a : atoms)
+        {
+            force_i += calc_pair_force(receiver_atom, *a);
+        }
+
+        return force_i;
+    }
+
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const override
+    {
+        std::tuple<Forces...> const& all_forces = _forces;
+
+        accumulate_pair_forces(receivers, senders, forces,
+                               [&all_forces](float const distance, Atom_span_element const& a_0, Atom_span_element const& a_1)
+        {
+            return Force_magnitude_sum<sizeof...(Forces), std::tuple<Forces...> >::calc(all_forces, distance, a_0, a_1);
+        });
+    }
+
+private:
+    // same as Atomic_force::calc_force_between_atoms(), summed over all forces
+    Eigen::Vector3f calc_pair_force(Atom const& a_0, Atom const& a_1) const
+    {
+        Eigen::Vector3f const direction = a_0.get_position() - a_1.get_position();
+        float const norm = direction.norm();
+        float const distance = std::max(1e-5f, norm); // cap the distance at 1e-5 to avoid the singularity
+
+        float const magnitude = Force_magnitude_sum<sizeof...(Forces), std::tuple<Forces...> >::calc(_forces, distance, a_0, a_1);
+
+        return (norm > 0.0f) ? Eigen::Vector3f(direction * (magnitude / norm)) : Eigen::Vector3f::Zero();
+    }
+
+    std::tuple<Forces...> _forces;
+};
+
+
+// fallback for forces that aren't in the list of create_force_field(), dispatches virtually per force and pair
+// keeps a reference to the given forces, needs to be recreated whenever they change
+class Generic_force_field : public Force_field_base
+{
+public:
+    explicit Generic_force_field(std::vector< std::unique_ptr<Atomic_force> > const& forces) : _forces(forces)
+    { }
+
+    Eigen::Vector3f calc_force_between_atoms(Atom const& a_0, Atom const& a_1) const override;
+    Eigen::Vector3f apply_forces_brute_force(Atom const& receiver_atom, std::list<Molecule> const& molecules, float const max_distance) const override;
+    Eigen::Vector3f apply_forces_from_vector(Atom const& receiver_atom, std::vector<Atom const*> const& atoms) const override;
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces) const override;
+
+private:
+    std::vector< std::unique_ptr<Atomic_force> > const& _forces;
+};
+
+
+// picks the Force_field instantiation matching the enabled forces, the forces are copied with their current settings
+std::unique_ptr<Force_field_base> create_force_field(std::vector< std::unique_ptr<Atomic_force> > const& forces);
+
+#endif // FORCE_FIELD_H
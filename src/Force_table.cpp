@@ -0,0 +1,217 @@
+#include "Force_table.h"
+
+namespace
+{
+
+float catmull_rom(float const p_0, float const p_1, float const p_2, float const p_3, float const t)
+{
+    return p_1 + 0.5f * t * (p_2 - p_0 + t * (2.0f * p_0 - 5.0f * p_1 + 4.0f * p_2 - p_3 + t * (3.0f * (p_1 - p_2) + p_3 - p_0)));
+}
+
+}
+
+
+Force_table::Force_table() :
+    _num_samples(4096),
+    _min_distance_2(0.5f * 0.5f),
+    _max_distance_2(20.0f * 20.0f),
+    _coulomb_strength(-1.0f),
+    _vdw_strength(-1.0f),
+    _vdw_radius_factor(-1.0f)
+{
+    _sample_step = (_max_distance_2 - _min_distance_2) / float(_num_samples - 1);
+
+    for (int t = 0; t < Num_types; ++t)
+    {
+        _type_radii[t] = get_type_radius(Atom::Type(t));
+    }
+}
+
+
+float Force_table::get_type_radius(const Atom::Type type)
+{
+    Eigen::Vector3f const origin = Eigen::Vector3f::Zero();
+
+    switch (type)
+    {
+    case Atom::Type::Charge: return 0.0f;
+    case Atom::Type::H:      return Atom::create_hydrogen(origin)._radius;
+    case Atom::Type::O:      return Atom::create_oxygen(origin)._radius;
+    case Atom::Type::C:      return Atom::create_carbon(origin)._radius;
+    case Atom::Type::S:      return Atom::create_sulfur(origin)._radius;
+    case Atom::Type::N:      return Atom::create_nitrogen(origin)._radius;
+    case Atom::Type::Na:     return Atom::create_natrium(origin)._radius;
+    case Atom::Type::Cl:     return Atom::create_chlorine(origin)._radius;
+    }
+
+    assert(false);
+    return 0.0f;
+}
+
+
+float Force_table::calc_vdw_force_over_distance(const float distance, const float radius_0, const float radius_1) const
+{
+    // same as Lennard_jones_force::calc_force() and calc_van_der_waals_force() in force_calc.frag
+    float const sigma = _vdw_radius_factor * (radius_0 + radius_1);
+    float const sigma_distance = sigma / distance;
+    float const pow_6 = sigma_distance * sigma_distance * sigma_distance * sigma_distance * sigma_distance * sigma_distance;
+    return _vdw_strength * 4.0f * (pow_6 * pow_6 - pow_6) / distance;
+}
+
+
+Eigen::Vector2f Force_table::calc_analytic(const int type_0, const float radius_0, const int type_1, const float radius_1, const float distance_2) const
+{
+    bool const has_charge_type = (Atom::Type(type_0) == Atom::Type::Charge || Atom::Type(type_1) == Atom::Type::Charge);
+    float const distance = std::sqrt(distance_2);
+
+    return Eigen::Vector2f(has_charge_type ? 0.0f : calc_vdw_force_over_distance(distance, radius_0, radius_1),
+                           _coulomb_strength / (distance_2 * distance));
+}
+
+
+void Force_table::build(const float coulomb_strength, const float vdw_strength, const float vdw_radius_factor)
+{
+    _coulomb_strength = coulomb_strength;
+    _vdw_strength = vdw_strength;
+    _vdw_radius_factor = vdw_radius_factor;
+
+    _samples.resize(Num_types * Num_types * _num_samples * 2);
+
+    std::vector<float> coulomb_kernel(_num_samples);
+    std::vector<float> distances(_num_samples);
+
+    for (int i = 0; i < _num_samples; ++i)
+    {
+        float const distance_2 = _min_distance_2 + i * _sample_step;
+        distances[i] = std::sqrt(distance_2);
+        coulomb_kernel[i] = _coulomb_strength / (distance_2 * distances[i]);
+    }
+
+    for (int t_0 = 0; t_0 < Num_types; ++t_0)
+    {
+        for (int t_1 = t_0; t_1 < Num_types; ++t_1)
+        {
+            bool const has_charge_type = (Atom::Type(t_0) == Atom::Type::Charge || Atom::Type(t_1) == Atom::Type::Charge);
+
+            float const radius_0 = get_type_radius(Atom::Type(t_0));
+            float const radius_1 = get_type_radius(Atom::Type(t_1));
+
+            float * row   = _samples.data() + get_pair_index(Atom::Type(t_0), Atom::Type(t_1)) * _num_samples * 2;
+            float * row_t = _samples.data() + get_pair_index(Atom::Type(t_1), Atom::Type(t_0)) * _num_samples * 2;
+
+            for (int i = 0; i < _num_samples; ++i)
+            {
+                float const vdw = has_charge_type ? 0.0f : calc_vdw_force_over_distance(distances[i], radius_0, radius_1);
+
+                row[i * 2 + 0] = vdw;
+                row[i * 2 + 1] = coulomb_kernel[i];
+
+                row_t[i * 2 + 0] = vdw;
+                row_t[i * 2 + 1] = coulomb_kernel[i];
+            }
+        }
+    }
+}
+
+
+bool Force_table::needs_rebuild(const float coulomb_strength, const float vdw_strength, const float vdw_radius_factor) const
+{
+    return !is_valid() ||
+            coulomb_strength != _coulomb_strength ||
+            vdw_strength != _vdw_strength ||
+            vdw_radius_factor != _vdw_radius_factor;
+}
+
+
+Eigen::Vector2f Force_table::lookup(const int pair_index, const float distance_2, const Interpolation interpolation) const
+{
+    assert(is_valid());
+
+    float const * row = _samples.data() + pair_index * _num_samples * 2;
+
+    float const t = (std::max(distance_2, _min_distance_2) - _min_distance_2) / _sample_step;
+    int const i = std::min(int(t), _num_samples - 2);
+    float const f = std::min(t - float(i), 1.0f);
+
+    Eigen::Vector2f result;
+
+    if (interpolation == Interpolation::Cubic)
+    {
+        int const i_0 = std::max(i - 1, 0);
+        int const i_3 = std::min(i + 2, _num_samples - 1);
+
+        for (int c = 0; c < 2; ++c)
+        {
+            result[c] = catmull_rom(row[i_0 * 2 + c], row[i * 2 + c], row[(i + 1) * 2 + c], row[i_3 * 2 + c], f);
+        }
+    }
+    else
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            result[c] = (1.0f - f) * row[i * 2 + c] + f * row[(i + 1) * 2 + c];
+        }
+    }
+
+    return result;
+}
+
+
+Eigen::Vector3f Force_table::calc_force(const Atom &a_0, const Atom &a_1, const Interpolation interpolation) const
+{
+    Eigen::Vector3f const direction = a_0.get_position() - a_1.get_position();
+    float const distance_2 = direction.squaredNorm();
+
+    if (distance_2 >= _max_distance_2)
+    {
+        // outside of the table vdW is negligible, only the Coulomb tail remains
+        return direction * (_coulomb_strength * a_0._charge * a_1._charge / (distance_2 * std::sqrt(distance_2)));
+    }
+
+    Eigen::Vector2f const f = (has_table_radius(int(a_0._type), a_0._radius) && has_table_radius(int(a_1._type), a_1._radius)) ?
+                lookup(get_pair_index(a_0._type, a_1._type), distance_2, interpolation) :
+                calc_analytic(int(a_0._type), a_0._radius, int(a_1._type), a_1._radius, distance_2);
+
+    return direction * (f[0] + a_0._charge * a_1._charge * f[1]);
+}
+
+
+void Force_table::calc_forces(const Atom_span &receivers, const Atom_span &senders, const Force_span &forces, const Interpolation interpolation) const
+{
+    assert(receivers.size == forces.size);
+
+    for (int i = 0; i < receivers.size; ++i)
+    {
+        Eigen::Vector3f const p_0(receivers.x[i], receivers.y[i], receivers.z[i]);
+        Eigen::Vector3f force = Eigen::Vector3f::Zero();
+
+        bool const receiver_in_table = has_table_radius(receivers.type[i], receivers.radius[i]);
+
+        for (int j = 0; j < senders.size; ++j)
+        {
+            if (senders.parent_id[j] == receivers.parent_id[i]) continue;
+
+            Eigen::Vector3f const direction = p_0 - Eigen::Vector3f(senders.x[j], senders.y[j], senders.z[j]);
+            float const distance_2 = direction.squaredNorm();
+            float const charge_product = receivers.charge[i] * senders.charge[j];
+
+            if (distance_2 < 1e-6f) continue; // same cut-off as force_calc.frag
+
+            if (distance_2 >= _max_distance_2)
+            {
+                force += direction * (_coulomb_strength * charge_product / (distance_2 * std::sqrt(distance_2)));
+                continue;
+            }
+
+            Eigen::Vector2f const f = (receiver_in_table && has_table_radius(senders.type[j], senders.radius[j])) ?
+                        lookup(get_pair_index(Atom::Type(receivers.type[i]), Atom::Type(senders.type[j])), distance_2, interpolation) :
+                        calc_analytic(receivers.type[i], receivers.radius[i], senders.type[j], senders.radius[j], distance_2);
+
+            force += direction * (f[0] + charge_product * f[1]);
+        }
+
+        forces.x[i] += force[0];
+        forces.y[i] += force[1];
+        forces.z[i] += force[2];
+    }
+}
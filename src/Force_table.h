@@ -0,0 +1,83 @@
+#ifndef FORCE_TABLE_H
+#define FORCE_TABLE_H
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Atom.h"
+#include "Atom_soa.h"
+
+// Precomputed atom pair forces sampled over the squared distance for all combinations of Atom::Type.
+// A sample stores force / distance, so the force vector is sample * (p_0 - p_1) and no sqrt is needed.
+// Van der Waals (Lennard-Jones) only depends on the radii of the two types and gets one row per type pair.
+// The rows use the radius of each type's factory atom (Atom::create_oxygen() etc.), pairs with an atom whose
+// radius differs (dipoles, radii set in a level file) are computed analytically instead.
+// Coulomb depends on the per-atom charge (Na, Cl and the sulfate override the type default), so only
+// the strength / r^3 kernel is tabulated and multiplied with the charge product at lookup.
+class Force_table
+{
+public:
+    enum class Interpolation { Linear = 0, Cubic };
+
+    static int const Num_types = 8; // number of values in Atom::Type
+
+    Force_table();
+
+    void build(float const coulomb_strength, float const vdw_strength, float const vdw_radius_factor);
+
+    bool needs_rebuild(float const coulomb_strength, float const vdw_strength, float const vdw_radius_factor) const;
+
+    Eigen::Vector3f calc_force(Atom const& a_0, Atom const& a_1, Interpolation const interpolation = Interpolation::Linear) const;
+
+    // adds the forces of all senders on all receivers, same as calc_force() per pair, pairs of the same molecule are skipped
+    void calc_forces(Atom_span const& receivers, Atom_span const& senders, Force_span const& forces, Interpolation const interpolation = Interpolation::Linear) const;
+
+    // force / distance for a type pair and squared distance, x: vdW, y: Coulomb kernel (multiply with q_0 * q_1)
+    Eigen::Vector2f lookup(int const pair_index, float const distance_2, Interpolation const interpolation) const;
+
+    static int get_pair_index(Atom::Type const t_0, Atom::Type const t_1)
+    {
+        return int(t_0) * Num_types + int(t_1);
+    }
+
+    static float get_type_radius(Atom::Type const type);
+
+    // false for atoms the table rows don't match, their pairs are computed analytically
+    bool has_table_radius(int const type, float const radius) const
+    {
+        return Atom::Type(type) == Atom::Type::Charge || radius == _type_radii[type];
+    }
+
+    bool is_valid() const { return !_samples.empty(); }
+
+    int get_num_samples() const { return _num_samples; }
+    float get_min_distance_2() const { return _min_distance_2; }
+    float get_max_distance_2() const { return _max_distance_2; }
+    float get_coulomb_strength() const { return _coulomb_strength; }
+    float get_vdw_strength() const { return _vdw_strength; }
+
+    // row-major, one row per type pair, two floats (vdW, Coulomb) per sample, ready for a GL_RG32F texture
+    std::vector<float> const& get_samples() const { return _samples; }
+
+private:
+    float calc_vdw_force_over_distance(float const distance, float const radius_0, float const radius_1) const;
+
+    // force / distance like lookup(), computed from the atoms' radii
+    Eigen::Vector2f calc_analytic(int const type_0, float const radius_0, int const type_1, float const radius_1, float const distance_2) const;
+
+    int _num_samples;
+    float _min_distance_2;
+    float _max_distance_2;
+    float _sample_step;
+
+    float _coulomb_strength;
+    float _vdw_strength;
+    float _vdw_radius_factor;
+
+    std::vector<float> _samples;
+
+    float _type_radii[Num_types];
+};
+
+#endif // FORCE_TABLE_H
@@ -1,26 +1,177 @@
 #include "Frame_buffer.h"
 
 #include "Color_utilities.h"
+#include "Message_logger.h"
 
-QImage convert_with_alpha(const Frame_buffer<Color4> &frame_buffer)
+namespace
 {
-    QImage image(frame_buffer.get_width(), frame_buffer.get_height(), QImage::Format_ARGB32);
-    QImage alpha = image.alphaChannel();
 
-    int const height = frame_buffer.get_height();
+float const Byte_to_float = 1.0f / 255.0f;
+
+inline unsigned int float_to_byte(float const value)
+{
+    return (unsigned int)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// the bytes of a QRgb, 0: red, 1: green, 2: blue, 3: alpha
+inline float get_channel(QRgb const pixel, int const channel)
+{
+    int const shift[4] = { 16, 8, 0, 24 };
+    return float((pixel >> shift[channel]) & 0xff) * Byte_to_float;
+}
+
+}
+
+
+QImage get_qrgb_image(const QImage &image)
+{
+    QImage::Format const format = image.format();
+
+    // premultiplied scanlines differ from QImage::pixel() wherever alpha < 255, they are converted like the rest
+    if (format == QImage::Format_RGB32 || format == QImage::Format_ARGB32)
+    {
+        return image;
+    }
+
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+Frame_buffer<Color> convert_to_color(const QImage &qimage)
+{
+    if (qimage.isNull())
+    {
+        LOG_WARNING("Could not convert image, image is empty.");
+        return Frame_buffer<Color>();
+    }
+
+    QImage const image = get_qrgb_image(qimage);
+
+    int const width = image.width();
+    int const height = image.height();
+
+    Frame_buffer<Color> frame_buffer(width, height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        Color * row = frame_buffer.get_row(y);
+        QRgb const* line = reinterpret_cast<QRgb const*>(image.constScanLine(height - y - 1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            QRgb const pixel = line[x];
+
+            row[x].R = float((pixel >> 16) & 0xff) * Byte_to_float;
+            row[x].G = float((pixel >> 8) & 0xff) * Byte_to_float;
+            row[x].B = float(pixel & 0xff) * Byte_to_float;
+        }
+    }
+
+    return frame_buffer;
+}
+
+Frame_buffer<Color4> convert_to_color4(const QImage &qimage)
+{
+    if (qimage.isNull())
+    {
+        LOG_WARNING("Could not convert image, image is empty.");
+        return Frame_buffer<Color4>();
+    }
+
+    QImage const image = get_qrgb_image(qimage);
 
-    for (int serial_index = 0; serial_index < frame_buffer.get_size(); ++serial_index)
+    int const width = image.width();
+    int const height = image.height();
+
+    Frame_buffer<Color4> frame_buffer(width, height);
+
+    for (int y = 0; y < height; ++y)
     {
-        QColor color = convert<QColor>(frame_buffer.get_data(serial_index));
+        Color4 * row = frame_buffer.get_row(y);
+        QRgb const* line = reinterpret_cast<QRgb const*>(image.constScanLine(height - y - 1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            QRgb const pixel = line[x];
+
+            row[x].r = float((pixel >> 16) & 0xff) * Byte_to_float;
+            row[x].g = float((pixel >> 8) & 0xff) * Byte_to_float;
+            row[x].b = float(pixel & 0xff) * Byte_to_float;
+            row[x].a = float(pixel >> 24) * Byte_to_float;
+        }
+    }
 
-        int x, y;
-        frame_buffer.get_coordinates(serial_index, x, y);
+    return frame_buffer;
+}
+
+Frame_buffer<float> convert_to_channel(const QImage &qimage, const int channel)
+{
+    assert(channel >= 0 && channel < 4);
 
-        image.setPixel(x, height - y - 1, color.rgb());
-        alpha.setPixel(x, height - y - 1, color.alpha());
+    if (qimage.isNull())
+    {
+        LOG_WARNING("Could not convert image, image is empty.");
+        return Frame_buffer<float>();
     }
 
-    image.setAlphaChannel(alpha);
+    QImage const image = get_qrgb_image(qimage);
+
+    int const width = image.width();
+    int const height = image.height();
+
+    Frame_buffer<float> frame_buffer(width, height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        float * row = frame_buffer.get_row(y);
+        QRgb const* line = reinterpret_cast<QRgb const*>(image.constScanLine(height - y - 1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            row[x] = get_channel(line[x], channel);
+        }
+    }
+
+    return frame_buffer;
+}
+
+QImage convert_to_image(const Frame_buffer<Color> &frame_buffer)
+{
+    int const width = frame_buffer.get_width();
+    int const height = frame_buffer.get_height();
+
+    QImage image(width, height, QImage::Format_RGB32);
+
+    for (int y = 0; y < height; ++y)
+    {
+        Color const* row = frame_buffer.get_row(y);
+        QRgb * line = reinterpret_cast<QRgb*>(image.scanLine(height - y - 1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            line[x] = qRgb(float_to_byte(row[x].R), float_to_byte(row[x].G), float_to_byte(row[x].B));
+        }
+    }
+
+    return image;
+}
+
+QImage convert_with_alpha(const Frame_buffer<Color4> &frame_buffer)
+{
+    int const width = frame_buffer.get_width();
+    int const height = frame_buffer.get_height();
+
+    QImage image(width, height, QImage::Format_ARGB32);
+
+    for (int y = 0; y < height; ++y)
+    {
+        Color4 const* row = frame_buffer.get_row(y);
+        QRgb * line = reinterpret_cast<QRgb*>(image.scanLine(height - y - 1));
+
+        for (int x = 0; x < width; ++x)
+        {
+            line[x] = qRgba(float_to_byte(row[x].r), float_to_byte(row[x].g), float_to_byte(row[x].b), float_to_byte(row[x].a));
+        }
+    }
 
     return image;
 }
@@ -4,8 +4,11 @@
 #include <QImage>
 #include <QColor>
 #include <cassert>
+#include <algorithm>
+#include <vector>
 
 #include "Color_utilities.h"
+#include "Message_logger.h"
 
 template <class Data>
 class Frame_buffer
@@ -25,48 +28,47 @@ public:
 
     Frame_buffer(int const width, int const height, Data const& initial_data) : Frame_buffer(width, height)
     {
-        set_size(width, height);
-        std::fill(_data.begin(), _data.end(), initial_data);
+        fill(initial_data);
     }
 
-    virtual ~Frame_buffer() {}
-
-    virtual void set_data(int const serial_index, Data const& data)
+    // Not virtual, so the per pixel accessors are inlined. Loops over whole rows should use get_row(), which
+    // skips the index calculation and the assert per pixel.
+    void set_data(int const serial_index, Data const& data)
     {
         assert(serial_index < _size);
 
         _data[serial_index] = data;
     }
 
-    virtual void set_data(int const x, int const y, Data const& data)
+    void set_data(int const x, int const y, Data const& data)
     {
         int const pixel = get_coordinate(x, y);
 
         set_data(pixel, data);
     }
 
-    virtual Data const& get_data(int const x, int const y) const
+    Data const& get_data(int const x, int const y) const
     {
         int const pixel = get_coordinate(x, y);
 
         return get_data(pixel);
     }
 
-    virtual Data const& get_data(int const serial) const
+    Data const& get_data(int const serial) const
     {
         assert(serial < _size);
 
         return _data[serial];
     }
 
-    virtual Data & get_data(int const x, int const y)
+    Data & get_data(int const x, int const y)
     {
         int const pixel = get_coordinate(x, y);
 
         return get_data(pixel);
     }
 
-    virtual Data & get_data(int const serial)
+    Data & get_data(int const serial)
     {
         assert(serial < _size);
 
@@ -114,12 +116,36 @@ public:
         _height = height;
         _size = _width * _height;
 
-        _data = data;
+        _data = std::move(data);
+
+        assert(_size == int(_data.size()));
+    }
+
+    // the get_width() values of row y
+    Data * get_row(int const y)
+    {
+        return _data.data() + _width * y;
+    }
+
+    Data const* get_row(int const y) const
+    {
+        return _data.data() + _width * y;
+    }
+
+    void fill(Data const& data)
+    {
+        std::fill(_data.begin(), _data.end(), data);
+    }
+
+    // count values to the pixels starting at serial_index
+    void copy(Data const* data, int const serial_index, int const count)
+    {
+        assert(serial_index >= 0 && serial_index + count <= _size);
 
-        assert(_size == _data.size());
+        std::copy(data, data + count, _data.begin() + serial_index);
     }
 
-    virtual void set_size(int const width, int const height)
+    void set_size(int const width, int const height)
     {
         _width = width;
         _height = height;
@@ -128,7 +154,7 @@ public:
         clear();
     }
 
-    virtual void clear()
+    void clear()
     {
         _data.clear();
         _data.resize(_size);
@@ -175,9 +201,24 @@ protected:
 };
 
 
+// Bulk conversions between images and frame buffers, row by row on the 32 bit pixels of the image without QColor,
+// the inner loops are simple enough for the compiler to vectorise. Row 0 of a frame buffer is the bottom row
+// of the image, like in the generic convert() functions below.
+Frame_buffer<Color> convert_to_color(QImage const& image);
+Frame_buffer<Color4> convert_to_color4(QImage const& image);
+// one channel (0: red, 1: green, 2: blue, 3: alpha) in 0..1
+Frame_buffer<float> convert_to_channel(QImage const& image, int const channel);
+
+QImage convert_to_image(Frame_buffer<Color> const& frame_buffer);
 QImage convert_with_alpha(Frame_buffer<Color4> const& frame_buffer);
 
+// the image itself if it is RGB32 or ARGB32, the only formats whose scanlines hold the QRgb values QImage::pixel()
+// returns, otherwise an ARGB32 copy (also for ARGB32_Premultiplied)
+QImage get_qrgb_image(QImage const& image);
+
 
+// Any pixel type with a converter, QColor converters are called with the QRgb of the pixel like QImage::pixel()
+// would return it. The bulk conversions above are faster for the common types.
 template <typename Converter, typename Data>
 QImage convert(Frame_buffer<Data> const& frame_buffer)
 {
@@ -187,14 +228,15 @@ QImage convert(Frame_buffer<Data> const& frame_buffer)
 
     int const height = frame_buffer.get_height();
 
-    for (int serial_index = 0; serial_index < frame_buffer.get_size(); ++serial_index)
+    for (int y = 0; y < height; ++y)
     {
-        QColor color = converter(frame_buffer.get_data(serial_index));
-
-        int x, y;
-        frame_buffer.get_coordinates(serial_index, x, y);
+        Data const* row = frame_buffer.get_row(y);
+        QRgb * line = reinterpret_cast<QRgb*>(image.scanLine(height - y - 1));
 
-        image.setPixel(x, height - y - 1, color.rgb());
+        for (int x = 0; x < frame_buffer.get_width(); ++x)
+        {
+            line[x] = QColor(converter(row[x])).rgb();
+        }
     }
 
     return image;
@@ -205,24 +247,27 @@ Frame_buffer<Data> convert(QImage const& qimage)
 {
     if (qimage.isNull())
     {
-        std::cout << __FUNCTION__ << " Could not convert image, image is empty." << std::endl;
+        LOG_WARNING("Could not convert image, image is empty.");
         return Frame_buffer<Data>();
     }
 
-    Frame_buffer<Data> frame_buffer(qimage.width(), qimage.height());
+    QImage const image = get_qrgb_image(qimage);
+
+    Frame_buffer<Data> frame_buffer(image.width(), image.height());
 
     Converter converter;
 
-    int const height = qimage.height();
+    int const height = image.height();
 
-    for (int serial_index = 0; serial_index < frame_buffer.get_size(); ++serial_index)
+    for (int y = 0; y < height; ++y)
     {
-        int x, y;
-        frame_buffer.get_coordinates(serial_index, x, y);
-
-        Data data = converter(qimage.pixel(x, height - y - 1));
+        Data * row = frame_buffer.get_row(y);
+        QRgb const* line = reinterpret_cast<QRgb const*>(image.constScanLine(height - y - 1));
 
-        frame_buffer.set_data(serial_index, data);
+        for (int x = 0; x < frame_buffer.get_width(); ++x)
+        {
+            row[x] = converter(line[x]);
+        }
     }
 
     return frame_buffer;
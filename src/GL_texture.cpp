@@ -1,5 +1,7 @@
 #include "GL_texture.h"
 
+#include "Memory_accounting.h"
+
 GL_texture::GL_texture() : _context(nullptr), _id(0)
 { }
 
@@ -8,6 +10,7 @@ GL_texture::GL_texture(QGLContext * context, GLuint const id) : _context(context
 
 GL_texture::~GL_texture()
 {
+    Memory_accounting::get_instance()->remove_texture(_id);
     _context->deleteTexture(_id);
 }
 
@@ -18,6 +21,7 @@ void GL_texture::set_context(QGLContext * context)
 
 GL_texture & GL_texture::operator=(GL_texture const& other)
 {
+    Memory_accounting::get_instance()->remove_texture(_id);
     _context->deleteTexture(_id);
 
     _context = other._context;
@@ -28,6 +32,7 @@ GL_texture & GL_texture::operator=(GL_texture const& other)
 
 void GL_texture::reset(GLuint const id)
 {
+    Memory_accounting::get_instance()->remove_texture(_id);
     _context->deleteTexture(_id);
 
     _id = id;
@@ -3,12 +3,14 @@
 #include <iostream>
 #include <cassert>
 #include <QtDebug>
+#include <QFile>
 
 #ifdef WIN32
 #include <Windows.h>
 #endif
 
 #include "Utilities.h"
+#include "Message_logger.h"
 
 void check_gl_error()
 {
@@ -16,36 +18,94 @@ void check_gl_error()
 
     if (error != GL_NO_ERROR)
     {
-        std::cout << "check_gl_error(): Error: " << error << std::endl;
+        LOG_WARNING("check_gl_error(): Error: " << error);
         assert(false);
     }
 }
 
 
+long long get_texture_memory_size(const int width, const int height, const GLint internal_format, const bool with_mipmaps)
+{
+    int bytes_per_texel = 4; // 8 bit RGB(A), depth and the legacy formats, RGB is padded
+
+    switch (internal_format)
+    {
+    case GL_RGBA32F: bytes_per_texel = 16; break;
+    case GL_RGB32F: bytes_per_texel = 12; break;
+    case GL_RG32F: bytes_per_texel = 8; break;
+    case GL_RGBA16F: bytes_per_texel = 8; break;
+    case GL_R32F:
+    case GL_R32I: bytes_per_texel = 4; break;
+    default: break;
+    }
+
+    long long const bytes = (long long)(width) * (long long)(height) * bytes_per_texel;
+
+    return with_mipmaps ? bytes * 4 / 3 : bytes;
+}
+
+
+namespace
+{
+
+Shader_source_reader & get_shader_source_reader()
+{
+    static Shader_source_reader reader;
+
+    return reader;
+}
+
+QByteArray read_shader_source(QString const& file_name)
+{
+    if (get_shader_source_reader())
+    {
+        return get_shader_source_reader()(file_name);
+    }
+
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LOG_WARNING("Couldn't read shader " << file_name.toStdString());
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+}
+
+
+void set_shader_source_reader(const Shader_source_reader &reader)
+{
+    get_shader_source_reader() = reader;
+}
+
+
 QGLShaderProgram * init_program(QGLContext const* context, QString const& vertex_file, QString const& frag_file)
 {
-    std::cout << "Loading shader: " << vertex_file.toStdString() << " " << frag_file.toStdString() << std::endl;
+    LOG_INFO("Loading shader: " << vertex_file.toStdString() << " " << frag_file.toStdString());
 
     QString log;
 
     QGLShaderProgram * program = new QGLShaderProgram(context);
 
-    program->addShaderFromSourceFile(QGLShader::Vertex, vertex_file);
+    program->addShaderFromSourceCode(QGLShader::Vertex, read_shader_source(vertex_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << "init_program: " << vertex_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING("init_program: " << vertex_file.toStdString() << " log: " << log.toStdString());
     }
 
-    program->addShaderFromSourceFile(QGLShader::Fragment, frag_file);
+    program->addShaderFromSourceCode(QGLShader::Fragment, read_shader_source(frag_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << "init_program: " << frag_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING("init_program: " << frag_file.toStdString() << " log: " << log.toStdString());
     }
 
     program->link();
@@ -54,7 +114,7 @@ QGLShaderProgram * init_program(QGLContext const* context, QString const& vertex
 
     if (!log.isEmpty())
     {
-        std::cout << "init_program link: " << log.toStdString();
+        LOG_WARNING("init_program link: " << log.toStdString());
     }
 
     return program;
@@ -63,29 +123,29 @@ QGLShaderProgram * init_program(QGLContext const* context, QString const& vertex
 
 QOpenGLShaderProgram * init_program(QString const& vertex_file, QString const& frag_file)
 {
-    std::cout << "Loading shader (V, F): " << vertex_file.toStdString() << " " << frag_file.toStdString() << std::endl;
+    LOG_INFO("Loading shader (V, F): " << vertex_file.toStdString() << " " << frag_file.toStdString());
 
     QString log;
 
     QOpenGLShaderProgram * program = new QOpenGLShaderProgram();
 
-    program->addShaderFromSourceFile(QOpenGLShader::Vertex, vertex_file);
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, read_shader_source(vertex_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " " << vertex_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING(vertex_file.toStdString() << " log: " << log.toStdString());
         qCritical() << "Vertex shader log: " << vertex_file << "\nlog: " << log;
     }
 
-    program->addShaderFromSourceFile(QOpenGLShader::Fragment, frag_file);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, read_shader_source(frag_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " " << frag_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING(frag_file.toStdString() << " log: " << log.toStdString());
         qCritical() << "Fragment shader log: " << frag_file << "\nlog: " << log;
     }
 
@@ -95,7 +155,7 @@ QOpenGLShaderProgram * init_program(QString const& vertex_file, QString const& f
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " link: " << log.toStdString();
+        LOG_WARNING("link: " << log.toStdString());
         qCritical() << "Linking log: " << vertex_file << " "  << frag_file << " log: " << log;
     }
 
@@ -105,39 +165,39 @@ QOpenGLShaderProgram * init_program(QString const& vertex_file, QString const& f
 
 QOpenGLShaderProgram *init_program(const QString &vertex_file, const QString &frag_file, const QString &geometry_file)
 {
-    std::cout << "Loading shader (V, F, G): " << vertex_file.toStdString() << " " << frag_file.toStdString() << std::endl;
+    LOG_INFO("Loading shader (V, F, G): " << vertex_file.toStdString() << " " << frag_file.toStdString());
 
     QString log;
 
     QOpenGLShaderProgram * program = new QOpenGLShaderProgram();
 
-    program->addShaderFromSourceFile(QOpenGLShader::Vertex, vertex_file);
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, read_shader_source(vertex_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " " << vertex_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING(vertex_file.toStdString() << " log: " << log.toStdString());
         qCritical() << "Vertex shader log: " << vertex_file << "\nlog: " << log;
     }
 
-    program->addShaderFromSourceFile(QOpenGLShader::Fragment, frag_file);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, read_shader_source(frag_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " " << frag_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING(frag_file.toStdString() << " log: " << log.toStdString());
         qCritical() << "Fragment shader log: " << frag_file << "\nlog: " << log;
     }
 
-    program->addShaderFromSourceFile(QOpenGLShader::Geometry, geometry_file);
+    program->addShaderFromSourceCode(QOpenGLShader::Geometry, read_shader_source(geometry_file));
 
     log = program->log();
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " " << geometry_file.toStdString() << " log: " << log.toStdString();
+        LOG_WARNING(geometry_file.toStdString() << " log: " << log.toStdString());
         qCritical() << "Geometry shader log: " << frag_file << "\nlog: " << log;
     }
 
@@ -147,7 +207,7 @@ QOpenGLShaderProgram *init_program(const QString &vertex_file, const QString &fr
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " link: " << log.toStdString();
+        LOG_WARNING("link: " << log.toStdString());
         qCritical() << "Linking log: " << vertex_file << " "  << frag_file << " log: " << log;
     }
 
@@ -167,7 +227,7 @@ QOpenGLShaderProgram * init_program_from_code(QString const& vertex_code, QStrin
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " Vertex shader log: " << log.toStdString();
+        LOG_WARNING("Vertex shader log: " << log.toStdString());
         qCritical() << "Vertex shader log: " << log;
     }
 
@@ -177,7 +237,7 @@ QOpenGLShaderProgram * init_program_from_code(QString const& vertex_code, QStrin
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " Fragment shader log: " << log.toStdString();
+        LOG_WARNING("Fragment shader log: " << log.toStdString());
         qCritical() << "Fragment shader log: " << log;
     }
 
@@ -187,7 +247,7 @@ QOpenGLShaderProgram * init_program_from_code(QString const& vertex_code, QStrin
 
     if (!log.isEmpty())
     {
-        std::cout << __func__ << " link: " << log.toStdString();
+        LOG_WARNING("link: " << log.toStdString());
         qCritical() << "Linking log: " << log;
     }
 
@@ -269,7 +329,7 @@ void GL_mesh2::init(MyMesh const& mesh, bool const store_mesh)
         ++num_faces;
     }
 
-    std::cout << __func__ << " num_faces: " << num_faces << " " << indices.size() << std::endl;
+    LOG_DEBUG("num_faces: " << num_faces << " " << indices.size());
 
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
     glBindVertexArray(0);
@@ -390,6 +450,8 @@ GLuint GL_functions::create_texture(Frame_buffer<Color4> const& frame, bool cons
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    Memory_accounting::get_instance()->add_texture(texture_index, get_texture_memory_size(frame.get_width(), frame.get_height(), internal_format, use_mipmaps));
+
     return texture_index;
 }
 
@@ -434,6 +496,8 @@ GLuint GL_functions::create_texture(Frame_buffer<Color> const& frame, bool const
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    Memory_accounting::get_instance()->add_texture(texture_index, get_texture_memory_size(frame.get_width(), frame.get_height(), internal_format, use_mipmaps));
+
     return texture_index;
 }
 
@@ -443,12 +507,12 @@ GLuint GL_functions::create_texture(QString const& filename, bool const with_alp
 
     if (with_alpha)
     {
-        Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(image);
+        Frame_buffer<Color4> texture_fb = convert_to_color4(image);
         return create_texture(texture_fb);
     }
     else
     {
-        Frame_buffer<Color> texture_fb = convert<QColor_to_Color_converter, Color>(image);
+        Frame_buffer<Color> texture_fb = convert_to_color(image);
         return create_texture(texture_fb);
     }
 }
@@ -503,5 +567,6 @@ GLuint GL_functions::create_texture(QString const& filename, bool const with_alp
 
 void GL_functions::delete_texture(GLuint const id)
 {
+    Memory_accounting::get_instance()->remove_texture(id);
     glDeleteTextures(1, &id);
 }
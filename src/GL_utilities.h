@@ -10,6 +10,7 @@
 #include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
 
+#include <functional>
 #include <memory>
 
 #ifndef Q_MOC_RUN
@@ -18,10 +19,18 @@
 
 #include "MyOpenMesh.h"
 #include "Color.h"
+#include "Memory_accounting.h"
 #include "Frame_buffer.h"
 
 void check_gl_error();
 
+// estimated size in bytes of a 2D texture, for the memory accounting
+long long get_texture_memory_size(int const width, int const height, GLint const internal_format, bool const with_mipmaps = false);
+
+// Where init_program() gets the shader sources from (the Asset_preloader sets one), without it the files are read directly
+typedef std::function<QByteArray(QString const& file_name)> Shader_source_reader;
+void set_shader_source_reader(Shader_source_reader const& reader);
+
 QGLShaderProgram * init_program(QGLContext const* context, QString const& vertex_file, QString const& frag_file);
 QOpenGLShaderProgram * init_program(QString const& vertex_file, QString const& frag_file);
 QOpenGLShaderProgram * init_program(QString const& vertex_file, QString const& frag_file, QString const& geometry_file);
@@ -238,6 +247,8 @@ public:
 
         glBindTexture(GL_TEXTURE_2D, 0);
 
+        Memory_accounting::get_instance()->add_texture(texture_index, get_texture_memory_size(width, height, internal_format));
+
         return texture_index;
     }
 
@@ -264,6 +275,8 @@ public:
 
         glBindTexture(GL_TEXTURE_1D, 0);
 
+        Memory_accounting::get_instance()->add_texture(texture_index, get_texture_memory_size(width, 1, internal_format));
+
         return texture_index;
     }
 
@@ -70,7 +70,15 @@ GLuint create_three_channel_float_texture(int const size)
 }
 
 
-GPU_force::GPU_force(int const temperature_grid_size)
+GPU_force::GPU_force(int const temperature_grid_size) :
+    _force_table_tex(0),
+    _use_force_table(false),
+    _force_table(nullptr),
+    _force_table_num_samples(0),
+    _force_table_coulomb_strength(0.0f),
+    _force_table_vdw_strength(0.0f),
+    _temperature_grid_size(temperature_grid_size),
+    _memory(Memory_subsystem::Gpu_force)
 {
     initializeOpenGLFunctions();
 
@@ -87,6 +95,7 @@ GPU_force::GPU_force(int const temperature_grid_size)
     _charge_frame = Frame_buffer<float>(_size, _size);
     _radius_frame = Frame_buffer<float>(_size, _size);
     _parent_id_frame = Frame_buffer<float>(_size, _size);
+    _type_frame = Frame_buffer<float>(_size, _size);
 
     _fbo_tex = create_three_channel_float_texture(_size);
     _position_tex = create_three_channel_float_texture(_size);
@@ -95,6 +104,7 @@ GPU_force::GPU_force(int const temperature_grid_size)
 //    _parent_id_tex = create_single_channel_int_texture(_size);
     _parent_id_tex = create_single_channel_float_texture(_size);
     _temperature_tex = create_single_channel_float_texture(temperature_grid_size, GL_LINEAR);
+    _type_tex = create_single_channel_float_texture(_size);
 
     _shader = std::unique_ptr<QOpenGLShaderProgram>(init_program(Data_config::get_instance()->get_absolute_qfilename("shaders/force_calc.vert"), Data_config::get_instance()->get_absolute_qfilename("shaders/force_calc.frag")));
 
@@ -102,6 +112,8 @@ GPU_force::GPU_force(int const temperature_grid_size)
     _resulting_forces.resize(_size * _size);
 
     init_vertex_data();
+
+    update_memory_usage();
 }
 
 void GPU_force::init_vertex_data()
@@ -122,6 +134,7 @@ void GPU_force::init_vertex_data()
 
 std::vector<Eigen::Vector3f> const& GPU_force::calc_forces(std::list<Molecule> const& molecules,
                                                            const float coulomb_factor, const float vdw_factor, const float vdw_radius,
+                                                           const float wendland_strength, const float wendland_radius,
                                                            const float time, QVector2D const& bounding_box_size)
 {
     glDisable(GL_BLEND);
@@ -130,21 +143,31 @@ std::vector<Eigen::Vector3f> const& GPU_force::calc_forces(std::list<Molecule> c
 
     int num_atoms = 0;
 
+    Eigen::Vector3f * positions = _position_frame.get_raw_data();
+    float * charges = _charge_frame.get_raw_data();
+    float * radii = _radius_frame.get_raw_data();
+    float * parent_ids = _parent_id_frame.get_raw_data();
+    float * types = _type_frame.get_raw_data();
+
     for (Molecule const& sender : molecules)
     {
+        float const parent_id = float(sender.get_id());
+
         for (Atom const& sender_atom : sender._atoms)
         {
-            _position_frame.set_data(num_atoms, sender_atom.get_position());
-            _charge_frame.set_data(num_atoms, sender_atom._charge);
-            _radius_frame.set_data(num_atoms, sender_atom._radius);
-            _parent_id_frame.set_data(num_atoms, sender.get_id());
+            assert(num_atoms < _max_num_atoms);
+
+            positions[num_atoms] = sender_atom.get_position();
+            charges[num_atoms] = sender_atom._charge;
+            radii[num_atoms] = sender_atom._radius;
+            parent_ids[num_atoms] = parent_id;
+            // -1: the radius doesn't match the table rows, the shader computes its pairs analytically
+            types[num_atoms] = (_force_table && !_force_table->has_table_radius(int(sender_atom._type), sender_atom._radius)) ? -1.0f : float(sender_atom._type);
 
             ++num_atoms;
         }
     }
 
-    assert(num_atoms < _max_num_atoms);
-
 
     int const needed_height = (num_atoms / _size) + 1;
 //    int const needed_height = _size;
@@ -161,6 +184,12 @@ std::vector<Eigen::Vector3f> const& GPU_force::calc_forces(std::list<Molecule> c
     glBindTexture(GL_TEXTURE_2D, _parent_id_tex);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _size, needed_height, GL_RED, GL_FLOAT, _parent_id_frame.get_raw_data());
 
+    if (_use_force_table)
+    {
+        glBindTexture(GL_TEXTURE_2D, _type_tex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _size, needed_height, GL_RED, GL_FLOAT, _type_frame.get_raw_data());
+    }
+
     glBindTexture(GL_TEXTURE_2D, 0);
 
     glPushAttrib(GL_COLOR_BUFFER_BIT);
@@ -188,6 +217,15 @@ std::vector<Eigen::Vector3f> const& GPU_force::calc_forces(std::list<Molecule> c
     _shader->setUniformValue("coulomb_factor", coulomb_factor);
     _shader->setUniformValue("vdw_factor", vdw_factor);
     _shader->setUniformValue("vdw_radius_factor", vdw_radius);
+    _shader->setUniformValue("wendland_strength", wendland_strength);
+    _shader->setUniformValue("wendland_radius", wendland_radius);
+
+    _shader->setUniformValue("use_force_table", _use_force_table);
+    _shader->setUniformValue("force_table_num_samples", _force_table_num_samples);
+    _shader->setUniformValue("force_table_num_types", Force_table::Num_types);
+    _shader->setUniformValue("force_table_range", _force_table_range);
+    _shader->setUniformValue("force_table_coulomb_strength", _force_table_coulomb_strength);
+    _shader->setUniformValue("force_table_vdw_strength", _force_table_vdw_strength);
 
 
     glBindBuffer(GL_ARRAY_BUFFER, _buffer_square_positions);
@@ -214,6 +252,17 @@ std::vector<Eigen::Vector3f> const& GPU_force::calc_forces(std::list<Molecule> c
     glBindTexture(GL_TEXTURE_2D, _temperature_tex);
     _shader->setUniformValue("temperature_tex", 4);
 
+    if (_use_force_table)
+    {
+        glActiveTexture(GL_TEXTURE5);
+        glBindTexture(GL_TEXTURE_2D, _type_tex);
+        _shader->setUniformValue("type_tex", 5);
+
+        glActiveTexture(GL_TEXTURE6);
+        glBindTexture(GL_TEXTURE_2D, _force_table_tex);
+        _shader->setUniformValue("force_table_tex", 6);
+    }
+
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
     _shader->release();
@@ -239,6 +288,66 @@ void GPU_force::update_temperature_tex(Frame_buffer<float> const& temperature_gr
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void GPU_force::update_force_table(Force_table const* force_table)
+{
+    if (!force_table || !force_table->is_valid())
+    {
+        _use_force_table = false;
+        _force_table = nullptr;
+        return;
+    }
+
+    int const num_rows = Force_table::Num_types * Force_table::Num_types;
+
+    if (_force_table_tex == 0 || _force_table_num_samples != force_table->get_num_samples())
+    {
+        if (_force_table_tex != 0)
+        {
+            glDeleteTextures(1, &_force_table_tex);
+        }
+
+        glGenTextures(1, &_force_table_tex);
+        glBindTexture(GL_TEXTURE_2D, _force_table_tex);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, force_table->get_num_samples(), num_rows, 0, GL_RG, GL_FLOAT, nullptr);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        // linear along the distance axis is the table's interpolation, rows are sampled at their centers
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _force_table_tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, force_table->get_num_samples(), num_rows, GL_RG, GL_FLOAT, force_table->get_samples().data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _force_table_num_samples = force_table->get_num_samples();
+    _force_table_range = QVector2D(force_table->get_min_distance_2(), force_table->get_max_distance_2());
+    _force_table_coulomb_strength = force_table->get_coulomb_strength();
+    _force_table_vdw_strength = force_table->get_vdw_strength();
+    _use_force_table = true;
+    _force_table = force_table;
+
+    update_memory_usage();
+}
+
+void GPU_force::update_memory_usage()
+{
+    size_t const num_texels = size_t(_size) * size_t(_size);
+
+    // textures: FBO (RGBA8), result and positions (RGB32F), charge, radius, parent id and type (R32F), temperature grid (R32F), force table (RG32F)
+    size_t const texture_bytes = num_texels * (4 + 2 * 12 + 4 * 4)
+            + size_t(_temperature_grid_size) * size_t(_temperature_grid_size) * 4
+            + size_t(_force_table_num_samples) * Force_table::Num_types * Force_table::Num_types * 8;
+
+    // upload and readback frames on the CPU side
+    size_t const frame_bytes = num_texels * (3 * sizeof(Eigen::Vector3f) + 4 * sizeof(float));
+
+    _memory.set(texture_bytes + frame_bytes);
+}
+
 int GPU_force::get_max_num_atoms() const
 {
     return _max_num_atoms - 30; // add a safety buffer, hacky ...
@@ -12,6 +12,7 @@
 #include "Draw_functions.h"
 #include "Atom.h"
 #include "Data_config.h"
+#include "Force_table.h"
 
 // force calc using shader, each pixel == 1 atom
 // textures with:
@@ -37,13 +38,20 @@ public:
 
     std::vector<Eigen::Vector3f> const& calc_forces(std::list<Molecule> const& molecules,
                                                     float const coulomb_factor, float const vdw_factor, float const vdw_radius,
+                                                    float const wendland_strength, float const wendland_radius,
                                                     float const time, QVector2D const& bounding_box_size);
 
     void update_temperature_tex(Frame_buffer<float> const& temperature_grid);
 
+    // uploads the table and uses it instead of the analytic forces, nullptr switches back to the analytic path
+    void update_force_table(Force_table const* force_table);
+    bool is_using_force_table() const { return _use_force_table; }
+
     int get_max_num_atoms() const;
 
 private:
+    void update_memory_usage();
+
     Frame_buffer<Eigen::Vector3f> _result_fb;
     std::vector<Eigen::Vector3f> _resulting_forces;
 
@@ -57,16 +65,29 @@ private:
     Frame_buffer<float> _charge_frame;
     Frame_buffer<float> _radius_frame;
     Frame_buffer<float> _parent_id_frame;
+    Frame_buffer<float> _type_frame;
 
     GLuint _position_tex;
     GLuint _charge_tex;
     GLuint _radius_tex;
     GLuint _parent_id_tex;
     GLuint _temperature_tex;
+    GLuint _type_tex;
+    GLuint _force_table_tex;
     GLuint _fbo_tex;
 
+    bool _use_force_table;
+    Force_table const* _force_table; // owned by Core, for Force_table::has_table_radius()
+    int _force_table_num_samples;
+    float _force_table_coulomb_strength;
+    float _force_table_vdw_strength;
+    QVector2D _force_table_range;
+
     GLuint _buffer_square_positions;
 //    GLuint _buffer_square_tex_coords;
+
+    int _temperature_grid_size;
+    Memory_account _memory;
 };
 
 #endif // GPU_FORCE_H
@@ -4,7 +4,9 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 #include <OpenMesh/Core/Geometry/VectorT.hh>
+#ifndef PARTICULAR_HEADLESS
 #include <QGLViewer/vec.h>
+#endif
 #include <glm/glm.hpp>
 #include <QVector2D>
 #include <QVector3D>
@@ -15,6 +17,8 @@ inline Eigen::Vector3f cross(Eigen::Vector3f const& v_0, Eigen::Vector3f const&
     return v_0.cross(v_1);
 }
 
+// the headless builds don't link QGLViewer
+#ifndef PARTICULAR_HEADLESS
 inline OpenMesh::Vec3f QGLV2OM(qglviewer::Vec const& p)
 {
     return OpenMesh::Vec3f(p.x, p.y, p.z);
@@ -39,6 +43,7 @@ inline Eigen::Vector3f QGLV2Eigen(qglviewer::Vec const& p)
 {
     return Eigen::Vector3f(p.x, p.y, p.z);
 }
+#endif
 
 inline OpenMesh::Vec3f Eigen2OM(Eigen::Vector3f const& p)
 {
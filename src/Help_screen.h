@@ -18,6 +18,7 @@ public:
     };
 
     Help_screen(My_viewer & viewer, Core & core, Screen & calling_screen, Screen::Type const type = Screen::Type::Modal);
+    char const* get_name() const override { return "Help_screen"; }
 
 //    bool keyPressEvent(QKeyEvent * event) override;
 
@@ -0,0 +1,203 @@
+#include "Input_recording.h"
+
+#include <fstream>
+#include <sstream>
+
+#ifndef Q_MOC_RUN
+#include <boost/archive/xml_oarchive.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#endif
+
+#include "Level_element.h"
+#include "Molecule_releaser.h"
+#include "Visitor.h"
+#include "Message_logger.h"
+
+
+namespace
+{
+
+// reads the size of the sized element types, the others keep a zero extent
+class Extent_reader : public Level_element_visitor
+{
+public:
+    explicit Extent_reader(Eigen::Vector3f & extent) : _extent(extent) { }
+
+    void visit(Plane_barrier * b) const override
+    {
+        if (b->get_extent())
+        {
+            _extent = Eigen::Vector3f((*b->get_extent())[0], (*b->get_extent())[1], 0.0f);
+        }
+    }
+
+    void visit(Box_barrier * b) const override        { _extent = b->get_extent(); }
+    void visit(Blow_barrier * b) const override       { _extent = b->get_extent(); }
+    void visit(Tractor_barrier * b) const override    { _extent = b->get_extent(); }
+    void visit(Moving_box_barrier * b) const override { _extent = b->get_extent(); }
+    void visit(Charged_barrier * b) const override    { _extent = b->get_extent(); }
+    void visit(Molecule_releaser * b) const override  { _extent = b->get_extent(); }
+    void visit(Atom_cannon * b) const override        { _extent = b->get_extent(); }
+    void visit(Box_portal * b) const override         { _extent = b->get_extent(); }
+    void visit(Sphere_portal * b) const override      { _extent = b->get_extent(); }
+    void visit(Brownian_box * b) const override       { _extent = b->get_extent(); }
+
+private:
+    Eigen::Vector3f & _extent;
+};
+
+
+class Extent_writer : public Level_element_visitor
+{
+public:
+    explicit Extent_writer(Eigen::Vector3f const& extent) : _extent(extent) { }
+
+    void visit(Plane_barrier * b) const override
+    {
+        if (!_extent.isZero())
+        {
+            b->set_extent(Eigen::Vector2f(_extent[0], _extent[1]));
+        }
+    }
+
+    void visit(Box_barrier * b) const override        { b->set_size(_extent); }
+    void visit(Blow_barrier * b) const override       { b->set_size(_extent); }
+    void visit(Tractor_barrier * b) const override    { b->set_size(_extent); }
+    void visit(Moving_box_barrier * b) const override { b->set_size(_extent); }
+    void visit(Charged_barrier * b) const override    { b->set_size(_extent); }
+    void visit(Molecule_releaser * b) const override  { b->set_size(_extent); }
+    void visit(Atom_cannon * b) const override        { b->set_size(_extent); }
+    void visit(Box_portal * b) const override         { b->set_size(_extent); }
+    void visit(Sphere_portal * b) const override      { b->set_size(_extent); }
+    void visit(Brownian_box * b) const override       { b->set_size(_extent); }
+
+private:
+    Eigen::Vector3f const& _extent;
+};
+
+}
+
+
+Level_element_state get_level_element_state(Level_element *element, const Parameter_list &properties)
+{
+    Level_element_state state;
+
+    state._position = element->get_position();
+    state._transform = element->get_transform().matrix();
+
+    Extent_reader const extent_reader(state._extent);
+    element->accept(&extent_reader);
+
+    for (auto const& iter : properties)
+    {
+        state._properties[iter.first] = iter.second->get_value<float>();
+    }
+
+    return state;
+}
+
+void set_level_element_state(Level_element *element, const Level_element_state &state)
+{
+    // same order as Draggable_box::visit()
+    element->set_transform(Eigen::Transform<float, 3, Eigen::Affine>(state._transform));
+    element->set_position(state._position);
+
+    Extent_writer const extent_writer(state._extent);
+    element->accept(&extent_writer);
+
+    Parameter_list & properties = element->get_parameters();
+
+    for (auto const& iter : state._properties)
+    {
+        auto const property = properties.find(iter.first);
+
+        if (property != properties.end())
+        {
+            property->second->set_value_no_update(iter.second);
+        }
+    }
+
+    element->set_property_values(properties);
+}
+
+std::string save_level_element(Level_element *element)
+{
+    std::ostringstream out;
+
+    {
+        boost::archive::xml_oarchive oa(out);
+        oa << boost::serialization::make_nvp("element", element);
+    }
+
+    return out.str();
+}
+
+Level_element *load_level_element(const std::string &archive)
+{
+    std::istringstream in(archive);
+    Level_element * element = nullptr;
+
+    try
+    {
+        boost::archive::xml_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("element", element);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't read level element: " << e.what());
+        return nullptr;
+    }
+
+    return element;
+}
+
+
+void Input_recording::clear()
+{
+    _level_archive.clear();
+    _simulation_settings_archive.clear();
+    _seed = 0;
+    _num_steps = 0;
+    _commands.clear();
+}
+
+bool Input_recording::save(const std::string &file_name) const
+{
+    std::ofstream out_file(file_name.c_str(), std::fstream::binary | std::fstream::out);
+
+    if (!out_file)
+    {
+        LOG_WARNING("Couldn't open input recording file: " << file_name);
+        return false;
+    }
+
+    boost::archive::xml_oarchive oa(out_file);
+    oa << boost::serialization::make_nvp("Input_recording", *this);
+
+    return true;
+}
+
+bool Input_recording::load(const std::string &file_name)
+{
+    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in);
+
+    if (!in_file)
+    {
+        LOG_WARNING("Couldn't open input recording file: " << file_name);
+        return false;
+    }
+
+    try
+    {
+        boost::archive::xml_iarchive ia(in_file);
+        ia >> boost::serialization::make_nvp("Input_recording", *this);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't read input recording file: " << file_name << ", reason: " << e.what());
+        clear();
+        return false;
+    }
+
+    return true;
+}
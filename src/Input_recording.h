@@ -0,0 +1,126 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <Eigen/Core>
+
+#ifndef Q_MOC_RUN
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#endif
+
+#include "Parameter.h"
+#include "Eigen_Matrix_serializer.h"
+
+class Level_element;
+
+// Deterministic record and replay of a level run: the level and the simulation settings at the start, the random seed
+// and the user commands together with the physics step they were issued before. Replaying applies each command
+// at the start of its step, so a fixed time step gives the same workload in the game and in particular_sim.
+
+// what the user can change on a placed level element, the same fields Draggable_box writes into it
+struct Level_element_state
+{
+    Level_element_state() :
+        _position(Eigen::Vector3f::Zero()),
+        _transform(Eigen::Matrix4f::Identity()),
+        _extent(Eigen::Vector3f::Zero())
+    { }
+
+    Eigen::Vector3f _position;
+    Eigen::Matrix4f _transform;
+    Eigen::Vector3f _extent; // zero for elements without a size (unbounded planes)
+    std::map<std::string, float> _properties;
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_position);
+        ar & BOOST_SERIALIZATION_NVP(_transform);
+        ar & BOOST_SERIALIZATION_NVP(_extent);
+        ar & BOOST_SERIALIZATION_NVP(_properties);
+    }
+};
+
+// properties are passed separately, while dragging the edited values live in the Draggable, not in the element
+Level_element_state get_level_element_state(Level_element * element, Parameter_list const& properties);
+void set_level_element_state(Level_element * element, Level_element_state const& state);
+
+// polymorphic element as an XML archive, the types are registered in Level_element_exports.h
+std::string save_level_element(Level_element * element);
+Level_element * load_level_element(std::string const& archive);
+
+
+struct Input_command
+{
+    enum class Type { Change_element = 0, Add_element, Delete_element, Add_molecule, Set_parameter };
+
+    Input_command() :
+        _type(int(Type::Change_element)),
+        _step(0),
+        _element_index(-1),
+        _position(Eigen::Vector3f::Zero())
+    { }
+
+    Type get_type() const { return Type(_type); }
+
+    int _type;
+    unsigned long long _step;
+
+    int _element_index;                 // into Level_data::_level_elements
+    Level_element_state _element_state; // Change_element
+    std::string _name;                  // element archive (Add_element), molecule type (Add_molecule), parameter path (Set_parameter)
+    Eigen::Vector3f _position;          // Add_molecule
+    Parameter::My_variant _value;       // Set_parameter
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_type);
+        ar & BOOST_SERIALIZATION_NVP(_step);
+        ar & BOOST_SERIALIZATION_NVP(_element_index);
+        ar & BOOST_SERIALIZATION_NVP(_element_state);
+        ar & BOOST_SERIALIZATION_NVP(_name);
+        ar & BOOST_SERIALIZATION_NVP(_position);
+        ar & BOOST_SERIALIZATION_NVP(_value);
+    }
+};
+
+
+struct Input_recording
+{
+    Input_recording() :
+        _seed(0),
+        _num_steps(0)
+    { }
+
+    void clear();
+
+    // XML archive like the level files
+    bool save(std::string const& file_name) const;
+    bool load(std::string const& file_name);
+
+    std::string _level_archive;               // Level_data after Core::start_level()
+    std::string _simulation_settings_archive; // Core parameters, includes the physics time step and speed
+    unsigned int _seed;                       // std::srand() and Core's Random_generator
+    unsigned long long _num_steps;            // length of the recorded run
+
+    std::vector<Input_command> _commands;     // ordered by step
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_level_archive);
+        ar & BOOST_SERIALIZATION_NVP(_simulation_settings_archive);
+        ar & BOOST_SERIALIZATION_NVP(_seed);
+        ar & BOOST_SERIALIZATION_NVP(_num_steps);
+        ar & BOOST_SERIALIZATION_NVP(_commands);
+    }
+};
+
+#endif // INPUT_RECORDING_H
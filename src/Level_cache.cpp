@@ -0,0 +1,190 @@
+#include "Level_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#ifndef Q_MOC_RUN
+#include <boost/serialization/version.hpp>
+#endif
+
+#include "Level_data.h"
+#include "Level_io.h"
+#include "Message_logger.h"
+#include "Utilities.h"
+
+
+namespace
+{
+
+char const Level_cache_magic[8] = { 'P', 'A', 'R', 'T', 'L', 'V', 'C', '\0' };
+unsigned int const Level_cache_format_version = 2;
+
+// the classes with a BOOST_CLASS_VERSION in a level archive, an entry written with other versions is rebuilt
+void get_level_class_versions(unsigned int (&versions)[4])
+{
+    versions[0] = boost::serialization::version<Level_data>::value;
+    versions[1] = boost::serialization::version<Portal>::value;
+    versions[2] = boost::serialization::version<Molecule_releaser>::value;
+    versions[3] = boost::serialization::version<Atom>::value;
+}
+
+bool read_file(std::string const& file_name, std::vector<char> & data)
+{
+    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in | std::fstream::ate);
+
+    if (!in_file) return false;
+
+    data.resize(size_t(in_file.tellg()));
+
+    in_file.seekg(0);
+
+    return bool(in_file.read(data.data(), std::streamsize(data.size())));
+}
+
+}
+
+
+Level_cache *Level_cache::get_instance()
+{
+    static Level_cache * const instance = new Level_cache;
+
+    return instance;
+}
+
+Level_cache::Level_cache() :
+    _enabled(true)
+{
+    _directory = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("levels");
+}
+
+void Level_cache::set_directory(const QString &directory)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+}
+
+QString Level_cache::get_directory() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _directory;
+}
+
+void Level_cache::load(Level_data &level_data, const std::string &file_name, const Level_load_progress &progress)
+{
+    if (is_binary_level_file(file_name))
+    {
+        load_binary_level(level_data, file_name, progress);
+        return;
+    }
+
+    if (!_enabled)
+    {
+        load_xml_level(level_data, file_name);
+        return;
+    }
+
+    std::vector<char> source;
+
+    if (!read_file(file_name, source))
+    {
+        throw std::runtime_error("Couldn't open level file " + file_name);
+    }
+
+    unsigned long long const source_hash = hash_data(source.data(), source.size());
+    QString const entry_file_name = get_entry_file_name(file_name);
+
+    if (load_entry(level_data, entry_file_name, source_hash, source.size(), progress)) return;
+
+    load_xml_level(level_data, source.data(), source.size(), progress);
+
+    // before Core touches the level data, so the entry has the same content as the source file
+    save_entry(level_data, entry_file_name, source_hash, source.size());
+}
+
+bool Level_cache::load_entry(Level_data &level_data, const QString &entry_file_name, const unsigned long long source_hash, const unsigned long long source_size, const Level_load_progress &progress) const
+{
+    std::vector<char> entry;
+
+    if (!read_file(entry_file_name.toStdString(), entry) || entry.size() < sizeof(Level_cache_header)) return false;
+
+    Level_cache_header header;
+    std::memcpy(&header, entry.data(), sizeof(header));
+
+    unsigned int class_versions[4];
+    get_level_class_versions(class_versions);
+
+    // a changed source file or a version change, the entry is overwritten after parsing the source
+    if (std::memcmp(header._magic, Level_cache_magic, sizeof(Level_cache_magic)) != 0 ||
+            header._format_version != Level_cache_format_version ||
+            std::memcmp(header._class_versions, class_versions, sizeof(class_versions)) != 0 ||
+            header._source_hash != source_hash ||
+            header._source_size != source_size)
+    {
+        return false;
+    }
+
+    try
+    {
+        load_binary_level(level_data, entry.data() + sizeof(header), entry.size() - sizeof(header), progress);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't read cached level " << entry_file_name.toStdString() << ", using the source file: " << e.what());
+        return false; // the archive loads replace the containers, the source file can be read into the same level data
+    }
+
+    return true;
+}
+
+void Level_cache::save_entry(const Level_data &level_data, const QString &entry_file_name, const unsigned long long source_hash, const unsigned long long source_size) const
+{
+    QDir const dir = QFileInfo(entry_file_name).dir();
+
+    if (!dir.exists() && !dir.mkpath("."))
+    {
+        LOG_WARNING("Couldn't create the level cache directory: " << dir.path().toStdString());
+        return;
+    }
+
+    std::ostringstream data(std::ios::binary);
+
+    if (!save_binary_level(level_data, data)) return;
+
+    std::string const level = data.str();
+
+    Level_cache_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header._magic, Level_cache_magic, sizeof(Level_cache_magic));
+    header._format_version = Level_cache_format_version;
+    get_level_class_versions(header._class_versions);
+    header._source_hash = source_hash;
+    header._source_size = source_size;
+
+    // written to a temporary file and renamed, a concurrent reader never sees a partial entry
+    QSaveFile out_file(entry_file_name);
+
+    if (!out_file.open(QIODevice::WriteOnly) ||
+            out_file.write(reinterpret_cast<char const*>(&header), sizeof(header)) != qint64(sizeof(header)) ||
+            out_file.write(level.data(), qint64(level.size())) != qint64(level.size()) ||
+            !out_file.commit())
+    {
+        LOG_WARNING("Couldn't write level cache entry: " << entry_file_name.toStdString());
+    }
+}
+
+QString Level_cache::get_entry_file_name(const std::string &file_name) const
+{
+    QByteArray const path = QFileInfo(QString::fromStdString(file_name)).absoluteFilePath().toUtf8();
+    QString const path_hash = QString::number(hash_data(path.constData(), size_t(path.size())), 16).rightJustified(16, '0');
+
+    return QDir(get_directory()).filePath(path_hash + ".lvc");
+}
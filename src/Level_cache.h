@@ -0,0 +1,56 @@
+#ifndef LEVEL_CACHE_H
+#define LEVEL_CACHE_H
+
+#include <mutex>
+#include <string>
+
+#include <QString>
+
+#include "Level_io.h"
+
+class Level_data;
+
+// Binary copies (Level_io.h) of the XML levels in the user cache directory, so loading a level skips the XML
+// parsing. An entry is keyed on the hash of the absolute path of its source file and replaced when that file or
+// the serialization class versions change. It is a Level_cache_header followed by a binary level.
+
+struct Level_cache_header
+{
+    char _magic[8];
+    unsigned int _format_version;
+    unsigned int _class_versions[4];  // see get_level_class_versions()
+    unsigned long long _source_hash;
+    unsigned long long _source_size;
+};
+
+class Level_cache
+{
+public:
+    static Level_cache * get_instance();
+
+    // XML levels through the cache, the entry is written after a miss, binary levels are loaded directly.
+    // Throws like the boost archives on broken source files. Can be called from the level loading thread.
+    // progress isn't called for XML levels when the cache is disabled.
+    void load(Level_data & level_data, std::string const& file_name, Level_load_progress const& progress = Level_load_progress());
+
+    void set_directory(QString const& directory);
+    QString get_directory() const;
+
+    void set_enabled(bool const enabled) { _enabled = enabled; }
+    bool is_enabled() const { return _enabled; }
+
+private:
+    Level_cache();
+
+    bool load_entry(Level_data & level_data, QString const& entry_file_name, unsigned long long const source_hash, unsigned long long const source_size, Level_load_progress const& progress) const;
+    void save_entry(Level_data const& level_data, QString const& entry_file_name, unsigned long long const source_hash, unsigned long long const source_size) const;
+
+    QString get_entry_file_name(std::string const& file_name) const;
+
+    QString _directory;
+    bool _enabled;
+
+    mutable std::mutex _mutex; // only for _directory, loads run in parallel
+};
+
+#endif // LEVEL_CACHE_H
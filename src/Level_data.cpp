@@ -1,18 +1,21 @@
 #include "Level_data.h"
 
 #include "End_condition.h"
-#include "Main_options_window.h"
+#include "Message_logger.h"
 
 
-Level_data::Level_data()
+Level_data::Level_data() :
+    _combined_external_force(Eigen::Vector3f::Zero())
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
-    std::function<void(void)> update_variables = std::bind(&Level_data::update_variables, this);
+    // the ids only have to differ between the functions and the instances
+    Parameter_callback const update_variables(std::bind(&Level_data::update_variables, this), this);
+    Parameter_callback const change_game_field_borders(std::bind(&Level_data::change_game_field_borders, this), &_game_field_borders);
 
-    _parameters.add_parameter(new Parameter("Game Field Width",  80.0f, 40.0f, 200.0f, std::bind(&Level_data::change_game_field_borders, this)));
-    _parameters.add_parameter(new Parameter("Game Field Height", 40.0f, 20.0f, 200.0f, std::bind(&Level_data::change_game_field_borders, this)));
-    _parameters.add_parameter(new Parameter("Game Field Depth",  40.0f, 5.0f,  100.0f, std::bind(&Level_data::change_game_field_borders, this)));
+    _parameters.add_parameter(new Parameter("Game Field Width",  80.0f, 40.0f, 200.0f, change_game_field_borders));
+    _parameters.add_parameter(new Parameter("Game Field Height", 40.0f, 20.0f, 200.0f, change_game_field_borders));
+    _parameters.add_parameter(new Parameter("Game Field Depth",  40.0f, 5.0f,  100.0f, change_game_field_borders));
 
     _parameters.add_parameter(new Parameter("score_time_factor", 60.0f, 1.0f, 3000.0f, update_variables));
 
@@ -36,6 +39,12 @@ Level_data::Level_data()
     available_list->add_parameter(new Parameter("Charged_barrier", 0, 0, 9, update_variables));
     available_list->add_parameter(new Parameter("Tractor_barrier", 0, 0, 9, update_variables));
 
+    _game_field_width_handle.bind(&_parameters, "Game Field Width");
+    _game_field_height_handle.bind(&_parameters, "Game Field Height");
+    _game_field_depth_handle.bind(&_parameters, "Game Field Depth");
+    _temperature_handle.bind(&_parameters, "Temperature");
+    _gravity_handle.bind(&_parameters, "gravity");
+
     _temperature_grid.set_size(10, 10);
 
     update_variables();
@@ -43,19 +52,16 @@ Level_data::Level_data()
 
 bool Level_data::validate_elements()
 {
-    std::cout << __FUNCTION__ << " "
-              << _level_elements.size() << " "
+    LOG_DEBUG(_level_elements.size() << " "
               << _barriers.size() << " "
               << _portals.size() << " "
               << _molecule_releasers.size() << " "
-              << _brownian_elements.size()
-              << std::endl;
-
-    std::cout << "LE: " << _level_elements << "\n"
+              << _brownian_elements.size() << "\n"
+              << "LE: " << _level_elements << "\n"
               << "BA: " << _barriers << "\n"
               << "PO: " << _portals << "\n"
               << "MR: " << _molecule_releasers << "\n"
-              << "BE: " << _brownian_elements << "\n";
+              << "BE: " << _brownian_elements);
 
     for (auto const& e : _level_elements)
     {
@@ -89,6 +95,9 @@ bool Level_data::validate_elements()
 
 void Level_data::load_defaults()
 {
+    // the borders and the variables are updated once, when the batch ends
+    Parameter_batch batch;
+
     _parameters["Game Field Width"]->set_value(80.0f);
     _parameters["Game Field Height"]->set_value(40.0f);
     _parameters["Game Field Depth"]->set_value(40.0f);
@@ -96,8 +105,6 @@ void Level_data::load_defaults()
     _parameters["Temperature"]->set_value(0.0f);
     _parameters["Damping"]->set_value(0.3f);
     _parameters["gravity"]->set_value(0.0f);
-
-    update_variables();
 }
 
 void Level_data::update_variables()
@@ -118,6 +125,7 @@ void Level_data::update_variables()
 
     //        _gravity = _parameters["gravity"]->get_value<float>();
     _external_forces["gravity"]._force[2] = -_parameters["gravity"]->get_value<float>();
+    update_combined_external_force();
 
     _game_field_width = _parameters["Game Field Width"]->get_value<float>();
     _game_field_height = _parameters["Game Field Height"]->get_value<float>();
@@ -197,6 +205,41 @@ void Level_data::add_barrier(Barrier *barrier)
     _level_elements.push_back(boost::shared_ptr<Level_element>(barrier));
 }
 
+void Level_data::add_level_element(Level_element *element)
+{
+    if (Molecule_releaser * m = dynamic_cast<Molecule_releaser*>(element))
+    {
+        add_molecule_releaser(m);
+    }
+    else if (Portal * p = dynamic_cast<Portal*>(element))
+    {
+        add_portal(p);
+    }
+    else if (Brownian_element * b = dynamic_cast<Brownian_element*>(element))
+    {
+        add_brownian_element(b);
+    }
+    else if (Barrier * b = dynamic_cast<Barrier*>(element))
+    {
+        add_barrier(b);
+    }
+    else
+    {
+        LOG_WARNING("Unknown level element type");
+        delete element;
+    }
+}
+
+void Level_data::update_combined_external_force()
+{
+    _combined_external_force = Eigen::Vector3f::Zero();
+
+    for (auto const& f : _external_forces)
+    {
+        _combined_external_force += f.second._force;
+    }
+}
+
 void Level_data::change_game_field_borders()
 {
     //        Eigen::Vector3f min(_parameters["game_field_left"]->get_value<float>(),
@@ -275,6 +318,29 @@ void Level_data::reset_level_elements()
     }
 }
 
+void Level_data::swap_level_contents(Level_data &other)
+{
+    std::swap(_molecules, other._molecules);
+    std::swap(_game_field_borders, other._game_field_borders);
+    std::swap(_barriers, other._barriers);
+    std::swap(_portals, other._portals);
+    std::swap(_brownian_elements, other._brownian_elements);
+    std::swap(_molecule_releasers, other._molecule_releasers);
+    std::swap(_particle_system_elements, other._particle_system_elements);
+    std::swap(_level_elements, other._level_elements);
+    std::swap(_available_elements, other._available_elements);
+    std::swap(_score_time_factor, other._score_time_factor);
+    std::swap(_background_name, other._background_name);
+    std::swap(_translation_damping, other._translation_damping);
+    std::swap(_rotation_damping, other._rotation_damping);
+    std::swap(_rotation_fluctuation, other._rotation_fluctuation);
+    std::swap(_translation_fluctuation, other._translation_fluctuation);
+    std::swap(_external_forces, other._external_forces);
+
+    update_combined_external_force();
+    other.update_combined_external_force();
+}
+
 void Level_data::use_unstable_options()
 {
     _parameters["Damping"]->set_min_max(0.0f, 1.0f);
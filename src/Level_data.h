@@ -50,12 +50,18 @@ public:
     void add_portal(Portal *portal);
     void add_brownian_element(Brownian_element *element);
     void add_barrier(Barrier *barrier);
+    // dispatches on the dynamic type to the add functions above
+    void add_level_element(Level_element *element);
+    void update_combined_external_force();
     void change_game_field_borders();
     void set_game_field_borders(Eigen::Vector3f const& min, Eigen::Vector3f const& max);
 
     void delete_level_element(Level_element *level_element);
     void reset_level_elements();
 
+    // exchanges the serialized level content with other, the parameters stay with their instance (see update_parameters())
+    void swap_level_contents(Level_data & other);
+
     void use_unstable_options();
 
     static Level_data * create()
@@ -150,6 +156,8 @@ public:
             // Solved by adding the option to keep molecules in Core::reset_level, won't keep their external forces however.
             ar & BOOST_SERIALIZATION_NVP(_molecules);
         }
+
+        update_combined_external_force();
     }
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
@@ -185,8 +193,16 @@ public:
 //    float _gravity;
 
     std::map<std::string, External_force> _external_forces;
+    Eigen::Vector3f _combined_external_force; // sum of _external_forces, update_combined_external_force() after changes
 
     Parameter_list _parameters;
+
+    // cached lookups into _parameters for per-frame/per-step readers
+    Parameter_handle<float> _game_field_width_handle;
+    Parameter_handle<float> _game_field_height_handle;
+    Parameter_handle<float> _game_field_depth_handle;
+    Parameter_handle<float> _temperature_handle;
+    Parameter_handle<float> _gravity_handle;
 };
 
 //REGISTER_BASE_CLASS_WITH_PARAMETERS(Level_data);
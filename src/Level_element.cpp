@@ -117,6 +117,18 @@ void Level_element::reset()
     _selected = false;
 }
 
+void Level_element::save_state(Checkpoint_buffer &buffer) const
+{
+    buffer.write_vector(_animations);
+}
+
+void Level_element::load_state(Checkpoint_reader &reader)
+{
+    reader.read_vector(_animations);
+
+    handle_animation();
+}
+
 
 bool Level_element::is_persistent() const
 {
@@ -287,6 +299,21 @@ void Portal::reset()
     _end_condition.set_num_captured_molecules(0);
 }
 
+void Portal::save_state(Checkpoint_buffer &buffer) const
+{
+    Level_element::save_state(buffer);
+    buffer.write(_end_condition.get_num_captured_molecules());
+}
+
+void Portal::load_state(Checkpoint_reader &reader)
+{
+    Level_element::load_state(reader);
+
+    int num_captured_molecules;
+    reader.read(num_captured_molecules);
+    _end_condition.set_num_captured_molecules(num_captured_molecules);
+}
+
 
 Box_portal::Box_portal(const Eigen::Vector3f &min, const Eigen::Vector3f &max)
 {
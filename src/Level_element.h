@@ -20,6 +20,7 @@
 //#include "Barrier_draw_visitor.h"
 
 #include "Eigen_Matrix_serializer.h"
+#include "Checkpoint_buffer.h"
 
 class Molecule;
 class Atom;
@@ -172,6 +173,11 @@ public:
 
     virtual void reset();
 
+    // the state that changes while the simulation runs, for Core's checkpoints; the placement and the properties
+    // stay as they are, like with reset()
+    virtual void save_state(Checkpoint_buffer & buffer) const;
+    virtual void load_state(Checkpoint_reader & reader);
+
     bool is_persistent() const;
     void set_persistent(bool const p);
 
@@ -297,6 +303,9 @@ public:
 
     void reset() override;
 
+    void save_state(Checkpoint_buffer & buffer) const override;
+    void load_state(Checkpoint_reader & reader) override;
+
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
     {
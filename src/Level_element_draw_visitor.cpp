@@ -1,5 +1,8 @@
 #include "Level_element_draw_visitor.h"
 
+#include "Asset_preloader.h"
+#include "Profiler.h"
+
 
 void Level_element_draw_visitor::visit(Plane_barrier *b) const
 {
@@ -643,16 +646,16 @@ void Level_element_draw_visitor::visit(Particle_system_element *system) const
 
 void Level_element_draw_visitor::init(const QGLContext *context, const QSize &size)
 {
+    PROFILE_ZONE("Level_element_draw_visitor::init");
+
     GL_functions f;
     f.init();
 
-    Frame_buffer<Color> molecule_releaser_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/molecule_releaser.png")));
-    _molecule_releaser_tex = f.create_texture(molecule_releaser_tex_fb);
-
-    Frame_buffer<Color4> brownian_panel_tex_fb = convert<QRgb_to_Color4_converter, Color4>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/brownian_panel.png")));
-    _brownian_panel_tex = f.create_texture(brownian_panel_tex_fb);
+    // the textures belong to the Texture_cache, usually decoded by the Asset_preloader
+    _molecule_releaser_tex = Texture_cache::get_instance()->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/molecule_releaser.png"));
+    _brownian_panel_tex = Texture_cache::get_instance()->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/brownian_panel.png"), Texture_options::alpha());
 
-    _molecule_releaser_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/molecule_releaser.obj"));
+    _molecule_releaser_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/molecule_releaser.obj"));
 
     //        typename MyMesh::ConstVertexIter vIt(_molecule_releaser_mesh.vertices_begin()), vEnd(_molecule_releaser_mesh.vertices_end());
 
@@ -664,14 +667,13 @@ void Level_element_draw_visitor::init(const QGLContext *context, const QSize &si
     //            std::cout << vIt.handle() << " normal " << _molecule_releaser_mesh.normal(vIt.handle()) << std::endl;
     //        }
 
-    _tractor_circle_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/tractor_circle.obj"));
+    _tractor_circle_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/tractor_circle.obj"));
 
-    _icosphere_3_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj"));
+    _icosphere_3_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj"));
 
     _texture_program = std::unique_ptr<QGLShaderProgram>(init_program(context, Data_config::get_instance()->get_absolute_qfilename("shaders/temperature.vert"), Data_config::get_instance()->get_absolute_qfilename("shaders/test.frag")));
 
-    Frame_buffer<Color4> particle_tex_fb = convert<QRgb_to_Color4_converter, Color4>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/particle.png")));
-    _particle_tex = f.create_texture(particle_tex_fb);
+    _particle_tex = Texture_cache::get_instance()->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/particle.png"), Texture_options::alpha());
 
     _particle_distance_shader = std::unique_ptr<QGLShaderProgram>(init_program(context,
                                                                                Data_config::get_instance()->get_absolute_qfilename("shaders/distance_particle.vert"),
@@ -9,6 +9,7 @@
 #include "Molecule_releaser.h"
 #include "Data_config.h"
 #include "Color_utilities.h"
+#include "Texture_cache.h"
 
 class Level_element_draw_visitor : public Level_element_visitor
 {
@@ -133,14 +134,11 @@ public:
         GL_functions f;
         f.init();
 
-        Frame_buffer<Color4> brownian_panel_tex_fb = convert<QRgb_to_Color4_converter, Color4>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/brownian_panel.png")));
-        _brownian_panel_tex = f.create_texture(brownian_panel_tex_fb);
+        Texture_cache * const texture_cache = Texture_cache::get_instance();
 
-        Frame_buffer<Color4> tractor_panel_tex_fb = convert<QRgb_to_Color4_converter, Color4>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/tractor_panel.png")));
-        _tractor_panel_tex = f.create_texture(tractor_panel_tex_fb);
-
-        Frame_buffer<Color4> panel_charged_barrier_tex_fb = convert<QRgb_to_Color4_converter, Color4>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/panel_charged_barrier.png")));
-        _panel_charged_barrier_tex = f.create_texture(panel_charged_barrier_tex_fb);
+        _brownian_panel_tex = texture_cache->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/brownian_panel.png"), Texture_options::alpha());
+        _tractor_panel_tex = texture_cache->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/tractor_panel.png"), Texture_options::alpha());
+        _panel_charged_barrier_tex = texture_cache->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/panel_charged_barrier.png"), Texture_options::alpha());
     }
 
 
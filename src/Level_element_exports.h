@@ -0,0 +1,25 @@
+#ifndef LEVEL_ELEMENT_EXPORTS_H
+#define LEVEL_ELEMENT_EXPORTS_H
+
+#ifndef Q_MOC_RUN
+#include <boost/serialization/export.hpp>
+#endif
+
+#include "Level_element.h"
+#include "Molecule_releaser.h"
+#include "End_condition.h"
+
+// polymorphic types stored in level files, include in exactly one translation unit per executable
+
+BOOST_CLASS_EXPORT_GUID(Box_barrier, "Box_barrier")
+BOOST_CLASS_EXPORT_GUID(Plane_barrier, "Plane_barrier")
+//BOOST_CLASS_EXPORT_GUID(Moving_box_barrier, "Moving_box_barrier")
+BOOST_CLASS_EXPORT_GUID(Molecule_releaser, "Molecule_releaser")
+BOOST_CLASS_EXPORT_GUID(Box_portal, "Box_portal")
+BOOST_CLASS_EXPORT_GUID(Sphere_portal, "Sphere_portal")
+BOOST_CLASS_EXPORT_GUID(Brownian_box, "Brownian_box")
+BOOST_CLASS_EXPORT_GUID(Tractor_barrier, "Tractor_barrier")
+BOOST_CLASS_EXPORT_GUID(Charged_barrier, "Charged_barrier")
+BOOST_CLASS_EXPORT_GUID(Molecule_capture_condition, "Molecule_capture_condition")
+
+#endif // LEVEL_ELEMENT_EXPORTS_H
@@ -0,0 +1,154 @@
+#include "Level_io.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <QFileInfo>
+#include <QDir>
+
+#ifndef Q_MOC_RUN
+#include <boost/archive/xml_oarchive.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#endif
+
+#include "Level_data.h"
+#include "Level_cache.h"
+#include "Message_logger.h"
+
+
+namespace
+{
+char const Binary_level_magic[8] = { 'P', 'A', 'R', 'T', 'L', 'V', 'L', '\0' };
+}
+
+
+std::string get_binary_level_file_name(const std::string &file_name)
+{
+    QFileInfo const info(QString::fromStdString(file_name));
+
+    return info.dir().filePath(info.completeBaseName() + ".bin").toStdString();
+}
+
+bool is_binary_level_file(const std::string &file_name)
+{
+    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in);
+
+    Binary_level_header header;
+
+    return in_file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            std::memcmp(header._magic, Binary_level_magic, sizeof(Binary_level_magic)) == 0;
+}
+
+void load_level_file(Level_data &level_data, const std::string &file_name, const Level_load_progress &progress)
+{
+    Level_cache::get_instance()->load(level_data, file_name, progress);
+}
+
+void load_xml_level(Level_data &level_data, const std::string &file_name)
+{
+    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in);
+    boost::archive::xml_iarchive ia(in_file);
+
+    ia >> boost::serialization::make_nvp("_level_data", level_data);
+}
+
+void load_xml_level(Level_data &level_data, const char *data, const size_t size, const Level_load_progress &progress)
+{
+    Memory_streambuf buffer(data, size, progress);
+    std::istream in(&buffer);
+
+    boost::archive::xml_iarchive ia(in);
+    ia >> boost::serialization::make_nvp("_level_data", level_data);
+}
+
+void save_xml_level(const Level_data &level_data, const std::string &file_name)
+{
+    std::ofstream out_file(file_name.c_str(), std::fstream::binary | std::fstream::out);
+    boost::archive::xml_oarchive oa(out_file);
+
+    oa << boost::serialization::make_nvp("_level_data", level_data);
+}
+
+void load_binary_level(Level_data &level_data, const std::string &file_name, const Level_load_progress &progress)
+{
+    std::ifstream in_file(file_name.c_str(), std::fstream::binary | std::fstream::in | std::fstream::ate);
+
+    if (!in_file)
+    {
+        throw std::runtime_error("Couldn't open binary level file " + file_name);
+    }
+
+    std::vector<char> buffer(size_t(in_file.tellg()));
+
+    in_file.seekg(0);
+    in_file.read(buffer.data(), std::streamsize(buffer.size()));
+
+    load_binary_level(level_data, buffer.data(), buffer.size(), progress);
+}
+
+void load_binary_level(Level_data &level_data, const char *data, const size_t size, const Level_load_progress &progress)
+{
+    Binary_level_header header;
+
+    if (size < sizeof(header))
+    {
+        throw std::runtime_error("Binary level too short");
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header._magic, Binary_level_magic, sizeof(Binary_level_magic)) != 0)
+    {
+        throw std::runtime_error("Not a binary level");
+    }
+
+    if (header._format_version != Binary_level_format_version)
+    {
+        throw std::runtime_error("Unsupported binary level format version " + std::to_string(header._format_version));
+    }
+
+    Memory_streambuf buffer(data + sizeof(header), size - sizeof(header), progress);
+    std::istream in(&buffer);
+
+    boost::archive::binary_iarchive ia(in);
+    ia >> boost::serialization::make_nvp("_level_data", level_data);
+}
+
+bool save_binary_level(const Level_data &level_data, const std::string &file_name)
+{
+    std::ofstream out_file(file_name.c_str(), std::fstream::binary | std::fstream::out);
+
+    if (!out_file)
+    {
+        LOG_WARNING("Couldn't write binary level file: " << file_name);
+        return false;
+    }
+
+    return save_binary_level(level_data, out_file);
+}
+
+bool save_binary_level(const Level_data &level_data, std::ostream &out)
+{
+    Binary_level_header header;
+    std::memcpy(header._magic, Binary_level_magic, sizeof(Binary_level_magic));
+    header._format_version = Binary_level_format_version;
+
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    try
+    {
+        boost::archive::binary_oarchive oa(out);
+        oa << boost::serialization::make_nvp("_level_data", level_data);
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't write binary level: " << e.what());
+        return false;
+    }
+
+    return bool(out);
+}
@@ -0,0 +1,81 @@
+#ifndef LEVEL_IO_H
+#define LEVEL_IO_H
+
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+class Level_data;
+
+// Level files: the boost XML archives in data/levels and a binary form of the same Level_data serialization.
+// A binary file starts with Binary_level_header followed by a boost binary archive, which carries the class
+// versions (BOOST_CLASS_VERSION) like the XML archives do. particular_convert writes them next to the XML files
+// ("Level 1.data" -> "Level 1.bin"), the game keeps its own binary copies in the Level_cache.
+
+struct Binary_level_header
+{
+    char _magic[8];
+    unsigned int _format_version;
+};
+
+int const Binary_level_format_version = 1;
+
+// called with the fraction of the level data parsed so far, from the thread that loads the level
+typedef std::function<void(float)> Level_load_progress;
+
+// Read-only stream buffer over memory that stays valid while reading. With a progress callback the memory is
+// handed to the stream in chunks and the callback gets the fraction consumed whenever the next chunk is needed.
+class Memory_streambuf : public std::streambuf
+{
+public:
+    Memory_streambuf(char const* data, size_t const size, Level_load_progress const& progress = Level_load_progress()) :
+        _begin(const_cast<char*>(data)),
+        _size(size),
+        _progress(progress)
+    {
+        setg(_begin, _begin, _begin + (_progress ? std::min(size, size_t(Chunk_size)) : size));
+    }
+
+protected:
+    int_type underflow() override
+    {
+        size_t const position = size_t(egptr() - _begin);
+
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        if (position >= _size) return traits_type::eof();
+
+        _progress(float(position) / float(_size));
+
+        setg(_begin, egptr(), egptr() + std::min(_size - position, size_t(Chunk_size)));
+
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    enum { Chunk_size = 64 * 1024 };
+
+    char * _begin;
+    size_t _size;
+    Level_load_progress _progress;
+};
+
+std::string get_binary_level_file_name(std::string const& file_name);
+bool is_binary_level_file(std::string const& file_name);
+
+// binary or XML level, XML levels through the Level_cache. Throws like the boost archives on broken files.
+void load_level_file(Level_data & level_data, std::string const& file_name, Level_load_progress const& progress = Level_load_progress());
+
+void load_xml_level(Level_data & level_data, std::string const& file_name);
+void load_xml_level(Level_data & level_data, char const* data, size_t const size, Level_load_progress const& progress = Level_load_progress());
+void save_xml_level(Level_data const& level_data, std::string const& file_name);
+
+// the whole file is read with a single read and parsed from memory
+void load_binary_level(Level_data & level_data, std::string const& file_name, Level_load_progress const& progress = Level_load_progress());
+void load_binary_level(Level_data & level_data, char const* data, size_t const size, Level_load_progress const& progress = Level_load_progress());
+bool save_binary_level(Level_data const& level_data, std::string const& file_name);
+bool save_binary_level(Level_data const& level_data, std::ostream & out);
+
+#endif // LEVEL_IO_H
@@ -12,6 +12,8 @@
 #include "GL_texture.h"
 #include "Main_options_window.h"
 #include "Event.h"
+#include "Rewind_buffer.h"
+#include "Message_logger.h"
 #include "widget_text_combination.h"
 
 //Main_game_screen::Main_game_screen(My_viewer &viewer, Core &core, std::unique_ptr<World_renderer> &renderer) : Screen(viewer),
@@ -26,9 +28,11 @@ Main_game_screen::Main_game_screen(My_viewer &viewer, Core &core, Ui_state ui_st
     _selected_level_element(nullptr),
     _ui_state(ui_state),
     _level_state(Level_state::Running),
-    _last_updated_bonus(_core.get_sensor_data().get_energy_bonus().back())
+    _renderer_update_pending(false),
+    _last_updated_bonus(_core.get_sensor_data().get_energy_bonus()),
+    _main_fbo_memory(Memory_subsystem::Render_targets)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     GL_functions f;
     f.init();
@@ -47,6 +51,7 @@ Main_game_screen::Main_game_screen(My_viewer &viewer, Core &core, Ui_state ui_st
     _slider_tex = f.create_texture(Data_config::get_instance()->get_absolute_qfilename("textures/slider.png"));
 
     _main_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(QSize(_viewer.camera()->screenWidth(), _viewer.camera()->screenHeight()), QGLFramebufferObject::Depth));
+    _main_fbo_memory.set(size_t(_main_fbo->width()) * size_t(_main_fbo->height()) * 2 * 4); // RGBA and depth
 
     _screen_quad_program = std::unique_ptr<QGLShaderProgram>(init_program(_viewer.context(),
                                                                           Data_config::get_instance()->get_absolute_qfilename("shaders/fullscreen_square.vert"),
@@ -89,13 +94,14 @@ Main_game_screen::Main_game_screen(My_viewer &viewer, Core &core, Ui_state ui_st
 
     connect(&_core, SIGNAL(level_changed(Main_game_screen::Level_state)), this, SLOT(handle_level_change(Main_game_screen::Level_state)));
     connect(&_core, SIGNAL(game_state_changed()), this, SLOT(handle_game_state_change()));
+    connect(&_core, SIGNAL(level_elements_changed()), this, SLOT(handle_level_elements_change()));
 
     init_labels();
 }
 
 Main_game_screen::~Main_game_screen()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
     Main_options_window::get_instance()->remove_parameter_list("Main_game_screen");
 }
 
@@ -131,7 +137,7 @@ void Main_game_screen::init_labels()
 
         {
 
-            float const current_bonus = _core.get_sensor_data().get_energy_bonus().back();
+            float const current_bonus = _core.get_sensor_data().get_energy_bonus();
             _energy_bonus_label = boost::shared_ptr<Draggable_label>(new Draggable_label({ 0.0f, 0.0f, 0.0f }, { 0.3f, 0.2f }, QString("%1").arg(current_bonus, 6).toStdString()));
             Eigen::Vector2f bb = _ui_renderer.generate_flowing_text_label(_energy_bonus_label.get(), 0.4f);
             Eigen::Vector3f left_edge_pos(0.7f + bb[0] * 0.5f + 0.01f, 1.0f - 0.02f - bb[1] * 1.5f, 0.0f);
@@ -161,12 +167,16 @@ bool Main_game_screen::mousePressEvent(QMouseEvent * event)
     {
         handled = true;
     }
+    else if (_core.is_replaying_input())
+    {
+        // element changes come from the recording, the camera stays with the viewer
+    }
     else
     {
         _picked_index = _picking.do_pick(event->pos().x() / float(_viewer.camera()->screenWidth()), (_viewer.camera()->screenHeight() - event->pos().y())  / float(_viewer.camera()->screenHeight()),
                                          std::bind(&Main_game_screen::draw_draggables_for_picking, this));
 
-        std::cout << __FUNCTION__ << " picked_index: " << _picked_index << std::endl;
+        LOG_DEBUG("picked_index: " << _picked_index);
 
         if (_picked_index != -1)
         {
@@ -176,7 +186,7 @@ bool Main_game_screen::mousePressEvent(QMouseEvent * event)
             qglviewer::Vec world_pos = _viewer.camera()->pointUnderPixel(event->pos(), found);
 
             _mouse_state = Mouse_state::Init_drag_handle;
-            std::cout << __FUNCTION__ << " Init_drag_handle" << std::endl;
+            LOG_DEBUG("Init_drag_handle");
 
             if (found)
             {
@@ -228,13 +238,19 @@ bool Main_game_screen::mouseMoveEvent(QMouseEvent * event)
 
 //            if (!check_for_collision(level_element))
         {
+            // the parameters changed by the drag run their update functions once per event
+            Parameter_batch batch;
+
             _active_draggables[_picked_index]->set_position_from_world(new_position);
             _active_draggables[_picked_index]->update();
 
-            std::cout << __FUNCTION__ << ": " << parent << std::endl;
+            LOG_DEBUG(parent);
 
             level_element->accept(parent);
 
+            Draggable_box const* box = dynamic_cast<Draggable_box const*>(parent);
+            _core.record_element_change(level_element, box ? box->get_properties() : level_element->get_parameters());
+
 //            update();
         }
     }
@@ -248,7 +264,7 @@ bool Main_game_screen::mouseReleaseEvent(QMouseEvent * event)
 
     if (_mouse_state == Mouse_state::Init_drag_handle)
     {
-        std::cout << __FUNCTION__ << " click on handle" << std::endl;
+        LOG_DEBUG("click on handle");
 
         _mouse_state = Mouse_state::None;
 
@@ -302,9 +318,44 @@ bool Main_game_screen::keyPressEvent(QKeyEvent * event)
 {
     bool handled = false;
 
-    std::cout << __FUNCTION__ << " " << event->key() << std::endl;
+    LOG_DEBUG(event->key());
+
+    if (event->key() == Qt::Key_Escape && _core.is_previewing_rewind())
+    {
+        _core.end_rewind_preview(false);
+        handled = true;
+    }
+    else if ((event->key() == Qt::Key_Left || event->key() == Qt::Key_Right) && (event->modifiers() & Qt::ControlModifier) &&
+             get_state() == State::Running && _level_state != Level_state::Intro)
+    {
+        // scrub through the rewind history in steps of a second, past the newest entry goes back to the live state
+        Rewind_buffer const& rewind_buffer = _core.get_rewind_buffer();
+
+        if (!rewind_buffer.is_empty())
+        {
+            float time = _core.is_previewing_rewind() ? _core.get_rewind_preview_time() : rewind_buffer.get_newest_time();
+            time += (event->key() == Qt::Key_Left) ? -1.0f : 1.0f;
 
-    if (event->key() == Qt::Key_Escape)
+            if (time > rewind_buffer.get_newest_time())
+            {
+                _core.end_rewind_preview(false);
+            }
+            else
+            {
+                _core.preview_rewind(std::max(time, rewind_buffer.get_oldest_time()));
+            }
+        }
+
+        handled = true;
+    }
+    else if ((event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) && (event->modifiers() & Qt::ControlModifier) &&
+             _core.is_previewing_rewind())
+    {
+        // continue from the previewed time
+        _core.end_rewind_preview(true);
+        handled = true;
+    }
+    else if (event->key() == Qt::Key_Escape)
     {
         if (get_state() == State::Running && _level_state != Level_state::Intro)
         {
@@ -345,9 +396,20 @@ bool Main_game_screen::keyPressEvent(QKeyEvent * event)
             handled = true;
         }
     }
+    else if (event->key() == Qt::Key_F5 && _level_state != Level_state::Intro)
+    {
+        _core.save_checkpoint();
+        handled = true;
+    }
+    else if (event->key() == Qt::Key_F6 && _level_state != Level_state::Intro)
+    {
+        // retry from the checkpoint taken with F5
+        _core.restore_checkpoint();
+        handled = true;
+    }
     else if (event->key() == Qt::Key_F && (event->modifiers() & Qt::ShiftModifier) && (event->modifiers() & Qt::ControlModifier))
     {
-        std::cout << __FUNCTION__ << " finish forced" << std::endl;
+        LOG_DEBUG("finish forced");
 
         _core.set_new_game_state(Core::Game_state::Finished);
         handled = true;
@@ -359,6 +421,17 @@ bool Main_game_screen::keyPressEvent(QKeyEvent * event)
 
 void Main_game_screen::draw()
 {
+    if (_renderer_update_pending)
+    {
+        _renderer_update_pending = false;
+
+        if (_core.get_level_data()._background_name != _renderer_background_name)
+        {
+            _renderer->update(_core.get_level_data());
+            _renderer_background_name = _core.get_level_data()._background_name;
+        }
+    }
+
     _renderer->setup_gl_points(true);
 
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -443,7 +516,7 @@ void Main_game_screen::draw()
 
 void Main_game_screen::state_changed_event(const Screen::State new_state, const Screen::State previous_state)
 {
-    std::cout << __FUNCTION__ << " " << int(new_state) << " " << int(previous_state) << std::endl;
+    LOG_DEBUG(int(new_state) << " " << int(previous_state));
 
     if (new_state == State::Running)
     {
@@ -456,7 +529,7 @@ void Main_game_screen::update_score_labels()
 {
     if (_energy_amount_label && !_core.get_sensor_data().get_data(Sensor_data::Type::EnergyCon).empty())
     {
-        float const energy = _core.get_sensor_data().get_data(Sensor_data::Type::EnergyCon).back();
+        float const energy = _core.get_sensor_data().get_data(Sensor_data::Type::EnergyCon).get_last();
         std::string new_energy_str = QString("%1\%").arg(int(energy * 100)).toStdString();
         if (new_energy_str != _energy_amount_label->get_text())
         {
@@ -489,7 +562,7 @@ void Main_game_screen::update_score_labels()
 
     if (_energy_bonus_label)
     {
-        float const current_bonus = _core.get_sensor_data().get_energy_bonus().back();
+        float const current_bonus = _core.get_sensor_data().get_energy_bonus();
 
         if (_last_updated_bonus - current_bonus > 200)
         {
@@ -566,6 +639,7 @@ void Main_game_screen::delete_selected_element()
 //        assert(_draggable_to_level_element.find(parent) != _draggable_to_level_element.end());
 
 //        _core.get_level_data().delete_level_element(_draggable_to_level_element.find(parent)->second);
+        _core.record_element_deletion(_selected_level_element);
         _core.get_level_data().delete_level_element(_selected_level_element);
 
         update_draggable_to_level_element();
@@ -582,7 +656,7 @@ void Main_game_screen::show_context_menu_for_element()
 
     assert(_draggable_to_level_element.find(parent) != _draggable_to_level_element.end());
 
-    std::cout << __FUNCTION__ << ": " << parent << std::endl;
+    LOG_DEBUG(parent);
 
     Level_element * element = _draggable_to_level_element[parent];
 
@@ -1212,6 +1286,8 @@ void Main_game_screen::add_element(const Eigen::Vector3f &position, const std::s
     float front_pos = _core.get_level_data()._game_field_borders[Level_data::Plane::Neg_Y]->get_position()[1];
     float back_pos  = _core.get_level_data()._game_field_borders[Level_data::Plane::Pos_Y]->get_position()[1];
 
+    size_t const num_level_elements = _core.get_level_data()._level_elements.size();
+
     if (Molecule::molecule_exists(element_type))
     {
         int const num_per_axis = std::ceil(std::pow(num_to_add, 1.0f / 3.0f)) - 1;
@@ -1223,6 +1299,7 @@ void Main_game_screen::add_element(const Eigen::Vector3f &position, const std::s
 
             Eigen::Vector3f final_position = position + offset * radius;
             _core.add_molecule(Molecule::create(element_type, final_position));
+            _core.record_molecule_addition(element_type, final_position);
         }
     }
     else if (element_type == std::string("Box_barrier"))
@@ -1349,7 +1426,12 @@ void Main_game_screen::add_element(const Eigen::Vector3f &position, const std::s
     }
     else
     {
-        std::cout << __FUNCTION__ << " element does not exist: " << element_type << std::endl;
+        LOG_WARNING("element does not exist: " << element_type);
+    }
+
+    if (_core.get_level_data()._level_elements.size() > num_level_elements)
+    {
+        _core.record_element_addition(_core.get_level_data()._level_elements.back().get());
     }
 
     update_draggable_to_level_element();
@@ -1483,6 +1565,7 @@ void Main_game_screen::change_renderer()
     _renderer = std::unique_ptr<World_renderer>(Parameter_registry<World_renderer>::get_class_from_single_select_instance_2(_parameters.get_child("Renderer")));
     _renderer->init(_viewer.context(), _viewer.size());
     _renderer->update(_core.get_level_data());
+    _renderer_background_name = _core.get_level_data()._background_name;
 }
 
 void Main_game_screen::change_speed_pressed()
@@ -1497,6 +1580,7 @@ void Main_game_screen::change_speed_pressed()
     }
 
     _core.get_parameters()["physics_speed"]->set_value(new_speed);
+    _core.record_parameter_change("physics_speed");
 }
 
 void Main_game_screen::resize(QSize const& size)
@@ -1504,6 +1588,7 @@ void Main_game_screen::resize(QSize const& size)
     _renderer->resize(size);
 
     _main_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
+    _main_fbo_memory.set(size_t(size.width()) * size_t(size.height()) * 2 * 4);
 
     GL_functions f;
     f.init();
@@ -1521,13 +1606,14 @@ void Main_game_screen::resize(QSize const& size)
 
 void Main_game_screen::handle_level_change(Main_game_screen::Level_state const level_state)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     // when changing to sandbox, the main game screen is still in the stack as it's in state Killing. But it
     // will still get signals and handle those events which can lead to crashes
     if (get_state() == State::Killing) return;
 
     _level_state = level_state;
+    _renderer_update_pending = true;
 
     clear_events();
     init_labels();
@@ -1543,7 +1629,7 @@ void Main_game_screen::handle_level_change(Main_game_screen::Level_state const l
         }
         else if (_core.get_level_base_name(_core.get_current_level_index()) == std::string("Intro 0"))
         {
-            std::cout << "Intro 0, adding tutorial events" << std::endl;
+            LOG_DEBUG("Intro 0, adding tutorial events");
             add_event(new Intro_event(_core, _viewer, *this));
             add_event(new Molecule_releaser_event(_core, _viewer, *this));
             add_event(new Intro_done_event(_core, _viewer, *this));
@@ -1551,7 +1637,7 @@ void Main_game_screen::handle_level_change(Main_game_screen::Level_state const l
         }
         else if (_core.get_level_base_name(_core.get_current_level_index()) == std::string("Intro 1"))
         {
-            std::cout << "Intro 1, adding tutorial events" << std::endl;
+            LOG_DEBUG("Intro 1, adding tutorial events");
             add_event(new Portal_event(_core, _viewer, *this));
             add_event(new Static_existing_heat_element_event(_core, _viewer, *this));
             add_event(new Heat_turned_up_event(_core, _viewer, *this));
@@ -1559,13 +1645,13 @@ void Main_game_screen::handle_level_change(Main_game_screen::Level_state const l
         }
         else if (_core.get_level_base_name(_core.get_current_level_index()) == std::string("Intro 2"))
         {
-            std::cout << "Intro 2, adding tutorial events" << std::endl;
+            LOG_DEBUG("Intro 2, adding tutorial events");
             add_event(new Movable_existing_heat_element_event(_core, _viewer, *this));
 //            _viewer.disable_camera_control();
         }
         else if (_core.get_level_base_name(_core.get_current_level_index()) == std::string("Level 1"))
         {
-            std::cout << "Level 1, adding tutorial events" << std::endl;
+            LOG_DEBUG("Level 1, adding tutorial events");
             add_event(new Heat_button_event(_core, _viewer, *this));
             add_event(new Heat_element_placed_event(_core, _viewer, *this));
         }
@@ -1584,7 +1670,7 @@ void Main_game_screen::handle_level_change(Main_game_screen::Level_state const l
 
 void Main_game_screen::handle_game_state_change()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     // check for killing when this state is started from the editor, otherwise the dying editor is being revived
     if (_core.get_game_state() == Core::Game_state::Running && get_state() != State::Killing)
@@ -1601,6 +1687,17 @@ void Main_game_screen::handle_game_state_change()
     }
 }
 
+void Main_game_screen::handle_level_elements_change()
+{
+    // the selected element may have been deleted
+    _selected_level_element = nullptr;
+    _selection = Selection::None;
+    _mouse_state = Mouse_state::None;
+
+    update_draggable_to_level_element();
+    update_active_draggables();
+}
+
 
 
 void Main_game_screen::setup_intro()
@@ -23,6 +23,7 @@ public:
     enum class Intro_state { Beginning, Single_molecule, Two_molecules_0, Two_molecules_1, Two_molecules_2, Two_molecules_3, Finishing, Finished };
 
     Main_game_screen(My_viewer & viewer, Core & core, Ui_state ui_state = Ui_state::Playing);
+    char const* get_name() const override { return "Main_game_screen"; }
 
     ~Main_game_screen();
 
@@ -68,6 +69,7 @@ public:
 public Q_SLOTS:
     void handle_level_change(Main_game_screen::Level_state);
     void handle_game_state_change();
+    void handle_level_elements_change();
 
     // Intro ---------------------
 protected Q_SLOTS:
@@ -101,6 +103,10 @@ protected:
     Ui_state _ui_state;
     Level_state _level_state;
 
+    // the renderer's level textures are updated on the next draw after a level change, not in the signal handler
+    bool _renderer_update_pending;
+    std::string _renderer_background_name;
+
     std::string _selected_level_element_button_type;
 
     IcoSphere<OpenMesh::Vec3f, Color> _icosphere;
@@ -131,6 +137,7 @@ protected:
     GLuint _settings_tex;
 
     std::unique_ptr<QGLFramebufferObject> _main_fbo;
+    Memory_account _main_fbo_memory;
     std::unique_ptr<QGLShaderProgram> _screen_quad_program;
     std::unique_ptr<QGLShaderProgram> _blur_program;
     std::unique_ptr<QGLShaderProgram> _drop_shadow_program;
@@ -7,6 +7,7 @@ class Main_menu_screen : public Menu_screen
 {
 public:
     Main_menu_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "Main_menu_screen"; }
 
     void draw() override;
 
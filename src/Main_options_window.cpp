@@ -1,15 +1,16 @@
 #include "Main_options_window.h"
 
 #include "Q_parameter_bridge.h"
+#include "Message_logger.h"
 
 
 QWidget *Main_options_window::add_parameter_list(const std::string &name, const Parameter_list &parameters)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     if (_param_group_to_widget_map.find(name) != _param_group_to_widget_map.end())
     {
-        std::cout << __FUNCTION__ << " widget already existed: " << name << std::endl;
+        LOG_DEBUG("widget already existed: " << name);
         remove_parameter_list(name);
     }
 
@@ -43,7 +44,7 @@ void Main_options_window::show()
 
 QFrame *Main_options_window::create_options_widget() const
 {
-    std::cout << "create_options_widget()" << std::endl;
+    LOG_DEBUG("create_options_widget()");
 
     QFrame * frame = new QFrame;
 
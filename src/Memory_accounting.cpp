@@ -0,0 +1,99 @@
+#include "Memory_accounting.h"
+
+
+Memory_accounting::Memory_accounting() :
+    _total_current(0),
+    _total_peak(0)
+{
+    for (int i = 0; i < Num_subsystems; ++i)
+    {
+        _current[i] = 0;
+        _peak[i] = 0;
+    }
+}
+
+Memory_accounting *Memory_accounting::get_instance()
+{
+    static Memory_accounting * const instance = new Memory_accounting;
+
+    return instance;
+}
+
+const char *Memory_accounting::get_name(const Memory_subsystem subsystem)
+{
+    static char const* const names[] = { "molecules", "atoms", "level_elements", "particle_systems", "sensor_data", "force_buffers", "gpu_force", "textures", "render_targets" };
+
+    static_assert(sizeof(names) / sizeof(names[0]) == int(Memory_subsystem::Num_subsystems), "missing subsystem name");
+
+    return names[int(subsystem)];
+}
+
+void Memory_accounting::add(const Memory_subsystem subsystem, const long long bytes)
+{
+    int const i = int(subsystem);
+
+    long long const current = (_current[i] += bytes);
+    long long const total = (_total_current += bytes);
+
+    if (bytes > 0)
+    {
+        update_peak(_peak[i], current);
+        update_peak(_total_peak, total);
+    }
+}
+
+long long Memory_accounting::get_current(const Memory_subsystem subsystem) const
+{
+    return _current[int(subsystem)];
+}
+
+long long Memory_accounting::get_peak(const Memory_subsystem subsystem) const
+{
+    return _peak[int(subsystem)];
+}
+
+long long Memory_accounting::get_total_current() const
+{
+    return _total_current;
+}
+
+long long Memory_accounting::get_total_peak() const
+{
+    return _total_peak;
+}
+
+void Memory_accounting::add_texture(const unsigned int id, const long long bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(_texture_mutex);
+        _texture_sizes[id] = bytes;
+    }
+
+    add(Memory_subsystem::Textures, bytes);
+}
+
+void Memory_accounting::remove_texture(const unsigned int id)
+{
+    long long bytes = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_texture_mutex);
+
+        auto iter = _texture_sizes.find(id);
+
+        if (iter == _texture_sizes.end()) return;
+
+        bytes = iter->second;
+        _texture_sizes.erase(iter);
+    }
+
+    add(Memory_subsystem::Textures, -bytes);
+}
+
+void Memory_accounting::update_peak(std::atomic<long long> &peak, const long long value)
+{
+    long long previous = peak.load();
+
+    while (value > previous && !peak.compare_exchange_weak(previous, value))
+    { }
+}
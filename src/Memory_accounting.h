@@ -0,0 +1,84 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Current and peak memory use per subsystem. The owners report their (estimated) sizes, nothing hooks the allocator:
+// Core samples the level data containers, GPU_force and the renderers report their buffers, textures and FBOs
+// from their sizes and formats, GL_functions registers the textures it creates.
+enum class Memory_subsystem { Molecules = 0, Atoms, Level_elements, Particle_systems, Sensor_data, Force_buffers, Gpu_force, Textures, Render_targets, Num_subsystems };
+
+
+class Memory_accounting
+{
+public:
+    static Memory_accounting * get_instance();
+
+    static char const* get_name(Memory_subsystem const subsystem);
+
+    // negative to release
+    void add(Memory_subsystem const subsystem, long long const bytes);
+
+    long long get_current(Memory_subsystem const subsystem) const;
+    long long get_peak(Memory_subsystem const subsystem) const;
+
+    long long get_total_current() const;
+    long long get_total_peak() const;
+
+    // textures are registered by id since they are deleted in many places without their size at hand
+    void add_texture(unsigned int const id, long long const bytes);
+    void remove_texture(unsigned int const id);
+
+private:
+    Memory_accounting();
+
+    static void update_peak(std::atomic<long long> & peak, long long const value);
+
+    static int const Num_subsystems = int(Memory_subsystem::Num_subsystems);
+
+    std::atomic<long long> _current[Num_subsystems];
+    std::atomic<long long> _peak[Num_subsystems];
+    std::atomic<long long> _total_current;
+    std::atomic<long long> _total_peak;
+
+    std::mutex _texture_mutex;
+    std::unordered_map<unsigned int, long long> _texture_sizes;
+};
+
+
+// the bytes one owner accounts to a subsystem, released on destruction
+class Memory_account
+{
+public:
+    explicit Memory_account(Memory_subsystem const subsystem) :
+        _subsystem(subsystem),
+        _bytes(0)
+    { }
+
+    ~Memory_account()
+    {
+        set(0);
+    }
+
+    void set(size_t const bytes)
+    {
+        if (bytes == _bytes) return;
+
+        Memory_accounting::get_instance()->add(_subsystem, (long long)(bytes) - (long long)(_bytes));
+        _bytes = bytes;
+    }
+
+    size_t get() const { return _bytes; }
+
+private:
+    Memory_account(Memory_account const&);
+    Memory_account & operator=(Memory_account const&);
+
+    Memory_subsystem _subsystem;
+    size_t _bytes;
+};
+
+#endif // MEMORY_ACCOUNTING_H
@@ -1,6 +1,7 @@
 #include "Menu_screen.h"
 
 #include "My_viewer.h"
+#include "Message_logger.h"
 
 #include <GL/gl.h>
 
@@ -154,7 +155,7 @@ bool Menu_screen::mouseMoveEvent(QMouseEvent * event)
         if (_hover_index != -1)
         {
             // stopped hovering over item
-            std::cout << __FUNCTION__ << " stopped hovering" << std::endl;
+            LOG_DEBUG("stopped hovering");
 
             _hover_index = -1;
 
@@ -166,7 +167,7 @@ bool Menu_screen::mouseMoveEvent(QMouseEvent * event)
             // entered new picked item
 
             _hover_index = new_picking_index;
-            std::cout << __FUNCTION__ << " started hovering" << std::endl;
+            LOG_DEBUG("started hovering");
 
             handled = true;
         }
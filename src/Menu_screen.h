@@ -13,6 +13,7 @@ class Menu_screen : public Screen
 {
 public:
     Menu_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "Menu_screen"; }
 
     void draw() override;
 
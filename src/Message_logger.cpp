@@ -1,5 +1,8 @@
 #include "Message_logger.h"
 
+#include <cstdlib>
+#include <iostream>
+
 #include <QtMessageHandler>
 
 void handle_message_func(QtMsgType type, const QMessageLogContext &context, const QString &msg)
@@ -7,75 +10,210 @@ void handle_message_func(QtMsgType type, const QMessageLogContext &context, cons
    Message_logger::get_instance()->handle_message(type, context, msg);
 }
 
-Message_logger * Message_logger::_instance = nullptr;
-
 void Message_logger::init(QString const& debug_file)
 {
+    // the writer uses the file, it starts again with the next message
+    stop_writer();
+
+    _log_file.open(debug_file.toStdString().c_str(), std::ios::out | std::ios::trunc);
+    _log_file << "initialized.\n";
+    _log_file.flush();
+
     _debug_mode = true;
 
-    _log_file = std::unique_ptr<QFile>(new QFile(debug_file));
-    _log_file->open(QIODevice::WriteOnly | QIODevice::Truncate);
+    qInstallMessageHandler(&handle_message_func);
+}
 
-    _log_stream.setDevice(_log_file.get());
+void Message_logger::shutdown()
+{
+    // set first, a message pushed meanwhile doesn't start a writer that nobody joins
+    _shut_down.store(true, std::memory_order_release);
 
-    _log_stream << "initialized.\n";
-    _log_stream.flush();
+    std::lock_guard<std::mutex> lock(_shut_down_mutex);
+    stop_writer();
+}
 
-    qInstallMessageHandler(&handle_message_func);
+void Message_logger::stop_writer()
+{
+    if (!_writer_running.load(std::memory_order_acquire)) return;
+
+    _stop.store(true, std::memory_order_release);
+    _writer_thread.join();
+
+    _writer_running.store(false, std::memory_order_release);
+    _stop.store(false, std::memory_order_release);
 }
 
 Message_logger *Message_logger::get_instance()
 {
-    if (!_instance)
+    // initialized once even when threads race for it, never destroyed so the last messages at exit still work
+    static Message_logger * const instance = new Message_logger;
+
+    return instance;
+}
+
+void Message_logger::log(const Log_level level, Log_site &site, const std::string &text)
+{
+    Message message;
+    message._level = level;
+    message._text = text.empty() ? std::string(site.get_function()) : std::string(site.get_function()) + " " + text;
+
+    int const num_suppressed = site.take_num_suppressed();
+
+    if (num_suppressed > 0)
     {
-        _instance = new Message_logger();
+        message._text += " (" + std::to_string(num_suppressed) + " repeated messages suppressed)";
     }
 
-    return _instance;
+    push(message);
 }
 
-
 void Message_logger::handle_message(QtMsgType type, QMessageLogContext const& context, QString const& msg)
 {
     if (!_debug_mode) return;
 
-    _mutex.lock();
+    Message message;
+    message._to_console = false;
+
+    std::ostringstream text;
+    std::string const location = std::string("File: ") + (context.file ? context.file : "") + " fnc: " + (context.function ? context.function : "") +
+            " line: " + std::to_string(context.line) + "\n";
+
     switch (type)
     {
     case QtDebugMsg:
     case QtInfoMsg:
-        _log_stream << "File: " << context.file << " fnc: " << context.function << " line: " << context.line << "\n";
-        _log_stream << msg;
-        _log_stream.flush();
+        message._level = (type == QtDebugMsg) ? Log_level::Debug : Log_level::Info;
+        text << location << msg.toStdString();
         break;
     case QtWarningMsg:
-        _log_stream << "\n*** Warning ***\n";
-        _log_stream << "File: " << context.file << " fnc: " << context.function << " line: " << context.line << "\n";
-        _log_stream << msg;
-        _log_stream << "\n*** Warning Complete ***\n";
-        _log_stream.flush();
+        message._level = Log_level::Warning;
+        text << "\n*** Warning ***\n" << location << msg.toStdString() << "\n*** Warning Complete ***";
         break;
     case QtCriticalMsg:
-        _log_stream << "\n*** Critical ***\n";
-        _log_stream << "File: " << context.file << " fnc: " << context.function << " line: " << context.line << "\n";
-        _log_stream << msg;
-        _log_stream << "\n*** Critical Complete ***\n";
-        _log_stream.flush();
+        message._level = Log_level::Critical;
+        text << "\n*** Critical ***\n" << location << msg.toStdString() << "\n*** Critical Complete ***";
         break;
     case QtFatalMsg:
-        _log_stream << "\n*** Fatal ***\n";
-        _log_stream << "File: " << context.file << " fnc: " << context.function << " line: " << context.line << "\n";
-        _log_stream << msg;
-        _log_stream << "\n*** Fatal Complete ***\n";
-        _log_stream.flush();
+        message._level = Log_level::Fatal;
+        text << "\n*** Fatal ***\n" << location << msg.toStdString() << "\n*** Fatal Complete ***";
+        break;
+    }
+
+    message._text = text.str();
+
+    push(message);
+
+    if (type == QtFatalMsg)
+    {
+        shutdown();
         abort();
     }
+}
+
+Message_logger::Message_logger() :
+    _queue(4096),
+    _writer_running(false),
+    _stop(false),
+    _shut_down(false),
+    _num_dropped_messages(0),
+    _debug_mode(false),
+    _min_level(int(Log_level::Debug))
+{
+
+}
+
+void Message_logger::push(Message &message)
+{
+    if (_shut_down.load(std::memory_order_acquire) ||
+            (!_writer_running.load(std::memory_order_acquire) && !start_writer()))
+    {
+        write_now(message);
+        return;
+    }
+
+    if (!_queue.push(message))
+    {
+        _num_dropped_messages.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool Message_logger::start_writer()
+{
+    // shutdown() can't join in between
+    std::lock_guard<std::mutex> lock(_shut_down_mutex);
+
+    if (_shut_down.load(std::memory_order_acquire)) return false;
+
+    // only the first caller starts it
+    bool expected = false;
+
+    if (_writer_running.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+    {
+        _writer_thread = std::thread(&Message_logger::write_messages, this);
+    }
+
+    return true;
+}
 
-    _mutex.unlock();
+void Message_logger::write_now(const Message &message)
+{
+    // after the writer has been joined, so the order stays
+    std::lock_guard<std::mutex> lock(_shut_down_mutex);
 
+    write(message);
+    std::cout << std::flush;
+    _log_file.flush();
 }
 
-Message_logger::Message_logger() : _debug_mode(false)
+void Message_logger::write_messages()
 {
+    Message message;
+    bool written = false;
 
+    while (true)
+    {
+        if (_queue.pop(message))
+        {
+            write(message);
+            written = true;
+        }
+        else if (_stop.load(std::memory_order_acquire))
+        {
+            while (_queue.pop(message))
+            {
+                write(message);
+            }
+
+            std::cout << std::flush;
+            _log_file.flush();
+
+            break;
+        }
+        else
+        {
+            // the queue ran empty: one flush for everything written since the last one
+            if (written)
+            {
+                std::cout << std::flush;
+                _log_file.flush();
+                written = false;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+void Message_logger::write(const Message &message)
+{
+    if (message._to_console)
+    {
+        std::cout << message._text << "\n";
+    }
+
+    if (_log_file.is_open())
+    {
+        _log_file << message._text << "\n";
+    }
 }
@@ -1,30 +1,146 @@
 #ifndef MESSAGE_LOGGER_H
 #define MESSAGE_LOGGER_H
 
-#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
 
-#include <QFile>
-#include <QTextStream>
-#include <QMutex>
+#include <QString>
+#include <QtGlobal>
 
+#include "Mpsc_queue.h"
+
+enum class Log_level { Debug = 0, Info, Warning, Error, Critical, Fatal };
+
+// One per call site (LOG_MESSAGE): a message that repeats the previous message of the site within its interval is only
+// counted, the next message that gets through reports how many were suppressed. Different messages always get through.
+class Log_site
+{
+public:
+    explicit Log_site(char const* function, float const min_interval_seconds = 1.0f) :
+        _function(function),
+        _min_interval_ns((long long)(min_interval_seconds * 1e9f)),
+        _last_hash(0),
+        _next_allowed_ns(0),
+        _num_suppressed(0)
+    { }
+
+    bool should_log(std::string const& text)
+    {
+        long long const now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        size_t const hash = std::hash<std::string>()(text);
+
+        if (_last_hash.exchange(hash, std::memory_order_relaxed) == hash && now < _next_allowed_ns.load(std::memory_order_relaxed))
+        {
+            _num_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _next_allowed_ns.store(now + _min_interval_ns, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    int take_num_suppressed()
+    {
+        return _num_suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    char const* get_function() const { return _function; }
+
+private:
+    char const* _function;
+    long long _min_interval_ns;
+    std::atomic<size_t> _last_hash;
+    std::atomic<long long> _next_allowed_ns;
+    std::atomic<int> _num_suppressed;
+};
+
+
+// Asynchronous log: callers only format the message and push it into a lock-free queue, a writer thread prints it
+// to std::cout and, after init(), writes it to the log file. The file is flushed when the queue runs empty instead
+// of after every message. When the queue is full messages are dropped and counted, callers never wait.
+// Qt messages (qDebug() etc.) go to the log file only, like before.
 class Message_logger
 {
 public:
     static Message_logger * get_instance();
 
+    // log file and Qt message handler
     void init(QString const& debug_file);
 
+    // writes everything queued so far and stops the writer for good, later messages are written by the caller
+    void shutdown();
+
+    void set_min_level(Log_level const level) { _min_level.store(int(level), std::memory_order_relaxed); }
+    bool is_enabled(Log_level const level) const { return int(level) >= _min_level.load(std::memory_order_relaxed); }
+
+    void log(Log_level const level, Log_site & site, std::string const& text);
+
     void handle_message(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 
+    unsigned long long get_num_dropped_messages() const { return _num_dropped_messages; }
+
 private:
     Message_logger();
 
-    static Message_logger * _instance;
+    struct Message
+    {
+        Message() : _level(Log_level::Info), _to_console(true) { }
 
-    std::unique_ptr<QFile> _log_file;
-    QTextStream _log_stream;
-    QMutex _mutex;
-    bool _debug_mode;
+        Log_level _level;
+        bool _to_console;
+        std::string _text;
+    };
+
+    void push(Message & message);
+    bool start_writer();
+    void stop_writer();
+    void write_now(Message const& message);
+    void write_messages();
+    void write(Message const& message);
+
+    Mpsc_queue<Message> _queue;
+    std::thread _writer_thread;
+    std::atomic<bool> _writer_running;
+    std::atomic<bool> _stop;
+    std::atomic<bool> _shut_down;
+    std::mutex _shut_down_mutex; // serializes the callers' writes after shutdown()
+
+    std::atomic<unsigned long long> _num_dropped_messages;
+
+    std::ofstream _log_file;
+    std::atomic<bool> _debug_mode;
+    std::atomic<int> _min_level;
 };
 
+// Logs "function: message" through the Message_logger, the message is streamed like into std::cout and only formatted
+// when its level is enabled. The same message from a call site is logged at most once per second.
+#define LOG_MESSAGE(level, message) \
+    do \
+    { \
+        static Log_site log_site(__FUNCTION__); \
+        if (Message_logger::get_instance()->is_enabled(level)) \
+        { \
+            std::ostringstream log_stream; \
+            log_stream << message; \
+            std::string const log_text = log_stream.str(); \
+            if (log_site.should_log(log_text)) \
+            { \
+                Message_logger::get_instance()->log(level, log_site, log_text); \
+            } \
+        } \
+    } while (false)
+
+#define LOG_DEBUG(message) LOG_MESSAGE(Log_level::Debug, message)
+#define LOG_INFO(message) LOG_MESSAGE(Log_level::Info, message)
+#define LOG_WARNING(message) LOG_MESSAGE(Log_level::Warning, message)
+#define LOG_ERROR(message) LOG_MESSAGE(Log_level::Error, message)
+
 #endif // MESSAGE_LOGGER_H
@@ -92,11 +92,12 @@ bool Molecule_releaser::check_do_release(const float time, bool const release_al
         _next_molecule = Molecule::create(_molecule_type);
 
         // get random position in the box (minus some margin), create molecule and give it a certain speed towards the release_axis
-        Eigen::Vector3f local_pos = _box.sample() * 0.8f;
+        Eigen::Vector3f const box_factors = (_random_generator.generate_vector() + Eigen::Vector3f::Ones()) * 0.5f;
+        Eigen::Vector3f local_pos = (_box.min() + _box.sizes().cwiseProduct(box_factors)) * 0.8f;
         local_pos[0] = _box.center()[0] + _box.sizes()[0] * 0.5f;
 
         _next_molecule._x = get_transform() * local_pos + get_position();
-        _next_molecule._P = get_transform() * Eigen::Vector3f(1.0f, 0.0f, 0.0f) * (4.0f + 4.0f * std::rand() / float(RAND_MAX));
+        _next_molecule._P = get_transform() * Eigen::Vector3f(1.0f, 0.0f, 0.0f) * (6.0f + 2.0f * _random_generator.generate());
 
         _next_molecule.update_atom_positions();
 
@@ -208,6 +209,11 @@ float Molecule_releaser::get_animation_count() const
     return _animation_count;
 }
 
+void Molecule_releaser::set_random_seed(const unsigned int seed)
+{
+    _random_generator.seed(seed);
+}
+
 void Molecule_releaser::get_corner_min_max(const Eigen::AlignedBox<float, 3>::CornerType cornertype, Eigen::Vector3f &min, Eigen::Vector3f &max) const
 {
     Eigen::Vector3f world_corner = get_transform() * _box.corner(cornertype) + get_position();
@@ -250,6 +256,48 @@ void Molecule_releaser::reset()
     _prepared_molecules.clear();
 }
 
+void Molecule_releaser::save_state(Checkpoint_buffer &buffer) const
+{
+    Level_element::save_state(buffer);
+
+    buffer.write(_last_release);
+    buffer.write(_num_released_molecules);
+    buffer.write(_animation_count);
+    buffer.write(_next_molecule_prepared);
+    buffer.write(_random_generator);
+
+    buffer.write(_prepared_molecules.size());
+
+    for (Molecule const& m : _prepared_molecules)
+    {
+        buffer.write_molecule(m);
+    }
+}
+
+void Molecule_releaser::load_state(Checkpoint_reader &reader)
+{
+    Level_element::load_state(reader);
+
+    reader.read(_last_release);
+    reader.read(_num_released_molecules);
+    reader.read(_animation_count);
+    reader.read(_next_molecule_prepared);
+    reader.read(_random_generator);
+
+    size_t num_prepared_molecules;
+    reader.read(num_prepared_molecules);
+
+    _prepared_molecules.clear();
+
+    for (size_t i = 0; i < num_prepared_molecules; ++i)
+    {
+        _prepared_molecules.push_back(reader.read_molecule());
+    }
+
+    // only the release animations, they restart with the next prepared molecule
+    _particles.clear();
+}
+
 Atom_cannon::Atom_cannon(const Eigen::Vector3f &min, const Eigen::Vector3f &max, const float first_release, const float interval, const float speed, const float charge) :
     Molecule_releaser(min, max, first_release, interval),
     _speed(speed),
@@ -273,7 +321,7 @@ Molecule Atom_cannon::release(const float time)
 
     m._atoms[0]._charge = _charge;
 
-    Eigen::Vector3f const random_pos = Eigen::Vector3f::Random();
+    Eigen::Vector3f const random_pos = _random_generator.generate_vector();
 
     Eigen::Vector3f const local_pos = _box.center() - Eigen::Vector3f(_box.sizes()[0] * 0.4f, random_pos[1] * 0.4f * _box.sizes()[1], 0.0f);
 
@@ -6,6 +6,7 @@
 #include "Level_element.h"
 
 #include "Atom.h"
+#include "Random_generator.h"
 
 class Molecule_releaser : public Level_element
 {
@@ -50,6 +51,9 @@ public:
 
     float get_animation_count() const;
 
+    // release positions and speeds, reseeded by Core for deterministic replays
+    void set_random_seed(unsigned int const seed);
+
     void get_corner_min_max(Eigen::AlignedBox<float, 3>::CornerType const cornertype, Eigen::Vector3f & min, Eigen::Vector3f & max) const;
 
     Eigen::AlignedBox<float, 3> get_world_aabb() const override;
@@ -58,6 +62,9 @@ public:
 
     void reset() override;
 
+    void save_state(Checkpoint_buffer & buffer) const override;
+    void load_state(Checkpoint_reader & reader) override;
+
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
     {
@@ -98,6 +105,8 @@ protected:
     float _particle_duration;
 
     float _animation_count;
+
+    Random_generator _random_generator;
 };
 
 BOOST_CLASS_VERSION(Molecule_releaser, 1)
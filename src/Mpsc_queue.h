@@ -0,0 +1,108 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded multi-producer single-consumer queue without locks: any number of threads call push(), exactly one
+// thread calls pop(). Neither blocks, push() fails when the queue is full and pop() when it is empty.
+// Every slot carries a sequence number that tells whether it is free for the producer of a position or filled for
+// the consumer, producers claim positions with a compare-and-swap on the tail.
+template<typename T>
+class Mpsc_queue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit Mpsc_queue(size_t const capacity) :
+        _slots(round_up_to_power_of_two(capacity)),
+        _mask(_slots.size() - 1),
+        _head(0),
+        _tail(0)
+    {
+        for (size_t i = 0; i < _slots.size(); ++i)
+        {
+            _slots[i]._sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // moves from item only on success
+    bool push(T & item)
+    {
+        size_t position = _tail.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot & slot = _slots[position & _mask];
+            size_t const sequence = slot._sequence.load(std::memory_order_acquire);
+
+            if (sequence == position)
+            {
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot._item = std::move(item);
+                    slot._sequence.store(position + 1, std::memory_order_release);
+
+                    return true;
+                }
+            }
+            else if (sequence < position)
+            {
+                return false; // full, the consumer hasn't freed the slot of the previous round
+            }
+            else
+            {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T & item)
+    {
+        size_t const position = _head.load(std::memory_order_relaxed);
+        Slot & slot = _slots[position & _mask];
+
+        if (slot._sequence.load(std::memory_order_acquire) != position + 1) return false;
+
+        item = std::move(slot._item);
+        slot._sequence.store(position + _mask + 1, std::memory_order_release);
+        _head.store(position + 1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+private:
+    Mpsc_queue(Mpsc_queue const&);
+    Mpsc_queue & operator=(Mpsc_queue const&);
+
+    static size_t round_up_to_power_of_two(size_t const capacity)
+    {
+        size_t size = 2;
+
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+
+        return size;
+    }
+
+    struct Slot
+    {
+        Slot() : _sequence(0) { }
+
+        std::atomic<size_t> _sequence;
+        T _item;
+    };
+
+    std::vector<Slot> _slots;
+    size_t _mask;
+
+    // padded apart, the consumer writes _head and the producers _tail
+    std::atomic<size_t> _head;
+    char _padding[64];
+    std::atomic<size_t> _tail;
+};
+
+#endif // MPSC_QUEUE_H
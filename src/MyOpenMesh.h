@@ -7,6 +7,8 @@
 #include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 
+#include "Message_logger.h"
+
 struct MyTraits : public OpenMesh::DefaultTraits
 {
     typedef OpenMesh::VectorT<float, 4> Color;
@@ -118,13 +120,11 @@ Mesh load_mesh(std::string const& filename, bool request_vertex_colors = false)
 //        }
 //    }
 
-    std::cout << "Mesh loaded: " << filename << " " <<
-                 "Vertices: " << mesh.n_vertices() << " " <<
-                 "Faces: "    << mesh.n_faces() << " " <<
-                 std::endl;
-
-    std::cout << "vnormals? " << mesh.has_vertex_normals() << std::endl;
-    std::cout << "vertex.texcoord2D? " << mesh.has_vertex_texcoords2D() << std::endl;
+    LOG_INFO("Mesh loaded: " << filename << " " <<
+             "Vertices: " << mesh.n_vertices() << " " <<
+             "Faces: "    << mesh.n_faces() << " " <<
+             "vnormals? " << mesh.has_vertex_normals() << " " <<
+             "vertex.texcoord2D? " << mesh.has_vertex_texcoords2D());
 
     return mesh;
 }
@@ -2,8 +2,15 @@
 
 #include "Experiment_screen.h"
 #include "Main_menu_screen.h"
+#include "Playback_screen.h"
 #include "Main_options_window.h"
 #include "Help_screen.h"
+#include "Profiler.h"
+#include "Message_logger.h"
+#include "Asset_preloader.h"
+#include "Texture_cache.h"
+
+#include <QDateTime>
 
 
 class Game_camera_constraint : public qglviewer::Constraint
@@ -27,7 +34,7 @@ private:
     float _box_size_half;
 };
 
-My_viewer::My_viewer(Core &core, const QGLFormat &format) : Options_viewer(format), _core(core)
+My_viewer::My_viewer(Core &core, const QGLFormat &format) : Options_viewer(format), _core(core), _time_to_first_frame(-1.0f)
 {
     std::function<void(void)> update = std::bind(static_cast<void (My_viewer::*)()>(&My_viewer::update), this);
 
@@ -64,10 +71,20 @@ My_viewer::My_viewer(Core &core, const QGLFormat &format) : Options_viewer(forma
     connect(&_core, SIGNAL(level_changed(Main_game_screen::Level_state)), this, SLOT(handle_level_change(Main_game_screen::Level_state)));
 }
 
+My_viewer::~My_viewer()
+{
+    makeCurrent();
+
+    GL_functions gl_functions;
+    gl_functions.init();
+
+    Texture_cache::get_instance()->clear(gl_functions);
+}
+
 void My_viewer::print_cam_orientation()
 {
     qglviewer::Vec axis = camera()->orientation().axis();
-    std::cout << "angle: " << camera()->orientation().angle() << " axis: " << axis[0] << ", " << axis[1] << ", " << axis[2] << " pos: " << QGLV2Eigen(camera()->position()) << std::endl;
+    LOG_DEBUG("angle: " << camera()->orientation().angle() << " axis: " << axis[0] << ", " << axis[1] << ", " << axis[2] << " pos: " << QGLV2Eigen(camera()->position()));
 }
 
 void My_viewer::setup_fonts()
@@ -82,14 +99,14 @@ void My_viewer::setup_fonts()
 }
 
 
-Eigen::Vector3f My_viewer::calc_camera_starting_point_from_borders()
+Eigen::Vector3f My_viewer::calc_camera_starting_point_from_borders(Level_data const& level_data)
 {
-    float const game_field_width_x = _core.get_level_data()._game_field_borders[Level_data::Plane::Pos_X]->get_position()[0]
-            - _core.get_level_data()._game_field_borders[Level_data::Plane::Neg_X]->get_position()[0];
-    float const game_field_width_y = _core.get_level_data()._game_field_borders[Level_data::Plane::Pos_Y]->get_position()[1]
-            - _core.get_level_data()._game_field_borders[Level_data::Plane::Neg_Y]->get_position()[1];
-    float const game_field_width_z = _core.get_level_data()._game_field_borders[Level_data::Plane::Pos_Z]->get_position()[2]
-            - _core.get_level_data()._game_field_borders[Level_data::Plane::Neg_Z]->get_position()[2];
+    float const game_field_width_x = level_data._game_field_borders[Level_data::Plane::Pos_X]->get_position()[0]
+            - level_data._game_field_borders[Level_data::Plane::Neg_X]->get_position()[0];
+    float const game_field_width_y = level_data._game_field_borders[Level_data::Plane::Pos_Y]->get_position()[1]
+            - level_data._game_field_borders[Level_data::Plane::Neg_Y]->get_position()[1];
+    float const game_field_width_z = level_data._game_field_borders[Level_data::Plane::Pos_Z]->get_position()[2]
+            - level_data._game_field_borders[Level_data::Plane::Neg_Z]->get_position()[2];
 
     float const margin = 25.0f;
 
@@ -109,14 +126,19 @@ Eigen::Vector3f My_viewer::calc_camera_starting_point_from_borders()
 
 void My_viewer::update_game_camera()
 {
-    float const z = 0.5f * (_core.get_level_data()._game_field_borders[Level_data::Plane::Pos_Z]->get_position()[2]
-            + _core.get_level_data()._game_field_borders[Level_data::Plane::Neg_Z]->get_position()[2]);
+    update_camera_for_level(_core.get_level_data());
+}
+
+void My_viewer::update_camera_for_level(const Level_data &level_data)
+{
+    float const z = 0.5f * (level_data._game_field_borders[Level_data::Plane::Pos_Z]->get_position()[2]
+            + level_data._game_field_borders[Level_data::Plane::Neg_Z]->get_position()[2]);
 
     //        _my_camera->setUpVector(qglviewer::Vec(0.0f, 0.0f, 1.0f));
     //        _my_camera->setViewDirection(qglviewer::Vec(0.0f, 1.0f, 0.0f));
     //        _my_camera->setPosition(qglviewer::Vec(0.0f, -80.0f, z));
 
-    Eigen::Vector3f cam_start_position = calc_camera_starting_point_from_borders();
+    Eigen::Vector3f cam_start_position = calc_camera_starting_point_from_borders(level_data);
 
     qglviewer::Vec position(0.0f, cam_start_position[1], z);
 
@@ -145,7 +167,7 @@ void My_viewer::change_clipping()
 
 void My_viewer::init()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     bool const opengl_initialized = initializeOpenGLFunctions();
 
@@ -190,8 +212,8 @@ void My_viewer::init()
     const GLubyte* opengl_version = glGetString(GL_VERSION);
     const GLubyte* shader_version = glGetString(GL_SHADING_LANGUAGE_VERSION);
 
-    std::cout << __FUNCTION__ << " opengl version: " << opengl_version << std::endl;
-    std::cout << __FUNCTION__ << " shader version: " << shader_version << std::endl;
+    LOG_INFO("opengl version: " << opengl_version);
+    LOG_INFO("shader version: " << shader_version);
 
     glEnable(GL_TEXTURE_2D);
 
@@ -200,6 +222,8 @@ void My_viewer::init()
 
 void My_viewer::start()
 {
+    PROFILE_ZONE("My_viewer::start");
+
     restore_parameters();
 
     setAnimationPeriod(16);
@@ -223,28 +247,87 @@ void My_viewer::start()
 //    add_screen(Help_screen::test(*this, _core)); // DEBUG screen
 }
 
+void My_viewer::start_input_replay(const std::string &file_name)
+{
+    for (std::unique_ptr<Screen> const& s : _screen_stack)
+    {
+        if (dynamic_cast<Main_menu_screen*>(s.get()))
+        {
+            s->kill();
+        }
+    }
 
-void My_viewer::draw()
+    // the game screen resumes when the replayed level starts
+    _core.start_input_replay(file_name);
+}
+
+
+bool My_viewer::start_trajectory_playback(const std::string &file_name)
 {
-    std::vector<Screen*> reverse_screens;
+    std::unique_ptr<Playback_screen> screen(new Playback_screen(*this, _core));
+
+    if (!screen->open(file_name)) return false;
 
     for (std::unique_ptr<Screen> const& s : _screen_stack)
     {
-        if (s->get_state() == Screen::State::Killed) continue;
+        if (dynamic_cast<Main_menu_screen*>(s.get()))
+        {
+            s->kill();
+        }
+    }
+
+    add_screen(screen.release());
+
+    return true;
+}
+
+
+void My_viewer::draw()
+{
+    PROFILE_ZONE("My_viewer::draw");
+
+    float render_milliseconds = 0.0f;
+
+    {
+        Scoped_timer const render_timer(render_milliseconds);
 
-        reverse_screens.push_back(s.get());
+        std::vector<Screen*> reverse_screens;
 
-        if (int(s->get_type()) & int(Screen::Type::Fullscreen))
+        for (std::unique_ptr<Screen> const& s : _screen_stack)
         {
-            break;
+            if (s->get_state() == Screen::State::Killed) continue;
+
+            reverse_screens.push_back(s.get());
+
+            if (int(s->get_type()) & int(Screen::Type::Fullscreen))
+            {
+                break;
+            }
         }
-    }
 
-    std::reverse(reverse_screens.begin(), reverse_screens.end());
+        std::reverse(reverse_screens.begin(), reverse_screens.end());
+
+        for (Screen * s : reverse_screens)
+        {
+            s->draw();
+        }
+
+        if (_time_to_first_frame < 0.0f && !reverse_screens.empty())
+        {
+            // waits once for the GPU so the time includes the first frame's rendering, not only issuing it
+            glFinish();
+
+            _time_to_first_frame = Asset_preloader::get_instance()->get_time_since_start();
+            _performance_hud.set_time_to_first_frame(_time_to_first_frame);
 
-    for (Screen * s : reverse_screens)
+            LOG_INFO("Time to first frame: " << _time_to_first_frame << " ms");
+        }
+    }
+
+    if (_performance_hud.is_visible())
     {
-        s->draw();
+        _performance_hud.add_frame(render_milliseconds);
+        _performance_hud.draw(*this, _core, _ui_renderer);
     }
 }
 
@@ -582,14 +665,15 @@ void My_viewer::keyPressEvent(QKeyEvent *event)
     if (event->key() == Qt::Key_S && !(event->modifiers() & Qt::ControlModifier) &&
             !(event->modifiers() & Qt::ShiftModifier))
     {
-        std::cout << __FUNCTION__ << " Screen Stack" << std::endl;
+        std::ostringstream screen_stack;
 
         for (std::unique_ptr<Screen> const& s : _screen_stack)
         {
-            Screen const& screenRef = *(s.get());
-            std::cout << typeid(screenRef).name() << " state: " << int(s->get_state()) << " ptr: " << s.get() << std::endl;
+            screen_stack << "\n" << s->get_name() << " state: " << int(s->get_state()) << " ptr: " << s.get();
         }
 
+        LOG_DEBUG("Screen Stack" << screen_stack.str());
+
         handled = true;
     }
     else if (event->key() == Qt::Key_O)
@@ -604,9 +688,21 @@ void My_viewer::keyPressEvent(QKeyEvent *event)
 
         handled = true;
     }
+    else if (event->key() == Qt::Key_F8)
+    {
+        _performance_hud.set_visible(!_performance_hud.is_visible());
+
+        handled = true;
+    }
+    else if (event->key() == Qt::Key_F9)
+    {
+        toggle_profiling();
+
+        handled = true;
+    }
     else if (event->key() == Qt::Key_F10)
     {
-        std::cout << __func__ << " core.gl_init()" << std::endl;
+        LOG_DEBUG("core.gl_init()");
 
         _core.gl_init(context());
 
@@ -642,6 +738,30 @@ void My_viewer::wheelEvent(QWheelEvent * event)
     }
 }
 
+void My_viewer::toggle_profiling()
+{
+    Profiler * profiler = Profiler::get_instance();
+
+    if (!Profiler::is_compiled_in())
+    {
+        LOG_INFO("Profiling not compiled in, build with CONFIG+=profiling");
+        return;
+    }
+
+    if (!profiler->is_enabled())
+    {
+        LOG_INFO("Profiling started");
+        profiler->set_enabled(true);
+    }
+    else
+    {
+        profiler->set_enabled(false);
+
+        QString const file_name = QString("trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+        profiler->export_chrome_trace(file_name.toStdString());
+    }
+}
+
 void My_viewer::animate()
 {
 //    float const time_step = _frame_timer.restart() / 1000.0f;
@@ -650,6 +770,9 @@ void My_viewer::animate()
 
 //    _core.update_level_elements(time_step);
 
+    // frame boundary, a level loaded in the background replaces the current one before the screens see it
+    _core.finish_level_loading();
+
     _screen_stack.erase(std::remove_if(_screen_stack.begin(), _screen_stack.end(), Screen::is_dead), _screen_stack.end());
 
     for (std::unique_ptr<Screen> const& s : _screen_stack)
@@ -751,6 +874,7 @@ void My_viewer::resizeEvent(QResizeEvent *ev)
     glViewport(0, 0, ev->size().width(), ev->size().height());
 
     _ui_renderer.resize(ev->size());
+    _performance_hud.resize();
 
     for (std::unique_ptr<Screen> const& screen : _screen_stack)
     {
@@ -759,8 +883,8 @@ void My_viewer::resizeEvent(QResizeEvent *ev)
 
     if (camera()->screenHeight() != ev->size().height())
     {
-        std::cout << __FUNCTION__ << " size mismatch: " << camera()->screenWidth() << " " << ev->size().width() << std::endl;
-        std::cout << __FUNCTION__ << " size mismatch: " << camera()->screenHeight() << " " << ev->size().height() << std::endl;
+        LOG_DEBUG("size mismatch: " << camera()->screenWidth() << " " << ev->size().width());
+        LOG_DEBUG("size mismatch: " << camera()->screenHeight() << " " << ev->size().height());
 
 //        assert(false);
     }
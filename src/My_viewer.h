@@ -18,6 +18,7 @@
 #include "Renderer.h"
 #include "Screen.h"
 #include "Main_game_screen.h"
+#include "Performance_hud.h"
 
 
 class My_viewer : public Options_viewer, public QOpenGLFunctions_3_3_Core
@@ -28,18 +29,25 @@ public:
     typedef Options_viewer Base;
 
     My_viewer(Core & core, QGLFormat const& format = QGLFormat());
+    // deletes the cached textures while their context still exists
+    ~My_viewer() override;
 
     void print_cam_orientation();
 
-    Eigen::Vector3f calc_camera_starting_point_from_borders();
+    Eigen::Vector3f calc_camera_starting_point_from_borders(Level_data const& level_data);
 
     void update_game_camera();
+    void update_camera_for_level(Level_data const& level_data);
 
     void change_clipping();
 
     void init() override;
 
     void start();
+    // replaces the main menu by the replayed level, see Core::start_input_replay()
+    void start_input_replay(std::string const& file_name);
+    // replaces the main menu by a Playback_screen, false when the file can't be read
+    bool start_trajectory_playback(std::string const& file_name);
 
     void draw() override;
 
@@ -83,6 +91,9 @@ public:
 
     void quit_game();
 
+    // F9: starts a profiler capture or stops it and writes it as a Chrome trace into the working directory
+    void toggle_profiling();
+
     Ui_renderer const& get_renderer() const;
     Ui_renderer & get_renderer();
 
@@ -108,7 +119,11 @@ private:
 
     Ui_renderer _ui_renderer;
 
+    Performance_hud _performance_hud;
+
     QElapsedTimer _frame_timer;
+
+    float _time_to_first_frame; // ms since Asset_preloader::start(), negative until the first frame was drawn
 };
 
 
@@ -22,6 +22,7 @@
 #include "GL_utilities.h"
 #include "Decal.h"
 #include "Geometry_utils.h"
+#include "Message_logger.h"
 
 //#ifdef __APPLE__
 #define USE_EXTERNAL_OPTIONS_WINDOW
@@ -120,7 +121,7 @@ public:
 
     void resizeEvent(QResizeEvent * ev) override
     {
-        std::cout << __FUNCTION__ << std::endl;
+        LOG_DEBUG("");
 
         QRect hidden_rect  = QRect(-width(), 0, width(), height());
         QRect visible_rect = QRect(       0, 0, width(), height());
@@ -136,13 +137,13 @@ public:
 
     void childEvent(QChildEvent *) override
     {
-        std::cout << __FUNCTION__ << " Flyin_widget::childEvent();" << std::endl;
+        LOG_DEBUG("Flyin_widget::childEvent();");
     }
 
 public Q_SLOTS:
     void widget_event(QChildEvent *)
     {
-        std::cout << __FUNCTION__ << std::endl;
+        LOG_DEBUG("");
     }
 
 Q_SIGNALS:
@@ -230,7 +231,7 @@ public:
         }
         else
         {
-            std::cout << __func__ << " Couldn't load at least one font." << std::endl;
+            LOG_WARNING("Couldn't load at least one font.");
         }
     }
 
@@ -301,7 +302,7 @@ protected:
             direction = -1.0f;
         }
 
-        std::cout << rotation_axis_index << " " << direction << std::endl;
+        LOG_DEBUG(rotation_axis_index << " " << direction);
 
         float rotation_amount = 0.01 * direction;
         float rotation = 2 * M_PI * rotation_amount;
@@ -362,11 +363,11 @@ protected:
 
             img.save(filename);
 
-            std::cout << __FUNCTION__ << " shot saved to " << filename.toStdString() << std::endl;
+            LOG_INFO("shot saved to " << filename.toStdString());
 
             if (event->modifiers() & Qt::ShiftModifier)
             {
-                std::cout << "Starting gimp ..." << std::endl;
+                LOG_INFO("Starting gimp ...");
 
                 QProcess process;
                 QStringList arguments;
@@ -475,12 +476,12 @@ protected:
 
     virtual void load_defaults()
     {
-        std::cout << __func__ << " No default function specified." << std::endl;
+        LOG_WARNING("No default function specified.");
     }
 
     QFrame * create_options_widget() const
     {
-        std::cout << "create_options_widget()" << std::endl;
+        LOG_DEBUG("create_options_widget()");
 
         QFrame * frame = new QFrame;
 
@@ -556,7 +557,7 @@ protected:
 
     void resizeEvent(QResizeEvent * ev) override
     {
-        std::cout << __FUNCTION__ << std::endl;
+        LOG_DEBUG("");
 
 #ifndef USE_EXTERNAL_OPTIONS_WINDOW
         _menu_frame->setFixedHeight(height());
@@ -572,7 +573,7 @@ protected:
         // std::cout << "mouseMoveEvent(); " << ev->x() << " " << ev->y() << std::endl;
         if (ev->pos().x() < 20)
         {
-            std::cout << "Options_viewer::mouseMoveEvent() in zone" << std::endl;
+            LOG_DEBUG("Options_viewer::mouseMoveEvent() in zone");
 
             if (!_menu_frame)
             {
@@ -590,7 +591,7 @@ protected:
 
     virtual bool show_context_menu(const QPoint& /* pos */)
     {
-        std::cout << __func__ << " Got no context menu." << std::endl;
+        LOG_WARNING("Got no context menu.");
         return false;
     }
 
@@ -1,13 +1,113 @@
 #include "Parameter.h"
 
+#include "Message_logger.h"
+
 #ifndef Q_MOC_RUN
-#include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/serialization/nvp.hpp>
 #endif
 
+#include <cstring>
+#include <stdexcept>
+
 #include <QFileInfo>
 
+
+namespace
+{
+char const Parameter_list_magic[8] = { 'P', 'A', 'R', 'T', 'P', 'R', 'M', '\0' };
+unsigned int const Parameter_list_format_version = 2;
+// values are written in the native byte order, a file from a machine with the other one is rejected
+unsigned int const Parameter_list_byte_order_tag = 0x01020304;
+
+template<typename T>
+void write_value(std::ostream & out, T const& value)
+{
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+void write_string(std::ostream & out, std::string const& value)
+{
+    write_value(out, (unsigned int)(value.size()));
+    out.write(value.data(), std::streamsize(value.size()));
+}
+
+template<typename T>
+T read_value(std::istream & in)
+{
+    T value;
+
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        throw std::runtime_error("Truncated parameter data");
+    }
+
+    return value;
+}
+
+std::string read_string(std::istream & in)
+{
+    unsigned int const size = read_value<unsigned int>(in);
+
+    std::string value(size, '\0');
+
+    if (size > 0 && !in.read(&value[0], std::streamsize(size)))
+    {
+        throw std::runtime_error("Truncated parameter data");
+    }
+
+    return value;
+}
+
+bool has_binary_magic(std::istream & in)
+{
+    char magic[sizeof(Parameter_list_magic)];
+
+    bool const result = in.read(magic, sizeof(magic)) && std::memcmp(magic, Parameter_list_magic, sizeof(magic)) == 0;
+
+    in.clear();
+    in.seekg(0);
+
+    return result;
+}
+}
+
+
+thread_local int Parameter_batch::_depth = 0;
+thread_local std::vector< std::pair<void const*, Parameter_callback> > Parameter_batch::_pending;
+
+Parameter_batch::~Parameter_batch()
+{
+    if (--_depth > 0) return;
+
+    // callbacks may change parameters again, those are called directly
+    std::vector< std::pair<void const*, Parameter_callback> > pending;
+    pending.swap(_pending);
+
+    for (auto const& p : pending)
+    {
+        p.second();
+    }
+}
+
+void Parameter_batch::call(const Parameter_callback &callback, const void *parameter)
+{
+    if (_depth == 0)
+    {
+        callback();
+        return;
+    }
+
+    void const* const id = callback.get_id() ? callback.get_id() : parameter;
+
+    for (auto const& p : _pending)
+    {
+        if (p.first == id) return;
+    }
+
+    _pending.push_back(std::make_pair(id, callback));
+}
+
 std::type_info const& Parameter::get_type() const
 {
     return _value.type();
@@ -43,7 +143,7 @@ void Parameter::set_from_index(int index)
 {
     _index = index;
     _value = _value_list[_index];
-    if (_callback_on_change) _callback_on_change();
+    do_callback();
     notify_observers();
 }
 
@@ -84,7 +184,7 @@ void Parameter_list::load(std::map<std::string, Parameter *> &list, const std::m
 
         if (iter == list.end())
         {
-            std::cout << "Parameter_list::load(): No such parameter: " << param_name << std::endl;
+            LOG_WARNING("Parameter_list::load(): No such parameter: " << param_name);
         }
         else
         {
@@ -103,7 +203,7 @@ void Parameter_list::load(std::map<std::string, Parameter *> &list, const std::m
 
         if (iter == children.end())
         {
-            std::cout << "Parameter_list::load(): No such child: " << param_list_name << std::endl;
+            LOG_WARNING("Parameter_list::load(): No such child: " << param_list_name);
         }
         else
         {
@@ -118,6 +218,8 @@ void Parameter_list::load(std::map<std::string, Parameter *> &list, const std::m
 
 void Parameter_list::load(const Parameter_list &tmp_param_list)
 {
+    Parameter_batch batch;
+
     load(_list, tmp_param_list._list, _children, tmp_param_list._children);
     tmp_param_list.print();
 }
@@ -129,8 +231,7 @@ const Parameter_list *Parameter_list::get_child(const std::string &name) const
 
     if (iter == _children.end())
     {
-        std::cout << "Parameter_list::get_child_helper(): child not found: " << name << std::endl;
-        std::cout << "Available: " << std::endl;
+        LOG_WARNING("Parameter_list::get_child_helper(): child not found: " << name << ", available:");
         print();
 
         assert(false);
@@ -146,6 +247,7 @@ void Parameter_list::add_child(const std::string &name, Parameter_list *list)
     assert(iter == _children.end()); // make sure name doesn't exist yet
 
     _children[name] = list;
+    ++_generation;
 }
 
 const Parameter *Parameter_list::get_parameter(const std::string &name) const
@@ -158,7 +260,7 @@ const Parameter *Parameter_list::get_parameter(const std::string &name) const
 
         if (iter == _list.end())
         {
-            std::cout << "Parameter_list[]: No such parameter: " << name << std::endl;
+            LOG_WARNING("Parameter_list[]: No such parameter: " << name);
             assert(false);
         }
 
@@ -180,12 +282,23 @@ void Parameter_list::add_parameter(const std::string &id, Parameter *new_paramet
 
     new_parameter->set_order_index(int(_list.size()));
     _list[id] = new_parameter;
+    ++_generation;
+}
+
+Parameter_list &Parameter_list::operator=(const Parameter_list &other)
+{
+    _list = other._list;
+    _children = other._children;
+    _children_type = other._children_type;
+    ++_generation;
+    return *this;
 }
 
 void Parameter_list::add_parameter_keep_order(const std::string &id, Parameter *new_parameter)
 {
     assert(_list.find(id) == _list.end()); // make sure no parameter of that name already exists
     _list[id] = new_parameter;
+    ++_generation;
 }
 
 std::vector<const Parameter *> Parameter_list::get_ordered() const
@@ -213,10 +326,11 @@ Parameter_list *Parameter_list::add_child(const std::string &name, const Paramet
     Parameter_list *& list = _children[name];
     list = new Parameter_list;
     list->_children_type = type;
+    ++_generation;
     return list;
 }
 
-void Parameter_list::set_children_callback_function(Parameter_list::Child_map &children, std::function<void ()> update_function)
+void Parameter_list::set_children_callback_function(Parameter_list::Child_map &children, Parameter_callback const& update_function)
 {
     Child_map::const_iterator child_iter;
 
@@ -235,7 +349,7 @@ void Parameter_list::set_children_callback_function(Parameter_list::Child_map &c
     }
 }
 
-void Parameter_list::append(const Parameter_list &parameter_list, std::function<void ()> update_function)
+void Parameter_list::append(const Parameter_list &parameter_list, Parameter_callback const& update_function)
 {
     Parameter_list::const_iterator iter;
 
@@ -256,6 +370,7 @@ void Parameter_list::append(const Parameter_list &parameter_list, std::function<
         assert(_children.find(child_iter->first) == _children.end());
 
         _children[child_iter->first] = new Parameter_list(*child_iter->second);
+        ++_generation;
     }
 
     set_children_callback_function(_children, update_function);
@@ -263,55 +378,181 @@ void Parameter_list::append(const Parameter_list &parameter_list, std::function<
 
 void Parameter_list::print() const
 {
+    std::ostringstream text;
+
     std::map<std::string, Parameter*>::const_iterator iter;
 
     for (iter = _list.begin(); iter != _list.end(); ++iter)
     {
-        std::cout << iter->first << ": " << iter->second->to_string() << std::endl;
+        text << "\n" << iter->first << ": " << iter->second->to_string();
     }
+
+    LOG_DEBUG(text.str());
 }
 
 void Parameter_list::save(const std::string &file_name) const
 {
-    std::cout << __FUNCTION__ << " " << file_name << std::endl;
+    LOG_DEBUG(file_name);
 
     std::ofstream out_file(file_name.c_str(), std::ios_base::binary);
-//    boost::archive::text_oarchive oa(out_file);
 
     if (out_file)
     {
-        boost::archive::xml_oarchive oa(out_file);
+        save_binary(out_file);
+    }
+}
 
-        //        std::cout << "Parameter_list::save: " << out_file << std::endl;
+void Parameter_list::load(const std::string &file_name)
+{
+    std::ifstream in_file(file_name.c_str(), std::ios_base::binary);
 
-        QFileInfo f_info(QString::fromStdString(file_name));
-        oa << boost::serialization::make_nvp(f_info.fileName().toLocal8Bit(), *this);
+    if (!in_file)
+    {
+        LOG_WARNING("Parameter file not found");
+        return;
+    }
 
-        out_file.close();
+    if (has_binary_magic(in_file))
+    {
+        load_binary(in_file);
+        return;
     }
+
+    // XML archive, written before the binary format and still used for the shipped defaults
+    boost::archive::xml_iarchive ia(in_file);
+
+    Parameter_list tmp_param_list;
+
+    QFileInfo f_info(QString::fromStdString(file_name));
+    ia >> boost::serialization::make_nvp(f_info.fileName().toLocal8Bit(), tmp_param_list);
+
+    load(tmp_param_list);
 }
 
-void Parameter_list::load(const std::string &file_name)
+void Parameter_list::save_binary(std::ostream &out) const
 {
-    std::ifstream in_file(file_name.c_str(), std::ios_base::binary);
+    out.write(Parameter_list_magic, sizeof(Parameter_list_magic));
+    write_value(out, Parameter_list_byte_order_tag);
+    write_value(out, Parameter_list_format_version);
+
+    write_binary(out);
+}
 
-    if (in_file)
+void Parameter_list::load_binary(std::istream &in)
+{
+    char magic[sizeof(Parameter_list_magic)];
+
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, Parameter_list_magic, sizeof(magic)) != 0)
     {
-//        boost::archive::text_iarchive ia(in_file);
-        boost::archive::xml_iarchive ia(in_file);
+        throw std::runtime_error("Not a binary parameter list");
+    }
 
-        Parameter_list tmp_param_list;
-//        ia >> tmp_param_list;
+    if (read_value<unsigned int>(in) != Parameter_list_byte_order_tag)
+    {
+        throw std::runtime_error("Parameter list written with a different byte order or an older format");
+    }
+
+    unsigned int const version = read_value<unsigned int>(in);
+
+    if (version != Parameter_list_format_version)
+    {
+        throw std::runtime_error("Unsupported parameter list format version " + std::to_string(version));
+    }
+
+    Parameter_batch batch;
 
-        QFileInfo f_info(QString::fromStdString(file_name));
-        ia >> boost::serialization::make_nvp(f_info.fileName().toLocal8Bit(), tmp_param_list);
+    read_binary(in, this);
+}
 
-        load(tmp_param_list);
+void Parameter_list::write_binary(std::ostream &out) const
+{
+    write_value(out, (unsigned int)(_list.size()));
 
-        in_file.close();
+    for (auto const& iter : _list)
+    {
+        write_string(out, iter.first);
+
+        Parameter::My_variant const& value = iter.second->get_variant();
+        write_value(out, (unsigned char)(value.which()));
+
+        switch (value.which())
+        {
+        case 0: write_value(out, (unsigned char)(boost::get<bool>(value))); break;
+        case 1: write_value(out, boost::get<float>(value)); break;
+        case 2: write_value(out, boost::get<int>(value)); break;
+        case 3: write_string(out, boost::get<std::string>(value)); break;
+        }
+
+        write_value(out, iter.second->get_index());
     }
-    else
+
+    write_value(out, (unsigned int)(_children.size()));
+
+    for (auto const& iter : _children)
+    {
+        write_string(out, iter.first);
+        iter.second->write_binary(out);
+    }
+}
+
+void Parameter_list::read_binary(std::istream &in, Parameter_list *list)
+{
+    unsigned int const num_parameters = read_value<unsigned int>(in);
+
+    for (unsigned int i = 0; i < num_parameters; ++i)
+    {
+        std::string const name = read_string(in);
+
+        Parameter::My_variant value;
+
+        switch (read_value<unsigned char>(in))
+        {
+        case 0: value = bool(read_value<unsigned char>(in)); break;
+        case 1: value = read_value<float>(in); break;
+        case 2: value = read_value<int>(in); break;
+        case 3: value = read_string(in); break;
+        default: throw std::runtime_error("Unknown type of parameter " + name);
+        }
+
+        int const index = read_value<int>(in);
+
+        if (!list) continue;
+
+        std::map<std::string, Parameter*>::iterator iter = list->_list.find(name);
+
+        if (iter == list->_list.end())
+        {
+            LOG_WARNING("Parameter_list::load(): No such parameter: " << name);
+        }
+        else
+        {
+            iter->second->set_variant(value);
+            iter->second->set_index(index);
+        }
+    }
+
+    unsigned int const num_children = read_value<unsigned int>(in);
+
+    for (unsigned int i = 0; i < num_children; ++i)
     {
-        std::cout << "Parameter file not found" << std::endl;
+        std::string const name = read_string(in);
+
+        Parameter_list * child = nullptr;
+
+        if (list)
+        {
+            Child_map::iterator iter = list->_children.find(name);
+
+            if (iter == list->_children.end())
+            {
+                LOG_WARNING("Parameter_list::load(): No such child: " << name);
+            }
+            else
+            {
+                child = iter->second;
+            }
+        }
+
+        read_binary(in, child);
     }
 }
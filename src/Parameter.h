@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 
 
@@ -30,6 +32,58 @@
 #include <boost/variant.hpp>
 #endif
 
+#include "Message_logger.h"
+
+// Change callback of a parameter. Parameters sharing an update function pass the same id (usually the owner of the
+// function) so a Parameter_batch calls it once, callbacks without an id are called once per changed parameter.
+class Parameter_callback
+{
+public:
+    Parameter_callback() : _id(nullptr) {}
+
+    template <class F, class = typename std::enable_if<std::is_convertible<F, std::function<void()> >::value &&
+                                                       !std::is_same<typename std::decay<F>::type, Parameter_callback>::value>::type>
+    Parameter_callback(F const& function, void const* id = nullptr) :
+        _function(function),
+        _id(id)
+    {}
+
+    void operator() () const { _function(); }
+
+    explicit operator bool() const { return bool(_function); }
+
+    void const* get_id() const { return _id; }
+
+private:
+    std::function<void()> _function;
+    void const* _id;
+};
+
+
+// Defers the parameter change callbacks while at least one batch exists: loading a list or dragging a slider sets many
+// parameters, their update functions then run once when the outermost batch ends, in the order of the first change.
+// The batch state is per thread: a batch only defers the changes made on its own thread, lists built on the
+// level loading thread call their callbacks directly.
+class Parameter_batch
+{
+public:
+    Parameter_batch() { ++_depth; }
+    ~Parameter_batch();
+
+    static bool is_active() { return _depth > 0; }
+
+    // calls the callback or queues it unless a callback with the same id (or of the same parameter) is queued
+    static void call(Parameter_callback const& callback, void const* parameter);
+
+private:
+    Parameter_batch(Parameter_batch const&);
+    Parameter_batch & operator=(Parameter_batch const&);
+
+    static thread_local int _depth;
+    static thread_local std::vector< std::pair<void const*, Parameter_callback> > _pending;
+};
+
+
 class Notifiable
 {
 public:
@@ -48,7 +102,7 @@ public:
 
     Parameter() : _hidden(false) {}
 
-    Parameter(std::string const& name, bool const& value, std::function<void()> callback_on_change = std::function<void()>()) :
+    Parameter(std::string const& name, bool const& value, Parameter_callback callback_on_change = Parameter_callback()) :
         _name(name),
         _hidden(false),
         _callback_on_change(callback_on_change)
@@ -58,7 +112,7 @@ public:
         _special_type = Type::Normal;
     }
 
-    Parameter(std::string const& name, std::string const& value, std::function<void()> callback_on_change = std::function<void()>()) :
+    Parameter(std::string const& name, std::string const& value, Parameter_callback callback_on_change = Parameter_callback()) :
         _name(name),
         _hidden(false),
         _callback_on_change(callback_on_change)
@@ -69,7 +123,7 @@ public:
     }
 
     template <class T>
-    Parameter(std::string const& name, T const& value, T const& min, T const& max, std::function<void()> callback_on_change = std::function<void()>()) :
+    Parameter(std::string const& name, T const& value, T const& min, T const& max, Parameter_callback callback_on_change = Parameter_callback()) :
         _name(name),
         _hidden(false),
         _callback_on_change(callback_on_change)
@@ -81,7 +135,7 @@ public:
     }
 
     template <class T>
-    Parameter(std::string const& name, int const index, std::vector<T> const& value_list, std::function<void()> callback_on_change = std::function<void()>()) :
+    Parameter(std::string const& name, int const index, std::vector<T> const& value_list, Parameter_callback callback_on_change = Parameter_callback()) :
         _name(name),
         _hidden(false),
         _callback_on_change(callback_on_change)
@@ -107,7 +161,7 @@ public:
     }
 
     template <class T>
-    Parameter(std::string const& name, int const index, std::map<std::string, T> const& value_list, std::function<void()> callback_on_change = std::function<void()>()) :
+    Parameter(std::string const& name, int const index, std::map<std::string, T> const& value_list, Parameter_callback callback_on_change = Parameter_callback()) :
         _name(name),
         _hidden(false),
         _callback_on_change(callback_on_change)
@@ -128,12 +182,12 @@ public:
         _special_type = Type::List;
     }
 
-    void set_callback(std::function<void()> const& callback_function)
+    void set_callback(Parameter_callback const& callback_function)
     {
         _callback_on_change = callback_function;
     }
 
-    static Parameter * create_button(std::string const& name, std::function<void()> callback_on_change = std::function<void()>())
+    static Parameter * create_button(std::string const& name, Parameter_callback callback_on_change = Parameter_callback())
     {
         Parameter * p = new Parameter;
         p->_name = name;
@@ -143,14 +197,15 @@ public:
         return p;
     }
 
-    void do_callback() { if (_callback_on_change) _callback_on_change(); }
+    // immediately or, inside a Parameter_batch, once when the batch ends
+    void do_callback() { if (_callback_on_change) Parameter_batch::call(_callback_on_change, this); }
 
     void set_from_index(int index);
 
     void set_bool_from_int(int const value)
     {
         _value = bool(value);
-        if (_callback_on_change) _callback_on_change();
+        do_callback();
         notify_observers();
     }
 
@@ -159,7 +214,7 @@ public:
     {
         set_value_no_update(value);
 
-        if (_callback_on_change) _callback_on_change();
+        do_callback();
 //        notify_observers();
     }
 
@@ -183,27 +238,29 @@ public:
                 }
                 catch (...)
                 {
-                    std::cout << __FUNCTION__ << " get failed on list parameter: " << _name << " value: " << value << std::endl;
-                    std::cout << typeid(value).name() << " " << typeid(T).name() << std::endl;
-                    std::cout << "Possible values:" << std::endl;
+                    std::ostringstream possible_values;
 
                     for (size_t j = 0; j < _value_list.size(); ++j)
                     {
-                        std::cout << j << ": " << boost::get<T>(_value_list[j]) << std::endl;
+                        possible_values << " " << j << ": " << boost::get<T>(_value_list[j]);
                     }
+
+                    LOG_WARNING("get failed on list parameter: " << _name << " value: " << value << " " << typeid(value).name() << " " << typeid(T).name() <<
+                                ", possible values:" << possible_values.str());
                 }
             }
 
             if (!found)
             {
-                std::cout << __FUNCTION__ << "  << failed on list parameter: " << _name << " value: " << value << std::endl;
-                std::cout << "Possible values:" << std::endl;
+                std::ostringstream possible_values;
 
                 for (size_t i = 0; i < _value_list.size(); ++i)
                 {
-                    std::cout << boost::get<T>(_value_list[i]) << std::endl;
+                    possible_values << " " << boost::get<T>(_value_list[i]);
                 }
 
+                LOG_WARNING("failed on list parameter: " << _name << " value: " << value << ", possible values:" << possible_values.str());
+
                 assert(false);
             }
         }
@@ -247,12 +304,17 @@ public:
         }
         catch (...)
         {
-            std::cout << "Parameter::get_value(): Exception " << _name << std::endl;
-            std::cout << "Requested type: " << typeid(T).name() << ", stored type: " << _value.type().name() << std::endl;
+            LOG_WARNING("Parameter::get_value(): Exception " << _name << ", requested type: " << typeid(T).name() << ", stored type: " << _value.type().name());
             throw;
         }
     }
 
+    // the current value whatever its type, for list parameters the selected entry
+    My_variant const& get_variant_value() const
+    {
+        return (_special_type == Type::List) ? _value_list[_index] : _value;
+    }
+
     template <class T>
     void set_min_max(T const& min, T const& max)
     {
@@ -274,7 +336,7 @@ public:
         }
         catch (...)
         {
-            std::cout << "Parameter::get_min(): Exception " << _name << std::endl;
+            LOG_WARNING("Parameter::get_min(): Exception " << _name);
             throw;
         }
     }
@@ -290,7 +352,7 @@ public:
         }
         catch (...)
         {
-            std::cout << "Parameter::get_max(): Exception " << _name << std::endl;
+            LOG_WARNING("Parameter::get_max(): Exception " << _name);
             throw;
         }
     }
@@ -323,7 +385,7 @@ public:
 
         if (_special_type != Type::Button)
         {
-            if (_callback_on_change) _callback_on_change();
+            do_callback();
         }
         notify_observers();
     }
@@ -413,7 +475,7 @@ private:
 
     bool _hidden;
 
-    std::function<void()> _callback_on_change;
+    Parameter_callback _callback_on_change;
 
     std::vector<Notifiable*> _observers;
 };
@@ -439,9 +501,18 @@ public:
 
     enum Children_type { Normal, Single_select, Multi_select };
 
-    Parameter_list() : _children_type(Normal)
+    Parameter_list() : _children_type(Normal), _generation(0)
     {}
 
+    Parameter_list(Parameter_list const& other) = default;
+
+    // the assigned list has a different structure, so handles on this one resolve again
+    Parameter_list & operator=(Parameter_list const& other);
+
+    // Incremented whenever this list gains parameters or children, is assigned or loaded,
+    // used to invalidate the Parameter_handles resolved through it
+    unsigned int get_generation() const { return _generation; }
+
     void add_parameter(std::string const& id, Parameter * new_parameter);
     void add_parameter(Parameter * new_parameter) { add_parameter(new_parameter->get_name(), new_parameter); }
     void add_parameter_keep_order(std::string const& id, Parameter * new_parameter);
@@ -475,17 +546,24 @@ public:
     Children_type get_children_type() const { return _children_type; }
     void set_children_type(Children_type const t) { _children_type = t; }
 
-    void set_children_callback_function(Child_map & children, std::function<void(void)> update_function);
+    void set_children_callback_function(Child_map & children, Parameter_callback const& update_function);
 
     // possible FIXME: this will really only append the argument, it will not take copies
     // of the pointers contained in the maps (shallow copy)!
-    void append(Parameter_list const& parameter_list, std::function<void(void)> update_function = std::function<void(void)>());
+    void append(Parameter_list const& parameter_list, Parameter_callback const& update_function = Parameter_callback());
 
     void print() const;
 
+    // binary files in the byte order of the machine (checked on loading), load() also reads the XML archives of older versions
     void save(std::string const& file_name) const;
     void load(std::string const& file_name);
     void load(Parameter_list const& tmp_param_list);
+
+    // Only the values and indices by name, no structure: loading sets the parameters that exist, like load().
+    // All callbacks of a load are run once at its end (Parameter_batch). Throws std::runtime_error on broken data.
+    void save_binary(std::ostream & out) const;
+    void load_binary(std::istream & in);
+
     // recursive loading, setting only values that already exist, not creating new values
     void load(std::map<std::string, Parameter*> & list, std::map<std::string, Parameter*> const& tmp_list, Child_map & children, Child_map const& tmp_children) const;
 
@@ -495,13 +573,97 @@ public:
         ar & BOOST_SERIALIZATION_NVP(_list);
         ar & BOOST_SERIALIZATION_NVP(_children);
         ar & BOOST_SERIALIZATION_NVP(_children_type);
+
+        if (Archive::is_loading::value) ++_generation;
     }
 
 private:
+    void write_binary(std::ostream & out) const;
+    // skips the values when list is null
+    static void read_binary(std::istream & in, Parameter_list * list);
+
     std::map<std::string, Parameter*> _list;
     Child_map _children;
 
     Children_type _children_type;
+
+    unsigned int _generation;
+};
+
+
+// Resolves a parameter path ("Atomic Force Type/Coulomb Force/Strength") once and afterwards reads
+// through the cached pointer, avoiding the substr/map walk of Parameter_list::get_parameter() on hot paths.
+// The handle resolves again lazily if the structure of one of the lists along the path changed.
+template <class T>
+class Parameter_handle
+{
+public:
+    Parameter_handle() : _list(nullptr), _parameter(nullptr)
+    {}
+
+    Parameter_handle(Parameter_list const* list, std::string const& path)
+    {
+        bind(list, path);
+    }
+
+    void bind(Parameter_list const* list, std::string const& path)
+    {
+        _list = list;
+        _path = path;
+        resolve();
+    }
+
+    bool is_bound() const { return _list != nullptr; }
+
+    T get() const
+    {
+        return get_parameter()->template get_value<T>();
+    }
+
+    Parameter const* get_parameter() const
+    {
+        // checked from the bound list down, a child is only looked at while its parent is unchanged
+        for (size_t i = 0; i < _path_lists.size(); ++i)
+        {
+            if (_path_lists[i].first->get_generation() != _path_lists[i].second)
+            {
+                resolve();
+                break;
+            }
+        }
+
+        return _parameter;
+    }
+
+    Parameter const* operator-> () const { return get_parameter(); }
+
+private:
+    void resolve() const
+    {
+        assert(_list);
+
+        _path_lists.clear();
+
+        Parameter_list const* list = _list;
+        size_t name_start = 0;
+        size_t separator_pos;
+
+        while ((separator_pos = _path.find_first_of('/', name_start)) != std::string::npos)
+        {
+            _path_lists.push_back(std::make_pair(list, list->get_generation()));
+            list = list->get_child(_path.substr(name_start, separator_pos - name_start));
+            name_start = separator_pos + 1;
+        }
+
+        _path_lists.push_back(std::make_pair(list, list->get_generation()));
+        _parameter = list->get_parameter(_path.substr(name_start));
+    }
+
+    Parameter_list const* _list;
+    std::string _path;
+
+    mutable Parameter const* _parameter;
+    mutable std::vector< std::pair<Parameter_list const*, unsigned int> > _path_lists;
 };
 
 
@@ -1,6 +1,6 @@
 #include "Particle_system.h"
 
-#include <QtOpenGL>
+#include "Message_logger.h"
 
 #include <cmath>
 
@@ -114,7 +114,7 @@ void Targeted_particle_system::generate(const QImage &image, QVector2D const& sc
         }
     }
 
-    std::cout << __FUNCTION__ << " created " << _particles.size() << " particles" << std::endl;
+    LOG_INFO("created " << _particles.size() << " particles");
 }
 
 void Targeted_particle_system::init(const std::vector<Targeted_particle> &particles)
@@ -3,6 +3,7 @@
 #include "Core.h"
 #include "My_viewer.h"
 #include "Main_menu_screen.h"
+#include "Message_logger.h"
 
 Pause_screen::Pause_screen(My_viewer &viewer, Core &core, Screen *calling_state) : Menu_screen(viewer, core), _calling_screen(calling_state)
 {
@@ -18,7 +19,7 @@ bool Pause_screen::keyPressEvent(QKeyEvent *event)
 {
     bool handled = false;
 
-    std::cout << __FUNCTION__ << " " << event->key() << " state: " << int(get_state()) << std::endl;
+    LOG_DEBUG(event->key() << " state: " << int(get_state()));
 
     if (event->key() == Qt::Key_Escape)
     {
@@ -89,7 +90,7 @@ void Pause_screen::restart_level()
 {
     kill();
 
-    _core.reset_level();
+    _core.restart_level();
 
     _calling_screen->resume();
 }
@@ -7,6 +7,7 @@ class Pause_screen : public Menu_screen
 {
 public:
     Pause_screen(My_viewer & viewer, Core & core, Screen * calling_state);
+    char const* get_name() const override { return "Pause_screen"; }
 
     bool keyPressEvent(QKeyEvent * event) override;
 
@@ -0,0 +1,183 @@
+#include "Performance_hud.h"
+
+#include <cmath>
+
+#include "My_viewer.h"
+#include "Core.h"
+#include "Renderer.h"
+#include "Memory_accounting.h"
+
+namespace
+{
+float const Graph_max_milliseconds = 2.0f * 1000.0f / 60.0f; // two frames at 60 Hz
+float const Text_update_interval = 0.5f;
+
+QString to_megabytes(long long const bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0), 'f', 1);
+}
+}
+
+
+Performance_hud::Performance_hud() :
+    _visible(false),
+    _last_num_atom_pairs(0),
+    _time_to_first_frame(-1.0f),
+    _text(Eigen::Vector3f(0.16f, 0.64f, 0.0f), Eigen::Vector2f(0.3f, 0.24f), ""),
+    _graph(Eigen::Vector3f(0.16f, 0.87f, 0.0f), Eigen::Vector2f(0.3f, 0.2f), "Frame time (0 - 33 ms)"),
+    _graph_seconds(-1)
+{
+    _graph.set_display_type(Draggable_statistics::Display_type::Float);
+}
+
+void Performance_hud::set_visible(const bool visible)
+{
+    if (visible && !_visible)
+    {
+        _frame_times.clear();
+        _render_times.clear();
+        _hud_times.clear();
+
+        _last_frame = std::chrono::steady_clock::now();
+        _last_text_update = std::chrono::steady_clock::time_point();
+    }
+
+    _visible = visible;
+}
+
+void Performance_hud::add_frame(const float render_milliseconds)
+{
+    std::chrono::steady_clock::time_point const now = std::chrono::steady_clock::now();
+
+    _frame_times.add(std::chrono::duration<float, std::milli>(now - _last_frame).count());
+    _render_times.add(render_milliseconds);
+
+    _last_frame = now;
+}
+
+void Performance_hud::draw(My_viewer &viewer, const Core &core, const Ui_renderer &renderer)
+{
+    float hud_milliseconds = 0.0f;
+
+    {
+        Scoped_timer const hud_timer(hud_milliseconds);
+
+        std::chrono::steady_clock::time_point const now = std::chrono::steady_clock::now();
+
+        if (std::chrono::duration<float>(now - _last_text_update).count() > Text_update_interval)
+        {
+            update_text_texture(core, renderer);
+            _last_text_update = now;
+        }
+
+        int const graph_seconds = int(std::round(_frame_times.get_mean() * _frame_times.size() / 1000.0f));
+
+        if (graph_seconds != _graph_seconds)
+        {
+            renderer.generate_statistics_texture(_graph, float(graph_seconds));
+            _graph_seconds = graph_seconds;
+        }
+
+        glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT);
+
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_LIGHTING);
+        glEnable(GL_BLEND);
+        glEnable(GL_TEXTURE_2D);
+
+        viewer.start_normalized_screen_coordinates();
+
+        viewer.draw_label(&_text);
+        draw_frame_time_graph(viewer);
+
+        viewer.stop_normalized_screen_coordinates();
+
+        glPopAttrib();
+    }
+
+    _hud_times.add(hud_milliseconds);
+}
+
+void Performance_hud::update_text_texture(const Core &core, const Ui_renderer &renderer)
+{
+    unsigned long long const num_atom_pairs = core.get_num_evaluated_atom_pairs();
+    float const elapsed_seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - _last_text_update).count();
+    float const atom_pairs_per_second = (elapsed_seconds < 10.0f) ? (num_atom_pairs - _last_num_atom_pairs) / elapsed_seconds : 0.0f;
+
+    _last_num_atom_pairs = num_atom_pairs;
+
+    Timing_window const& physics_times = core.get_physics_step_times();
+    Timing_window const& force_times = core.get_force_evaluation_times();
+
+    QString text = QString("Frame ms  p50 %1  p95 %2  p99 %3\n"
+                           "Render %4 ms  Physics %5 ms  Forces %6 ms\n"
+                           "Atoms %7  Atom pairs/s %8  HUD %9 ms")
+            .arg(_frame_times.get_percentile(0.5f), 0, 'f', 1)
+            .arg(_frame_times.get_percentile(0.95f), 0, 'f', 1)
+            .arg(_frame_times.get_percentile(0.99f), 0, 'f', 1)
+            .arg(_render_times.get_mean(), 0, 'f', 2)
+            .arg(physics_times.get_mean(), 0, 'f', 2)
+            .arg(force_times.get_mean(), 0, 'f', 2)
+            .arg(core.get_num_atoms())
+            .arg(atom_pairs_per_second, 0, 'g', 3)
+            .arg(_hud_times.get_percentile(0.5f), 0, 'f', 3);
+
+    if (_time_to_first_frame >= 0.0f)
+    {
+        text += QString("\nFirst frame %1 ms after start").arg(_time_to_first_frame, 0, 'f', 0);
+    }
+
+    // current / peak per subsystem, three per line
+    Memory_accounting const* memory = Memory_accounting::get_instance();
+
+    text += QString("\nMemory MB  total %1 / %2").arg(to_megabytes(memory->get_total_current())).arg(to_megabytes(memory->get_total_peak()));
+
+    for (int i = 0; i < int(Memory_subsystem::Num_subsystems); ++i)
+    {
+        Memory_subsystem const subsystem = Memory_subsystem(i);
+
+        text += (i % 3 == 0) ? "\n" : "  ";
+        text += QString("%1 %2 / %3").arg(Memory_accounting::get_name(subsystem)).arg(to_megabytes(memory->get_current(subsystem))).arg(to_megabytes(memory->get_peak(subsystem)));
+    }
+
+    _text.set_text(text.toStdString());
+    renderer.generate_label_texture(&_text, Qt::AlignLeft | Qt::AlignVCenter);
+}
+
+void Performance_hud::draw_frame_time_graph(My_viewer &viewer) const
+{
+    glPushMatrix();
+
+    glTranslatef(_graph.get_position()[0], _graph.get_position()[1], _graph.get_position()[2]);
+    glScalef(_graph.get_extent()[0] * 0.5f, _graph.get_extent()[1] * 0.5f, 1.0f);
+
+    viewer.draw_textured_quad(_graph.get_texture());
+
+    // same graph area as My_viewer::draw_statistic()
+    glScalef(2.0f, 2.0f, 1.0f);
+    glTranslatef(-0.5f, -0.5f, 0.0f);
+    glTranslatef(0.1f, 0.15f, 0.0f);
+    glScalef(0.8f, 0.6f, 1.0f);
+
+    std::vector<float> const values = _frame_times.get_values();
+
+    if (values.size() > 1)
+    {
+        glDisable(GL_TEXTURE_2D);
+        glLineWidth(1.5f);
+        glColor4f(1.0f, 0.4f, 0.05f, 1.0f);
+
+        glBegin(GL_LINE_STRIP);
+
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            glVertex2f(i / float(values.size() - 1), std::min(values[i] / Graph_max_milliseconds, 1.0f));
+        }
+
+        glEnd();
+
+        glEnable(GL_TEXTURE_2D);
+    }
+
+    glPopMatrix();
+}
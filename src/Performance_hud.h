@@ -0,0 +1,55 @@
+#ifndef PERFORMANCE_HUD_H
+#define PERFORMANCE_HUD_H
+
+#include <chrono>
+
+#include "Draggable.h"
+#include "Timing_window.h"
+
+class Core;
+class My_viewer;
+class Ui_renderer;
+
+// Overlay with the frame time graph, frame time percentiles, render, physics step and force evaluation times,
+// the atom and atom pair counts and the current and peak memory use per subsystem. Toggled with F8 in My_viewer.
+// Per frame only a sample is added and two textured quads and a line strip are drawn,
+// the text texture is regenerated a few times per second.
+class Performance_hud
+{
+public:
+    Performance_hud();
+
+    bool is_visible() const { return _visible; }
+    void set_visible(bool const visible);
+
+    // once per drawn frame, render_milliseconds is the CPU time spent in the screens' draw calls
+    void add_frame(float const render_milliseconds);
+
+    void draw(My_viewer & viewer, Core const& core, Ui_renderer const& renderer);
+
+    void resize() { _graph_seconds = -1; }
+
+    // shown below the frame times once set, see My_viewer::draw()
+    void set_time_to_first_frame(float const milliseconds) { _time_to_first_frame = milliseconds; }
+
+private:
+    void update_text_texture(Core const& core, Ui_renderer const& renderer);
+    void draw_frame_time_graph(My_viewer & viewer) const;
+
+    bool _visible;
+
+    Timing_window _frame_times;
+    Timing_window _render_times;
+    Timing_window _hud_times;
+
+    std::chrono::steady_clock::time_point _last_frame;
+    std::chrono::steady_clock::time_point _last_text_update;
+    unsigned long long _last_num_atom_pairs;
+    float _time_to_first_frame; // ms, negative until the first frame was drawn
+
+    Draggable_label _text;
+    Draggable_statistics _graph;
+    int _graph_seconds; // time span shown in the graph texture, regenerated when it changes
+};
+
+#endif // PERFORMANCE_HUD_H
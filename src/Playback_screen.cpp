@@ -0,0 +1,180 @@
+#include "Playback_screen.h"
+
+#include "My_viewer.h"
+#include "Main_menu_screen.h"
+#include "Draw_functions.h"
+#include "Message_logger.h"
+
+
+Playback_screen::Playback_screen(My_viewer &viewer, Core &core) : Menu_screen(viewer, core),
+    _playback_time(0.0f),
+    _shown_time(-1.0f),
+    _speed(1.0f),
+    _playing(true)
+{
+    _type = Screen::Type::Fullscreen;
+
+    Shader_renderer * renderer = new Shader_renderer;
+    renderer->set_parameters(Shader_renderer::get_parameters());
+    _world_renderer = std::unique_ptr<World_renderer>(renderer);
+    _world_renderer->init(_viewer.context(), _viewer.size());
+
+    _main_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(_viewer.size(), QGLFramebufferObject::Depth));
+
+    _screen_quad_program = std::unique_ptr<QGLShaderProgram>(init_program(_viewer.context(),
+                                                                          Data_config::get_instance()->get_absolute_qfilename("shaders/fullscreen_square.vert"),
+                                                                          Data_config::get_instance()->get_absolute_qfilename("shaders/simple_texture.frag")));
+
+    _status_label = boost::shared_ptr<Draggable_label>(new Draggable_label(Eigen::Vector3f(0.2f, 0.95f, 0.0f), Eigen::Vector2f(0.35f, 0.05f), ""));
+    _labels.push_back(_status_label);
+}
+
+bool Playback_screen::open(const std::string &file_name)
+{
+    if (!_reader.open(file_name)) return false;
+
+    Level_data & level_data = _reader.get_level_data();
+
+    update_temperature_grid(level_data, level_data._temperature_grid);
+    _world_renderer->update(level_data);
+
+    _viewer.update_camera_for_level(level_data);
+
+    seek(_reader.get_start_time());
+
+    LOG_INFO(file_name << ": " << _reader.get_num_frames() << " frames, "
+             << _reader.get_start_time() << " - " << _reader.get_end_time() << " s");
+
+    return true;
+}
+
+void Playback_screen::draw()
+{
+    if (_reader.is_open())
+    {
+        _world_renderer->setup_gl_points(true);
+
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        _main_fbo->bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        _main_fbo->release();
+
+        _world_renderer->render(_main_fbo.get(), _reader.get_level_data(), _shown_time, _viewer.camera());
+
+        _world_renderer->setup_gl_points(false);
+
+        glDisable(GL_DEPTH_TEST);
+
+        _screen_quad_program->bind();
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        _screen_quad_program->setUniformValue("texture", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _main_fbo->texture());
+        draw_quad_with_tex_coords();
+        _screen_quad_program->release();
+    }
+
+    Menu_screen::draw();
+}
+
+bool Playback_screen::keyPressEvent(QKeyEvent *event)
+{
+    float const seek_step = (event->modifiers() & Qt::ShiftModifier) ? 30.0f : 5.0f;
+
+    switch (event->key())
+    {
+    case Qt::Key_Escape:
+        return_to_main_menu();
+        break;
+    case Qt::Key_Space:
+        _playing = !_playing;
+        break;
+    case Qt::Key_Left:
+        seek(_playback_time - seek_step);
+        break;
+    case Qt::Key_Right:
+        seek(_playback_time + seek_step);
+        break;
+    case Qt::Key_Up:
+        _speed = std::min(_speed * 2.0f, 256.0f);
+        break;
+    case Qt::Key_Down:
+        _speed = std::max(_speed * 0.5f, 1.0f / 16.0f);
+        break;
+    case Qt::Key_Home:
+        seek(_reader.get_start_time());
+        break;
+    case Qt::Key_End:
+        seek(_reader.get_end_time());
+        break;
+    default:
+        return false;
+    }
+
+    update_status_label();
+
+    return true;
+}
+
+void Playback_screen::update_event(const float time_step)
+{
+    Menu_screen::update_event(time_step);
+
+    if (_playing)
+    {
+        seek(_playback_time + time_step * _speed);
+
+        if (_playback_time >= _reader.get_end_time())
+        {
+            _playing = false;
+        }
+    }
+
+    update_status_label();
+}
+
+void Playback_screen::resize(const QSize &size)
+{
+    _world_renderer->resize(size);
+    _main_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
+
+    Menu_screen::resize(size);
+}
+
+void Playback_screen::seek(const float time)
+{
+    _playback_time = into_range(time, _reader.get_start_time(), _reader.get_end_time());
+
+    if (_playback_time == _shown_time) return;
+
+    if (_reader.read_frame(_playback_time, _reader.get_level_data()._molecules))
+    {
+        _shown_time = _playback_time;
+    }
+}
+
+void Playback_screen::update_status_label()
+{
+    // whole seconds, the texture is only regenerated when the text changes
+    QString const text = QString("%1 / %2 s   x%3%4")
+            .arg(int(_playback_time))
+            .arg(int(_reader.get_end_time()))
+            .arg(_speed)
+            .arg(_playing ? "" : "   paused");
+
+    if (text.toStdString() == _status_text) return;
+
+    _status_text = text.toStdString();
+    _status_label->set_text(_status_text);
+    _renderer.generate_label_texture(_status_label.get(), Qt::AlignLeft | Qt::AlignVCenter);
+}
+
+void Playback_screen::return_to_main_menu()
+{
+    _viewer.add_screen(new Main_menu_screen(_viewer, _core));
+
+    kill();
+}
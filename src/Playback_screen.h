@@ -0,0 +1,47 @@
+#ifndef PLAYBACK_SCREEN_H
+#define PLAYBACK_SCREEN_H
+
+#include "Menu_screen.h"
+#include "Trajectory.h"
+
+// Plays a trajectory file (particular_sim --trajectory) without the physics: the level embedded in the file is drawn
+// by its own Shader_renderer with the molecules read from the recording, one chunk in memory at a time.
+// Space pauses, Left/Right seek 5 s (30 s with Shift), Up/Down double or halve the speed, Home/End jump to the
+// start or end, Escape returns to the main menu.
+class Playback_screen : public Menu_screen
+{
+public:
+    Playback_screen(My_viewer & viewer, Core & core);
+    char const* get_name() const override { return "Playback_screen"; }
+
+    bool open(std::string const& file_name);
+
+    void draw() override;
+
+    bool keyPressEvent(QKeyEvent * event) override;
+
+    void update_event(float const time_step) override;
+
+    void resize(QSize const& size) override;
+
+private:
+    void seek(float const time);
+    void update_status_label();
+    void return_to_main_menu();
+
+    Trajectory_reader _reader;
+
+    std::unique_ptr<World_renderer> _world_renderer;
+    std::unique_ptr<QGLFramebufferObject> _main_fbo;
+    std::unique_ptr<QGLShaderProgram> _screen_quad_program;
+
+    float _playback_time;
+    float _shown_time;     // of the molecules in the level data, negative before the first read
+    float _speed;          // recorded seconds per second
+    bool _playing;
+
+    boost::shared_ptr<Draggable_label> _status_label;
+    std::string _status_text;
+};
+
+#endif // PLAYBACK_SCREEN_H
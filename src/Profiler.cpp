@@ -0,0 +1,161 @@
+#include "Profiler.h"
+
+#include "Message_logger.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+namespace
+{
+int const Buffer_capacity = 1 << 16;
+
+// zone names are string literals but may contain anything, the trace has to stay valid JSON
+void write_json_string(std::ostream & out, char const* text)
+{
+    out << '"';
+
+    for (char const* c = text; *c; ++c)
+    {
+        unsigned char const u = static_cast<unsigned char>(*c);
+
+        if (*c == '"' || *c == '\\')
+        {
+            out << '\\' << *c;
+        }
+        else if (u < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", u);
+            out << escaped;
+        }
+        else
+        {
+            out << *c;
+        }
+    }
+
+    out << '"';
+}
+}
+
+
+std::vector<Profile_event> Profile_buffer::get_events() const
+{
+    std::vector<Profile_event> result;
+
+    if (_num_written <= _events.size())
+    {
+        result.assign(_events.begin(), _events.begin() + _num_written);
+    }
+    else
+    {
+        size_t const oldest = _num_written % _events.size();
+
+        result.assign(_events.begin() + oldest, _events.end());
+        result.insert(result.end(), _events.begin(), _events.begin() + oldest);
+    }
+
+    return result;
+}
+
+
+Profiler::Profiler() :
+    _enabled(false),
+    _capture_start_ns(now_ns())
+{ }
+
+Profiler *Profiler::get_instance()
+{
+    static Profiler * const instance = new Profiler;
+
+    return instance;
+}
+
+void Profiler::set_enabled(const bool enabled)
+{
+    // a new capture starts with empty buffers
+    if (enabled && !is_enabled())
+    {
+        clear();
+        _capture_start_ns = now_ns();
+    }
+
+    _enabled.store(enabled);
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (std::unique_ptr<Profile_buffer> const& b : _buffers)
+    {
+        b->clear();
+    }
+}
+
+void Profiler::record(const char *name, const long long start_ns, const long long end_ns)
+{
+    get_thread_buffer()->add(name, start_ns, end_ns);
+}
+
+Profile_buffer *Profiler::get_thread_buffer()
+{
+    // the buffers are owned by the profiler so their events survive the thread
+    thread_local Profile_buffer * buffer = nullptr;
+
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _buffers.push_back(std::unique_ptr<Profile_buffer>(new Profile_buffer(int(_buffers.size()), Buffer_capacity)));
+        buffer = _buffers.back().get();
+    }
+
+    return buffer;
+}
+
+bool Profiler::export_chrome_trace(const std::string &file_name) const
+{
+    std::ofstream out(file_name);
+
+    if (!out)
+    {
+        LOG_WARNING("Couldn't open " << file_name);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // timestamps and durations in microseconds, relative to the start of the capture
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    int num_events = 0;
+
+    for (std::unique_ptr<Profile_buffer> const& b : _buffers)
+    {
+        for (Profile_event const& e : b->get_events())
+        {
+            if (!first) out << ",\n";
+            first = false;
+
+            out << "{\"name\":";
+            write_json_string(out, e._name);
+            out << ",\"ph\":\"X\""
+                << ",\"ts\":" << (e._start_ns - _capture_start_ns) / 1000.0
+                << ",\"dur\":" << (e._end_ns - e._start_ns) / 1000.0
+                << ",\"pid\":1,\"tid\":" << b->get_thread_index() << "}";
+
+            ++num_events;
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    LOG_INFO("Wrote " << num_events << " events to " << file_name);
+
+    return bool(out);
+}
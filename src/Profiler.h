@@ -0,0 +1,142 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped-zone profiler for the hot paths. PROFILE_ZONE("name") records the time from the macro to the end of the
+// enclosing scope into a ring buffer of the calling thread, the buffers are only locked when a thread registers.
+// Without PARTICULAR_PROFILING (qmake CONFIG+=profiling) the macro expands to nothing.
+// Zone names must be string literals or otherwise outlive the profiler, only the pointer is stored.
+
+struct Profile_event
+{
+    char const* _name;
+    long long _start_ns;
+    long long _end_ns;
+};
+
+
+// ring buffer of one thread, the oldest events are overwritten when full
+class Profile_buffer
+{
+public:
+    Profile_buffer(int const thread_index, int const capacity) :
+        _thread_index(thread_index),
+        _events(capacity),
+        _num_written(0)
+    { }
+
+    void add(char const* name, long long const start_ns, long long const end_ns)
+    {
+        Profile_event & e = _events[_num_written % _events.size()];
+        e._name = name;
+        e._start_ns = start_ns;
+        e._end_ns = end_ns;
+
+        ++_num_written;
+    }
+
+    void clear()
+    {
+        _num_written = 0;
+    }
+
+    int get_thread_index() const { return _thread_index; }
+
+    // events in recording order
+    std::vector<Profile_event> get_events() const;
+
+private:
+    int _thread_index;
+    std::vector<Profile_event> _events;
+    size_t _num_written;
+};
+
+
+class Profiler
+{
+public:
+    static Profiler * get_instance();
+
+    static bool is_compiled_in()
+    {
+#ifdef PARTICULAR_PROFILING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static long long now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool is_enabled() const
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    // enabling starts a new capture
+    void set_enabled(bool const enabled);
+
+    // drops all recorded events, call while disabled
+    void clear();
+
+    void record(char const* name, long long const start_ns, long long const end_ns);
+
+    // writes the recorded events in the Chrome trace event format (chrome://tracing, Perfetto), call while disabled
+    bool export_chrome_trace(std::string const& file_name) const;
+
+private:
+    Profiler();
+
+    Profile_buffer * get_thread_buffer();
+
+    std::atomic<bool> _enabled;
+    long long _capture_start_ns;
+
+    mutable std::mutex _mutex;
+    std::vector< std::unique_ptr<Profile_buffer> > _buffers;
+};
+
+
+class Profile_zone
+{
+public:
+    explicit Profile_zone(char const* name) :
+        _name(name),
+        _start_ns(Profiler::get_instance()->is_enabled() ? Profiler::now_ns() : -1)
+    { }
+
+    ~Profile_zone()
+    {
+        if (_start_ns >= 0)
+        {
+            Profiler::get_instance()->record(_name, _start_ns, Profiler::now_ns());
+        }
+    }
+
+private:
+    Profile_zone(Profile_zone const&);
+    Profile_zone & operator=(Profile_zone const&);
+
+    char const* _name;
+    long long _start_ns;
+};
+
+
+#ifdef PARTICULAR_PROFILING
+#define PROFILE_ZONE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) Profile_zone const PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+#endif // PROFILER_H
@@ -7,6 +7,7 @@
 #include "Combo_switcher.h"
 #include "FoldableGroupBox.h"
 #include "qxtgroupbox.h"
+#include "Message_logger.h"
 
 QWidget * create_parameter_widget(Parameter const* parameter)
 {
@@ -14,7 +15,7 @@ QWidget * create_parameter_widget(Parameter const* parameter)
 
     Q_parameter_bridge * bridge; // = new Q_parameter_bridge(parameter);
 
-    std::cout << "create_parameter_widget(): " << parameter->get_type().name() << " " << parameter->get_name() << std::endl;
+    LOG_DEBUG("create_parameter_widget(): " << parameter->get_type().name() << " " << parameter->get_name());
 
     if (parameter->get_special_type() == Parameter::Type::Normal)
     {
@@ -109,7 +110,7 @@ void draw_instance_list(Parameter_list const& parameters, QLayout * layout)
 
             if (parameters.get_children_type() == Parameter_list::Multi_select)
             {
-                std::cout << "Parameter_list::Multi_select" << std::endl;
+                LOG_DEBUG("Parameter_list::Multi_select");
                 Q_groupbox_parameter * groupbox_param = new Q_groupbox_parameter(sub_list["multi_enable"], child_box);
 
                 assert(groupbox_param->get_widget() == child_box);
@@ -124,7 +125,7 @@ void draw_instance_list(Parameter_list const& parameters, QLayout * layout)
 
 QWidget * create_single_select_widget(Parameter const* parameter, Parameter_list::Child_map const& children)
 {
-    std::cout << "create_single_select_widget(): " << parameter->get_name() << std::endl;
+    LOG_DEBUG("create_single_select_widget(): " << parameter->get_name());
 
     Q_parameter_bridge * bridge = new Q_parameter_bridge(parameter);
 
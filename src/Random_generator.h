@@ -14,6 +14,22 @@ struct Random_generator
         _distribution = std::uniform_real_distribution<float>(-1.0f, 1.0f);
     }
 
+    void seed(unsigned int const seed)
+    {
+        _generator.seed(seed);
+    }
+
+    // uniform in [-1, 1]
+    float generate()
+    {
+        return _distribution(_generator);
+    }
+
+    Eigen::Vector3f generate_vector()
+    {
+        return Eigen::Vector3f(generate(), generate(), generate());
+    }
+
     Eigen::Vector3f generator_unit_vector()
     {
         return Eigen::Vector3f(_distribution(_generator), _distribution(_generator), _distribution(_generator)).normalized();
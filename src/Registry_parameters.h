@@ -33,7 +33,7 @@ public:
         return _parameter_lists[class_name];
     }
 
-    static void add_params_recursive(Parameter_list * parent, Parameter_list const& p_list, std::function<void(void)> update_function)
+    static void add_params_recursive(Parameter_list * parent, Parameter_list const& p_list, Parameter_callback const& update_function)
     {
 //        Parameter_list * class_list = parent, Parameter_list * p_list->add_child(name);
 
@@ -76,7 +76,7 @@ public:
 //    }
 
     // for classes which are not part of an inheritance hierarchy
-    static void create_normal_instance(std::string const& name, Parameter_list * result, std::function<void(void)> update_function = std::function<void(void)>())
+    static void create_normal_instance(std::string const& name, Parameter_list * result, Parameter_callback const& update_function = Parameter_callback())
     {
         std::vector<std::string> class_names = Parameter_registry<T>::get()->get_registered_names();
 
@@ -90,7 +90,7 @@ public:
     }
 
 
-    static void create_multi_select_instance(Parameter_list * result, std::string const& instance_name, std::function<void(void)> update_function = std::function<void(void)>())
+    static void create_multi_select_instance(Parameter_list * result, std::string const& instance_name, Parameter_callback const& update_function = Parameter_callback())
     {
         std::vector<std::string> class_names = Parameter_registry<T>::get()->get_registered_names();
 
@@ -119,7 +119,7 @@ public:
     }
 
 
-    static void create_single_select_instance(Parameter_list * result, std::string const& instance_name, std::function<void(void)> update_function = std::function<void(void)>())
+    static void create_single_select_instance(Parameter_list * result, std::string const& instance_name, Parameter_callback const& update_function = Parameter_callback())
     {
         std::vector<std::string> class_names = Parameter_registry<T>::get()->get_registered_names();
 
@@ -232,7 +232,7 @@ public:
         return result;
     }
 
-//    static Parameter_list create_single_select_instance(std::string const& instance_name, std::function<void(void)> update_function = std::function<void(void)>())
+//    static Parameter_list create_single_select_instance(std::string const& instance_name, Parameter_callback const& update_function = Parameter_callback())
 //    {
 //        Parameter_list result;
 
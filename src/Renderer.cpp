@@ -21,6 +21,21 @@
 #include "Level_element_draw_visitor.h"
 #include "Data_config.h"
 #include "Score.h"
+#include "Profiler.h"
+#include "Message_logger.h"
+#include "Texture_cache.h"
+#include "Asset_preloader.h"
+
+namespace
+{
+// the blurred backdrop is a small version of the level's background magnified linearly
+Texture_options const Blurred_backdrop_options(0.05f);
+
+QString get_backdrop_file_name(std::string const& background_name)
+{
+    return Data_config::get_instance()->get_absolute_qfilename("textures/" + QString::fromStdString(background_name));
+}
+}
 
 float get_scale(QSize const& b_size, QSize const& target_size)
 {
@@ -262,10 +277,7 @@ void Ui_renderer::setup_fonts()
 //    int id = QFontDatabase::addApplicationFont(Data_config::get_instance()->get_absolute_qfilename("fonts/LondrinaSolid-Regular.otf"));
     int id = QFontDatabase::addApplicationFont(Data_config::get_instance()->get_absolute_qfilename("fonts/Matiz.ttf"));
     QString family = QFontDatabase::applicationFontFamilies(id).at(0);
-    for (auto const& f : QFontDatabase::applicationFontFamilies(id))
-    {
-        std::cout << f.toStdString() << std::endl;
-    }
+    LOG_DEBUG(QFontDatabase::applicationFontFamilies(id).join(", ").toStdString());
     _main_font = QFont(family);
 }
 
@@ -308,15 +320,15 @@ void Ui_renderer::init(const QGLContext *context, const QSize &size)
         p.drawImage(2, 2, text_image, text_bb.left(), text_bb.top());
         p.end();
 
-        Frame_buffer<Color4> number_tex_fb = convert<QRgb_to_Color4_converter, Color4>(final_text_image);
+        Frame_buffer<Color4> number_tex_fb = convert_to_color4(final_text_image);
         _number_textures.push_back(_gl_functions.create_texture(number_tex_fb));
 
 //        final_text_image.save(QString("/tmp/number%1.png"));
     }
 
-    _spinbox_arrowup_texture = _gl_functions.create_texture(Data_config::get_instance()->get_absolute_qfilename("textures/spinbox_arrowup.png"));
+    _spinbox_arrowup_texture = Texture_cache::get_instance()->get_texture(_gl_functions, Data_config::get_instance()->get_absolute_qfilename("textures/spinbox_arrowup.png"), Texture_options::alpha());
 
-    _spinbox_arrowdown_texture = _gl_functions.create_texture(Data_config::get_instance()->get_absolute_qfilename("textures/spinbox_arrowdown.png"));
+    _spinbox_arrowdown_texture = Texture_cache::get_instance()->get_texture(_gl_functions, Data_config::get_instance()->get_absolute_qfilename("textures/spinbox_arrowdown.png"), Texture_options::alpha());
 }
 
 void Ui_renderer::draw_spinbox(const Draggable_spinbox &s, const bool for_picking, const float alpha)
@@ -382,7 +394,7 @@ void Ui_renderer::draw_spinbox(const Draggable_spinbox &s, const bool for_pickin
 
 void Ui_renderer::generate_button_texture(Draggable_button *b) const
 {
-    std::cout << __FUNCTION__ << " constructing button texture" << std::endl;
+    LOG_DEBUG("constructing button texture");
 
     QSize const pixel_size(_screen_size.width() * b->get_extent()[0], _screen_size.height() * b->get_extent()[1]);
 
@@ -427,7 +439,7 @@ void Ui_renderer::generate_button_texture(Draggable_button *b) const
     f.init();
 
     f.delete_texture(b->get_texture());
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(img);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(img);
     b->set_texture(f.create_texture(texture_fb));
 
 //    deleteTexture(b->get_texture());
@@ -472,7 +484,7 @@ void Ui_renderer::generate_label_texture(Draggable_label *b, int const text_alig
     f.init();
 
     f.delete_texture(b->get_texture());
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(img);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(img);
     b->set_texture(f.create_texture(texture_fb));
 
 //    deleteTexture(b->get_texture());
@@ -481,7 +493,7 @@ void Ui_renderer::generate_label_texture(Draggable_label *b, int const text_alig
 
 void Ui_renderer::generate_statistics_texture(Draggable_statistics &b, float const full_time, float const time_threshold) const
 {
-    std::cout << __FUNCTION__ << " constructing statistic texture" << std::endl;
+    LOG_DEBUG("constructing statistic texture");
 
     QSize const pixel_size(_screen_size.width() * b.get_extent()[0], _screen_size.height() * b.get_extent()[1]);
 
@@ -592,13 +604,13 @@ void Ui_renderer::generate_statistics_texture(Draggable_statistics &b, float con
     f.init();
 
     f.delete_texture(b.get_texture());
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(img);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(img);
     b.set_texture(f.create_texture(texture_fb));
 }
 
 Eigen::Vector2f Ui_renderer::generate_flowing_text_label(Draggable_label * label, float const text_width) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     QSize const pixel_size(_screen_size.width() * text_width, _screen_size.height() * 0.5f);
 
@@ -638,7 +650,7 @@ Eigen::Vector2f Ui_renderer::generate_flowing_text_label(Draggable_label * label
     f.init();
 
     f.delete_texture(label->get_texture());
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(text_image);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(text_image);
     label->set_texture(f.create_texture(texture_fb));
     label->set_extent(uniform_bb);
 
@@ -650,7 +662,7 @@ Eigen::Vector2f Ui_renderer::generate_flowing_text_label(Draggable_label * label
 
 Draggable_tooltip *Ui_renderer::generate_tooltip(const Eigen::Vector3f &screen_pos, const Eigen::Vector3f &element_extent, const std::string &text) const
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     QSize const pixel_size(_screen_size.width() * 0.3f, _screen_size.height() * 0.5f);
 
@@ -710,7 +722,7 @@ Draggable_tooltip *Ui_renderer::generate_tooltip(const Eigen::Vector3f &screen_p
     GL_functions f;
     f.init();
 
-    Frame_buffer<Color4> texture_fb = convert<QRgb_to_Color4_converter, Color4>(text_image);
+    Frame_buffer<Color4> texture_fb = convert_to_color4(text_image);
     tooltip->set_texture(f.create_texture(texture_fb));
 
     return tooltip;
@@ -719,19 +731,18 @@ Draggable_tooltip *Ui_renderer::generate_tooltip(const Eigen::Vector3f &screen_p
 
 Shader_renderer::~Shader_renderer()
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
+    // the image textures belong to the Texture_cache
     glBindTexture(GL_TEXTURE_2D, 0);
-    _gl_functions.delete_texture(_ice_texture);
-    _gl_functions.delete_texture(_backdrop_texture);
-    _gl_functions.delete_texture(_blurred_backdrop_texture);
-    _gl_functions.delete_texture(_background_grid_texture);
     _gl_functions.delete_texture(_depth_texture);
     glFinish();
 }
 
 void Shader_renderer::init(const QGLContext *context, const QSize &size)
 {
+    PROFILE_ZONE("Shader_renderer::init");
+
     World_renderer::init(context, size);
 
     _molecule_program = std::unique_ptr<QGLShaderProgram>(init_program(context,
@@ -750,11 +761,11 @@ void Shader_renderer::init(const QGLContext *context, const QSize &size)
                                                                    Data_config::get_instance()->get_absolute_qfilename("shaders/fullscreen_square.vert"),
                                                                    Data_config::get_instance()->get_absolute_qfilename("shaders/depth_blur_1D.frag")));
 
-    _sphere_mesh.init(load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj")));
-    _grid_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/grid_10x10.obj"));
-    _cube_grid_mesh.init(load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/grid_cube.obj")), true);
+    _sphere_mesh.init(Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj")));
+    _grid_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/grid_10x10.obj"));
+    _cube_grid_mesh.init(Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/grid_cube.obj")), true);
     _cube_grid_mesh.setup_vertex_colors_buffer();
-    _bg_hemisphere_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/bg_hemisphere.obj"));
+    _bg_hemisphere_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/bg_hemisphere.obj"));
 
     MyMesh::ConstVertexIter vIt(_grid_mesh.vertices_begin()), vEnd(_grid_mesh.vertices_end());
 
@@ -766,17 +777,23 @@ void Shader_renderer::init(const QGLContext *context, const QSize &size)
         _grid_mesh.set_texcoord2D(*vIt, t);
     }
 
-    Frame_buffer<Color> ice_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/ice_texture.png")));
-    _ice_texture = _gl_functions.create_texture(ice_tex_fb);
+    Texture_cache * const texture_cache = Texture_cache::get_instance();
 
-    Frame_buffer<Color> backdrop_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("/textures/iss_interior_1.png")));
-    _backdrop_texture = _gl_functions.create_texture(backdrop_tex_fb);
+    QString const ice_file_name = Data_config::get_instance()->get_absolute_qfilename("textures/ice_texture.png");
+    QString const backdrop_file_name = Data_config::get_instance()->get_absolute_qfilename("textures/iss_interior_1.png");
+    QString const blurred_backdrop_file_name = Data_config::get_instance()->get_absolute_qfilename("textures/iss_interior_1_blurred.png");
+    QString const background_grid_file_name = Data_config::get_instance()->get_absolute_qfilename("textures/background_grid.png");
 
-    Frame_buffer<Color> blurred_backdrop_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("/textures/iss_interior_1_blurred.png")));
-    _blurred_backdrop_texture = _gl_functions.create_texture(blurred_backdrop_tex_fb);
+    // decoded in parallel, only the first renderer of a run waits for them
+    texture_cache->prefetch(ice_file_name);
+    texture_cache->prefetch(backdrop_file_name);
+    texture_cache->prefetch(blurred_backdrop_file_name);
+    texture_cache->prefetch(background_grid_file_name);
 
-    Frame_buffer<Color> backdrop_grid_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("/textures/background_grid.png")));
-    _background_grid_texture = _gl_functions.create_texture(backdrop_grid_tex_fb);
+    _ice_texture = texture_cache->get_texture(_gl_functions, ice_file_name);
+    _backdrop_texture = texture_cache->get_texture(_gl_functions, backdrop_file_name);
+    _blurred_backdrop_texture = texture_cache->get_texture(_gl_functions, blurred_backdrop_file_name);
+    _background_grid_texture = texture_cache->get_texture(_gl_functions, background_grid_file_name);
 
     resize(size);
 
@@ -786,7 +803,7 @@ void Shader_renderer::init(const QGLContext *context, const QSize &size)
 
 void Shader_renderer::resize(const QSize &size)
 {
-    std::cout << __FUNCTION__ << std::endl;
+    LOG_DEBUG("");
 
     World_renderer::resize(size);
 
@@ -814,19 +831,28 @@ void Shader_renderer::resize(const QSize &size)
     _post_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
     _temperature_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
 
+    // scene, post and temperature FBOs with their depth buffers, 8 bit RGBA and 32 bit depth
+    _render_target_memory.set(size_t(size.width()) * size_t(size.height()) * 6 * 4);
+
     _level_element_draw_visitor.resize(size);
 }
 
 void Shader_renderer::update(const Level_data &level_data)
 {
-    glDeleteTextures(1, &_backdrop_texture);
-    QImage background(Data_config::get_instance()->get_absolute_qfilename("textures/" + QString::fromStdString(level_data._background_name)));
-    Frame_buffer<Color> backdrop_tex_fb = convert<QColor_to_Color_converter, Color>(background);
-    _backdrop_texture = _gl_functions.create_texture(backdrop_tex_fb);
-
-    QImage blurred_background = background.scaled(background.size() * 0.05f);
-    Frame_buffer<Color> blurred_backdrop_tex_fb = convert<QColor_to_Color_converter, Color>(blurred_background);
-    _blurred_backdrop_texture = _gl_functions.create_texture(blurred_backdrop_tex_fb);
+    prefetch_backdrop(level_data._background_name);
+
+    QString const background_file_name = get_backdrop_file_name(level_data._background_name);
+
+    _backdrop_texture = Texture_cache::get_instance()->get_texture(_gl_functions, background_file_name);
+    _blurred_backdrop_texture = Texture_cache::get_instance()->get_texture(_gl_functions, background_file_name, Blurred_backdrop_options);
+}
+
+void Shader_renderer::prefetch_backdrop(const std::string &background_name)
+{
+    QString const background_file_name = get_backdrop_file_name(background_name);
+
+    Texture_cache::get_instance()->prefetch(background_file_name);
+    Texture_cache::get_instance()->prefetch(background_file_name, Blurred_backdrop_options);
 }
 
 void Shader_renderer::draw_atom(const Atom &atom, const float scale, const float alpha)
@@ -883,7 +909,7 @@ void Shader_renderer::draw_temperature_cube(GL_mesh2 & gl_mesh, Level_data const
 {
     if (level_data._game_field_borders.size() != 6)
     {
-        std::cout << __FUNCTION__ << " no game field borders or too many/few, not drawing temperature mesh" << std::endl;
+        LOG_DEBUG("no game field borders or too many/few, not drawing temperature mesh");
         return;
     }
 
@@ -901,9 +927,9 @@ void Shader_renderer::draw_temperature_cube(GL_mesh2 & gl_mesh, Level_data const
     _temperature_program->setUniformValue("time", time);
 
     Eigen::Vector3f game_field_size(
-                level_data._parameters["Game Field Width"]->get_value<float>(),
-            level_data._parameters["Game Field Depth"]->get_value<float>(),
-            level_data._parameters["Game Field Height"]->get_value<float>());
+                level_data._game_field_width_handle.get(),
+                level_data._game_field_depth_handle.get(),
+                level_data._game_field_height_handle.get());
 
     GLfloat m_projection[16];
     glGetFloatv(GL_PROJECTION_MATRIX, m_projection);
@@ -968,7 +994,7 @@ void Shader_renderer::draw_temperature(const Level_data &level_data) const
 
     float resolution = 1.0f;
 
-    std::cout << __FUNCTION__ << " " << grid_start << " " << grid_end << std::endl;
+    LOG_DEBUG(grid_start << " " << grid_end);
 
     for (float x = grid_start[0]; x < grid_end[0]; x += resolution)
     {
@@ -1030,7 +1056,7 @@ void Shader_renderer::draw_backdrop_quad() const
 
 void Shader_renderer::draw_gravity(Level_data const& l) const
 {
-    Parameter const* p = l._parameters["gravity"];
+    Parameter const* p = l._gravity_handle.get_parameter();
 
     float gravity = p->get_value<float>();
 
@@ -1057,6 +1083,8 @@ void Shader_renderer::draw_gravity(Level_data const& l) const
 
 void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &level_data, const float time, const qglviewer::Camera *camera)
 {
+    PROFILE_ZONE("Shader_renderer::render");
+
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
 
@@ -1104,6 +1132,8 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
 
     _molecule_program->bind();
     {
+        PROFILE_ZONE("Shader_renderer::molecules");
+
         GLfloat m_projection[16];
         glGetFloatv(GL_PROJECTION_MATRIX, m_projection);
 
@@ -1129,11 +1159,17 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
 
     glDisable(GL_TEXTURE_2D);
 
-    draw_level_elements(level_data);
+    {
+        PROFILE_ZONE("Shader_renderer::level_elements");
+        draw_level_elements(level_data);
+    }
 
     glDisable(GL_LIGHTING);
 
-    draw_particle_systems(level_data);
+    {
+        PROFILE_ZONE("Shader_renderer::particle_systems");
+        draw_particle_systems(level_data);
+    }
 
     _scene_fbo->release();
 
@@ -1145,6 +1181,8 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _tmp_screen_texture[0].get_id(), 0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    PROFILE_ZONE("Shader_renderer::post_processing");
+
     _blur_program->bind();
     _blur_program->setUniformValue("texture", 0);
     glActiveTexture(GL_TEXTURE0);
@@ -1195,7 +1233,10 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
 
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    draw_temperature_cube(_cube_grid_mesh, level_data, _tmp_screen_texture[1].get_id(), _screen_size, time);
+    {
+        PROFILE_ZONE("Shader_renderer::temperature");
+        draw_temperature_cube(_cube_grid_mesh, level_data, _tmp_screen_texture[1].get_id(), _screen_size, time);
+    }
 
 
     _temperature_fbo->release();
@@ -1226,7 +1267,10 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
     glEnable(GL_TEXTURE_2D);
     glDisable(GL_LIGHTING);
 
-    draw_elements_ui(level_data);
+    {
+        PROFILE_ZONE("Shader_renderer::elements_ui");
+        draw_elements_ui(level_data);
+    }
 
     glEnable(GL_DEPTH_TEST);
 
@@ -1236,14 +1280,14 @@ void Shader_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
 
 Editor_renderer::~Editor_renderer()
 {
-    glDeleteBuffers(1, &_ice_texture);
-    glDeleteBuffers(1, &_backdrop_texture);
     glDeleteBuffers(2, _tmp_screen_texture);
     glDeleteBuffers(1, &_depth_texture);
 }
 
 void Editor_renderer::init(const QGLContext *context, const QSize &size)
 {
+    PROFILE_ZONE("Editor_renderer::init");
+
     World_renderer::init(context, size);
 
     GL_functions f;
@@ -1265,8 +1309,8 @@ void Editor_renderer::init(const QGLContext *context, const QSize &size)
                                                                    Data_config::get_instance()->get_absolute_qfilename("shaders/fullscreen_square.vert"),
                                                                    Data_config::get_instance()->get_absolute_qfilename("shaders/depth_blur_1D.frag")));
 
-    _sphere_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj"));
-    _grid_mesh = load_mesh<MyMesh>(Data_config::get_instance()->get_absolute_filename("meshes/grid_10x10.obj"));
+    _sphere_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/icosphere_3.obj"));
+    _grid_mesh = Asset_preloader::get_instance()->get_mesh(Data_config::get_instance()->get_absolute_filename("meshes/grid_10x10.obj"));
 
     MyMesh::ConstVertexIter vIt(_grid_mesh.vertices_begin()), vEnd(_grid_mesh.vertices_end());
 
@@ -1278,11 +1322,8 @@ void Editor_renderer::init(const QGLContext *context, const QSize &size)
         _grid_mesh.set_texcoord2D(*vIt, t);
     }
 
-    Frame_buffer<Color> ice_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/ice_texture.png")));
-    _ice_texture = f.create_texture(ice_tex_fb);
-
-    Frame_buffer<Color> backdrop_tex_fb = convert<QColor_to_Color_converter, Color>(QImage(Data_config::get_instance()->get_absolute_qfilename("textures/iss_interior_1.png")));
-    _backdrop_texture = f.create_texture(backdrop_tex_fb);
+    _ice_texture = Texture_cache::get_instance()->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/ice_texture.png"));
+    _backdrop_texture = Texture_cache::get_instance()->get_texture(f, Data_config::get_instance()->get_absolute_qfilename("textures/iss_interior_1.png"));
 
     resize(size);
 
@@ -1320,6 +1361,9 @@ void Editor_renderer::resize(const QSize &size)
     _post_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
     _temperature_fbo = std::unique_ptr<QGLFramebufferObject>(new QGLFramebufferObject(size, QGLFramebufferObject::Depth));
 
+    // scene, post and temperature FBOs with their depth buffers, 8 bit RGBA and 32 bit depth
+    _render_target_memory.set(size_t(size.width()) * size_t(size.height()) * 6 * 4);
+
     _level_element_draw_visitor.resize(size);
 }
 
@@ -1373,7 +1417,7 @@ void Editor_renderer::draw_temperature_mesh(const MyMesh &mesh, const Level_data
 {
     if (level_data._game_field_borders.size() != 6)
     {
-        std::cout << __FUNCTION__ << " no game field borders or too many/few, not drawing temperature mesh: " << level_data._game_field_borders.size() << std::endl;
+        LOG_DEBUG("no game field borders or too many/few, not drawing temperature mesh: " << level_data._game_field_borders.size());
         return;
     }
 
@@ -1457,7 +1501,7 @@ void Editor_renderer::draw_temperature(const Level_data &level_data) const
 
     float resolution = 1.0f;
 
-    std::cout << __FUNCTION__ << " " << grid_start << " " << grid_end << std::endl;
+    LOG_DEBUG(grid_start << " " << grid_end);
 
     for (float x = grid_start[0]; x < grid_end[0]; x += resolution)
     {
@@ -1519,7 +1563,7 @@ void Editor_renderer::draw_backdrop_quad() const
 
 void Editor_renderer::draw_gravity(const Level_data &l) const
 {
-    Parameter const* p = l._parameters["gravity"];
+    Parameter const* p = l._gravity_handle.get_parameter();
 
     float gravity = p->get_value<float>();
 
@@ -1546,6 +1590,8 @@ void Editor_renderer::draw_gravity(const Level_data &l) const
 
 void Editor_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &level_data, const float time, const qglviewer::Camera *camera)
 {
+    PROFILE_ZONE("Editor_renderer::render");
+
     glEnable(GL_DEPTH_TEST);
 
     glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -1574,6 +1620,8 @@ void Editor_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
 
     _molecule_program->bind();
     {
+        PROFILE_ZONE("Editor_renderer::molecules");
+
         GLfloat m_projection[16];
         glGetFloatv(GL_PROJECTION_MATRIX, m_projection);
 
@@ -1592,12 +1640,18 @@ void Editor_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
     }
     _molecule_program->release();
 
-    draw_level_elements(level_data);
+    {
+        PROFILE_ZONE("Editor_renderer::level_elements");
+        draw_level_elements(level_data);
+    }
 
     glDisable(GL_LIGHTING);
     glEnable(GL_BLEND);
 
-    draw_particle_systems(level_data);
+    {
+        PROFILE_ZONE("Editor_renderer::particle_systems");
+        draw_particle_systems(level_data);
+    }
 
     _scene_fbo->release();
 
@@ -1609,7 +1663,10 @@ void Editor_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
                                           _scene_fbo.get(), QRect(0, 0, _screen_size.width(), _screen_size.height()),
                                           GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    draw_temperature_mesh(_grid_mesh, level_data, _scene_fbo->texture(), _screen_size, time);
+    {
+        PROFILE_ZONE("Editor_renderer::temperature");
+        draw_temperature_mesh(_grid_mesh, level_data, _scene_fbo->texture(), _screen_size, time);
+    }
 
     _temperature_fbo->release();
 
@@ -1637,7 +1694,10 @@ void Editor_renderer::render(QGLFramebufferObject *main_fbo, const Level_data &l
     glEnable(GL_TEXTURE_2D);
     glDisable(GL_LIGHTING);
 
-    draw_elements_ui(level_data);
+    {
+        PROFILE_ZONE("Editor_renderer::elements_ui");
+        draw_elements_ui(level_data);
+    }
 
     glEnable(GL_DEPTH_TEST);
 
@@ -12,12 +12,16 @@
 #include "Level_data.h"
 #include "Level_element_draw_visitor.h"
 #include "GL_texture.h"
+#include "Memory_accounting.h"
 
 //void setup_gl_points(bool const distance_dependent);
 
 class World_renderer : public QOpenGLFunctions_3_3_Core
 {
 public:
+    World_renderer() : _render_target_memory(Memory_subsystem::Render_targets)
+    { }
+
     virtual ~World_renderer() {}
 
     virtual void init(QGLContext const* context, QSize const& size);
@@ -60,6 +64,8 @@ protected:
     QSize _screen_size;
 
     std::unique_ptr<QGLShaderProgram> _particle_program;
+
+    Memory_account _render_target_memory; // FBOs and depth textures, set in resize()
 };
 
 
@@ -178,6 +184,9 @@ public:
     void resize(QSize const& size) override;
     void update(Level_data const& level_data) override;
 
+    // starts decoding the backdrop textures of a level on worker threads, update() then only uploads them
+    static void prefetch_backdrop(std::string const& background_name);
+
     float get_brownian_strength(Eigen::Vector3f const& pos, std::vector<Brownian_element*> const& elements, float const general_temperature) const;
 
     void draw_atom(Atom const& atom, float const scale, float const alpha = 1.0f);
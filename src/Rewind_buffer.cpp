@@ -0,0 +1,344 @@
+#include "Rewind_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+float const Position_scale = 256.0f;   // 1/256 units
+float const Rotation_scale = 32767.0f;
+
+void write_varint(std::vector<unsigned char> & data, int const value)
+{
+    // zigzag, small negative and positive deltas both become small numbers
+    unsigned int v = (static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 31);
+
+    while (v >= 0x80)
+    {
+        data.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+
+    data.push_back(static_cast<unsigned char>(v));
+}
+
+int read_varint(unsigned char const*& data)
+{
+    unsigned int v = 0;
+    int shift = 0;
+
+    while (*data & 0x80)
+    {
+        v |= static_cast<unsigned int>(*data & 0x7f) << shift;
+        shift += 7;
+        ++data;
+    }
+
+    v |= static_cast<unsigned int>(*data) << shift;
+    ++data;
+
+    return static_cast<int>(v >> 1) ^ -static_cast<int>(v & 1);
+}
+
+}
+
+
+Rewind_buffer::Rewind_buffer() :
+    _budget(64 * 1024 * 1024),
+    _keyframe_interval(20),
+    _memory_usage(0)
+{ }
+
+void Rewind_buffer::set_budget(const size_t bytes)
+{
+    _budget = bytes;
+    trim();
+}
+
+void Rewind_buffer::set_keyframe_interval(const int frames)
+{
+    _keyframe_interval = std::max(1, frames);
+}
+
+void Rewind_buffer::clear()
+{
+    _groups.clear();
+    _memory_usage = 0;
+}
+
+void Rewind_buffer::capture(const Core &core, const float time_step)
+{
+    if (_budget == 0) return;
+
+    if (needs_keyframe(core.get_molecules()))
+    {
+        add_keyframe(core, time_step);
+    }
+    else
+    {
+        add_frame(core, time_step);
+    }
+
+    trim();
+}
+
+const Core::Checkpoint *Rewind_buffer::find_keyframe(const float time) const
+{
+    for (auto iter = _groups.rbegin(); iter != _groups.rend(); ++iter)
+    {
+        if ((*iter)->_time <= time)
+        {
+            return &(*iter)->_keyframe;
+        }
+    }
+
+    return nullptr;
+}
+
+bool Rewind_buffer::apply_frame(const float time, std::list<Molecule> &molecules) const
+{
+    auto const group_iter = std::find_if(_groups.rbegin(), _groups.rend(), [time](std::unique_ptr<Group> const& g) { return g->_time <= time; });
+
+    if (group_iter == _groups.rend()) return false;
+
+    Group const& group = **group_iter;
+
+    if (molecules.size() != group._molecule_ids.size()) return false;
+
+    // frames are in time order, the keyframe itself has no pose frame
+    auto const frame_iter = std::find_if(group._frames.rbegin(), group._frames.rend(), [time](Frame const& f) { return f._time <= time; });
+
+    if (frame_iter == group._frames.rend()) return true;
+
+    unsigned char const* data = frame_iter->_data.data();
+    int const* base = group._base.data();
+    int components[Num_components];
+
+    for (Molecule & m : molecules)
+    {
+        for (int i = 0; i < Num_components; ++i)
+        {
+            components[i] = base[i] + read_varint(data);
+        }
+
+        dequantize(components, m);
+
+        base += Num_components;
+    }
+
+    return true;
+}
+
+std::vector<Rewind_buffer::Step_size> Rewind_buffer::get_step_sizes(const float time) const
+{
+    std::vector<Step_size> result;
+
+    auto const group_iter = std::find_if(_groups.rbegin(), _groups.rend(), [time](std::unique_ptr<Group> const& g) { return g->_time <= time; });
+
+    if (group_iter == _groups.rend()) return result;
+
+    Group const& group = **group_iter;
+
+    result.reserve(group._frames.size() + 1);
+    result.push_back({ group._step, group._time_step });
+
+    for (Frame const& f : group._frames)
+    {
+        result.push_back({ f._step, f._time_step });
+    }
+
+    return result;
+}
+
+void Rewind_buffer::truncate(const unsigned long long step)
+{
+    while (!_groups.empty() && _groups.back()->_step > step)
+    {
+        _memory_usage -= _groups.back()->_memory_usage;
+        _groups.pop_back();
+    }
+
+    if (_groups.empty()) return;
+
+    Group & group = *_groups.back();
+
+    while (!group._frames.empty() && group._frames.back()._step > step)
+    {
+        size_t const frame_memory = sizeof(Frame) + group._frames.back()._data.capacity();
+        group._memory_usage -= frame_memory;
+        _memory_usage -= frame_memory;
+        group._frames.pop_back();
+    }
+}
+
+float Rewind_buffer::get_oldest_time() const
+{
+    return _groups.empty() ? 0.0f : _groups.front()->_time;
+}
+
+float Rewind_buffer::get_newest_time() const
+{
+    if (_groups.empty()) return 0.0f;
+
+    Group const& group = *_groups.back();
+
+    return group._frames.empty() ? group._time : group._frames.back()._time;
+}
+
+int Rewind_buffer::get_num_frames() const
+{
+    int result = 0;
+
+    for (std::unique_ptr<Group> const& g : _groups)
+    {
+        result += 1 + int(g->_frames.size());
+    }
+
+    return result;
+}
+
+void Rewind_buffer::quantize(const Molecule &molecule, int *components)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        components[i] = int(std::lround(molecule._x[i] * Position_scale));
+    }
+
+    // q and -q are the same rotation, w >= 0 keeps the deltas small
+    Eigen::Quaternion<float> q = molecule._q.normalized();
+
+    if (q.w() < 0.0f)
+    {
+        q.coeffs() = -q.coeffs();
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        components[3 + i] = int(std::lround(q.coeffs()[i] * Rotation_scale));
+    }
+}
+
+void Rewind_buffer::dequantize(const int *components, Molecule &molecule)
+{
+    molecule._x = Eigen::Vector3f(float(components[0]), float(components[1]), float(components[2])) / Position_scale;
+
+    Eigen::Quaternion<float> q;
+    q.coeffs() = Eigen::Vector4f(float(components[3]), float(components[4]), float(components[5]), float(components[6])) / Rotation_scale;
+
+    molecule.apply_orientation(q.normalized());
+}
+
+bool Rewind_buffer::needs_keyframe(const std::list<Molecule> &molecules) const
+{
+    if (_groups.empty()) return true;
+
+    Group const& group = *_groups.back();
+
+    if (int(group._frames.size()) + 1 >= _keyframe_interval) return true;
+    if (molecules.size() != group._molecule_ids.size()) return true;
+
+    auto id_iter = group._molecule_ids.begin();
+
+    for (Molecule const& m : molecules)
+    {
+        if (m.get_id() != *id_iter) return true;
+        ++id_iter;
+    }
+
+    return false;
+}
+
+void Rewind_buffer::add_keyframe(const Core &core, const float time_step)
+{
+    std::unique_ptr<Group> group(new Group);
+
+    core.save_checkpoint(group->_keyframe);
+    group->_time = core.get_current_time();
+    group->_step = core.get_num_steps();
+    group->_time_step = time_step;
+
+    std::list<Molecule> const& molecules = core.get_molecules();
+
+    group->_molecule_ids.reserve(molecules.size());
+    group->_base.resize(molecules.size() * Num_components);
+
+    int * base = group->_base.data();
+
+    for (Molecule const& m : molecules)
+    {
+        group->_molecule_ids.push_back(m.get_id());
+        quantize(m, base);
+        base += Num_components;
+    }
+
+    group->_memory_usage = sizeof(Group) + estimate_memory_usage(group->_keyframe) +
+            group->_molecule_ids.capacity() * sizeof(int) + group->_base.capacity() * sizeof(int);
+
+    _memory_usage += group->_memory_usage;
+    _groups.push_back(std::move(group));
+}
+
+void Rewind_buffer::add_frame(const Core &core, const float time_step)
+{
+    Group & group = *_groups.back();
+
+    std::list<Molecule> const& molecules = core.get_molecules();
+
+    Frame frame;
+    frame._time = core.get_current_time();
+    frame._step = core.get_num_steps();
+    frame._time_step = time_step;
+    frame._data.reserve(molecules.size() * Num_components * 2);
+
+    int const* base = group._base.data();
+    int components[Num_components];
+
+    for (Molecule const& m : molecules)
+    {
+        quantize(m, components);
+
+        for (int i = 0; i < Num_components; ++i)
+        {
+            write_varint(frame._data, components[i] - base[i]);
+        }
+
+        base += Num_components;
+    }
+
+    frame._data.shrink_to_fit();
+
+    size_t const frame_memory = sizeof(Frame) + frame._data.capacity();
+    group._memory_usage += frame_memory;
+    _memory_usage += frame_memory;
+
+    group._frames.push_back(std::move(frame));
+}
+
+void Rewind_buffer::trim()
+{
+    // the newest group stays even when it alone is over the budget
+    while (_groups.size() > 1 && _memory_usage > _budget)
+    {
+        _memory_usage -= _groups.front()->_memory_usage;
+        _groups.pop_front();
+    }
+}
+
+size_t Rewind_buffer::estimate_memory_usage(const Core::Checkpoint &checkpoint)
+{
+    size_t result = checkpoint._element_states.get_memory_usage() + checkpoint._sensor_data.get_memory_usage();
+
+    for (Molecule const& m : checkpoint._molecules)
+    {
+        result += sizeof(Molecule) + 2 * sizeof(void*) + m._atoms.capacity() * sizeof(Atom);
+    }
+
+    for (auto const& f : checkpoint._molecule_external_forces)
+    {
+        result += sizeof(f) + f.second.capacity() * sizeof(Molecule_external_force);
+    }
+
+    return result;
+}
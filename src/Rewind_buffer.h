@@ -0,0 +1,101 @@
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "Core.h"
+
+// Simulation history for rewinding, captured by Core every few physics steps. A group starts with a full keyframe
+// (Core::Checkpoint), the following frames only store the molecule poses: positions and rotations quantized and
+// delta-encoded against the keyframe as zigzag varints, mostly one or two bytes per component. A new keyframe is
+// taken after a fixed number of frames and whenever the set of molecules changes. The oldest groups are dropped
+// to stay within the memory budget.
+// The pose frames are for previews, an exact restore goes to a keyframe and replays the physics steps (Core::rewind()).
+class Rewind_buffer
+{
+public:
+    Rewind_buffer();
+
+    // step number and size of a captured frame, the steps since the previous frame used the same size
+    struct Step_size
+    {
+        unsigned long long _step;
+        float _time_step;
+    };
+
+    // a budget of 0 turns capturing off
+    void set_budget(size_t const bytes);
+    bool is_enabled() const { return _budget > 0; }
+    void set_keyframe_interval(int const frames);
+
+    void clear();
+
+    // a keyframe when needed, otherwise a pose frame, time_step is the size of the step that was just taken
+    void capture(Core const& core, float const time_step);
+
+    // latest keyframe at or before the time, nullptr when the time is before the history
+    Core::Checkpoint const* find_keyframe(float const time) const;
+
+    // poses of the latest frame at or before the time onto the molecules restored from find_keyframe(time)
+    bool apply_frame(float const time, std::list<Molecule> & molecules) const;
+
+    // the step sizes from the keyframe at or before the time to the newest frame of its group, for replaying
+    std::vector<Step_size> get_step_sizes(float const time) const;
+
+    // drops everything captured after the step, the history continues from there
+    void truncate(unsigned long long const step);
+
+    bool is_empty() const { return _groups.empty(); }
+    float get_oldest_time() const;
+    float get_newest_time() const;
+
+    size_t get_memory_usage() const { return _memory_usage; }
+    int get_num_keyframes() const { return int(_groups.size()); }
+    int get_num_frames() const;
+
+private:
+    static int const Num_components = 7; // position xyz, rotation xyzw
+
+    struct Frame
+    {
+        float _time;
+        unsigned long long _step;
+        float _time_step;
+        std::vector<unsigned char> _data;
+    };
+
+    struct Group
+    {
+        Core::Checkpoint _keyframe;
+        float _time;
+        unsigned long long _step;
+        float _time_step;
+
+        std::vector<int> _molecule_ids;
+        std::vector<int> _base; // quantized poses at the keyframe, Num_components per molecule
+        std::vector<Frame> _frames;
+
+        size_t _memory_usage;
+    };
+
+    static void quantize(Molecule const& molecule, int * components);
+    static void dequantize(int const* components, Molecule & molecule);
+
+    bool needs_keyframe(std::list<Molecule> const& molecules) const;
+    void add_keyframe(Core const& core, float const time_step);
+    void add_frame(Core const& core, float const time_step);
+    void trim();
+
+    static size_t estimate_memory_usage(Core::Checkpoint const& checkpoint);
+
+    std::deque< std::unique_ptr<Group> > _groups;
+
+    size_t _budget;
+    int _keyframe_interval;
+    size_t _memory_usage;
+};
+
+#endif // REWIND_BUFFER_H
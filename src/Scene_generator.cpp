@@ -0,0 +1,197 @@
+#include "Scene_generator.h"
+
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+#ifndef Q_MOC_RUN
+#include <boost/archive/xml_oarchive.hpp>
+#endif
+
+#include "Utilities.h"
+#include "Message_logger.h"
+
+namespace
+{
+
+// uniformly distributed rotation (Shoemake)
+Eigen::Quaternion<float> random_orientation(std::mt19937 & rng)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    float const u_0 = uniform(rng);
+    float const u_1 = uniform(rng) * 2.0f * float(M_PI);
+    float const u_2 = uniform(rng) * 2.0f * float(M_PI);
+
+    float const a = std::sqrt(1.0f - u_0);
+    float const b = std::sqrt(u_0);
+
+    return Eigen::Quaternion<float>(a * std::sin(u_1), a * std::cos(u_1), b * std::sin(u_2), b * std::cos(u_2));
+}
+
+// t is in [0, sum of the weights), the salt alternates between Na+ and Cl- to keep the scene neutral
+Molecule create_molecule(Scene_settings const& settings, float const t, int const index, Eigen::Vector3f const& position)
+{
+    if (t < settings.water_weight)
+    {
+        return Molecule::create_water(position);
+    }
+    else if (t < settings.water_weight + settings.sulfate_weight)
+    {
+        return Molecule::create_sulfate(position);
+    }
+    else if (t < settings.water_weight + settings.sulfate_weight + settings.salt_weight)
+    {
+        return (index % 2 == 0) ? Molecule::create_charged_natrium(position) : Molecule::create_charged_chlorine(position);
+    }
+    else if (t < settings.water_weight + settings.sulfate_weight + settings.salt_weight + settings.dipole_weight)
+    {
+        return Molecule::create_dipole(position);
+    }
+
+    return Molecule::create_water(position); // all weights zero
+}
+
+// game field extent (x: width, y: depth, z: height) for the volume, clamped to the Level_data parameter ranges
+Eigen::Vector3f calc_game_field_extent(Level_data const& level_data, float const volume)
+{
+    Parameter const* width_parameter  = level_data._parameters["Game Field Width"];
+    Parameter const* height_parameter = level_data._parameters["Game Field Height"];
+    Parameter const* depth_parameter  = level_data._parameters["Game Field Depth"];
+
+    float depth = into_range(std::cbrt(volume) * 0.5f, depth_parameter->get_min<float>(), depth_parameter->get_max<float>());
+
+    float const area = volume / depth;
+
+    float height = into_range(std::sqrt(area * 0.5f), height_parameter->get_min<float>(), height_parameter->get_max<float>());
+    float const width = into_range(area / height, width_parameter->get_min<float>(), width_parameter->get_max<float>());
+
+    // width hit its limit, distribute the rest over height and then depth
+    height = into_range(volume / (depth * width), height_parameter->get_min<float>(), height_parameter->get_max<float>());
+    depth = into_range(volume / (width * height), depth_parameter->get_min<float>(), depth_parameter->get_max<float>());
+
+    return Eigen::Vector3f(width, depth, height);
+}
+
+// a box spanning the full depth, like the elements placed in the editor
+Eigen::AlignedBox<float, 3> random_element_box(std::mt19937 & rng, Eigen::Vector3f const& field_extent, float const size)
+{
+    std::uniform_real_distribution<float> x(-0.5f * field_extent[0] + size, 0.5f * field_extent[0] - size);
+    std::uniform_real_distribution<float> z(-0.5f * field_extent[2] + size, 0.5f * field_extent[2] - size);
+
+    Eigen::Vector3f const center(x(rng), 0.0f, z(rng));
+    Eigen::Vector3f const half_extent(0.5f * size, 0.5f * field_extent[1], 0.5f * size);
+
+    return Eigen::AlignedBox<float, 3>(center - half_extent, center + half_extent);
+}
+
+}
+
+
+void generate_scene(Scene_settings const& settings, Level_data & level_data)
+{
+    std::mt19937 rng(settings.seed);
+
+    Eigen::Vector3f const extent = calc_game_field_extent(level_data, settings.num_molecules / settings.density);
+
+    level_data._parameters["Game Field Width"]->set_value(extent[0]);
+    level_data._parameters["Game Field Depth"]->set_value(extent[1]);
+    level_data._parameters["Game Field Height"]->set_value(extent[2]);
+
+    float const element_size = 0.1f * std::min(extent[0], extent[2]);
+
+    std::vector< Eigen::AlignedBox<float, 3> > blocked_boxes; // no molecules are placed inside barriers
+
+    for (int i = 0; i < settings.num_barriers; ++i)
+    {
+        Eigen::AlignedBox<float, 3> const box = random_element_box(rng, extent, element_size);
+        level_data.add_barrier(new Box_barrier(box.min(), box.max(), 10000.0f, 2.0f));
+        blocked_boxes.push_back(box);
+    }
+
+    for (int i = 0; i < settings.num_portals; ++i)
+    {
+        Eigen::AlignedBox<float, 3> const box = random_element_box(rng, extent, element_size);
+        Box_portal * portal = new Box_portal(box.min(), box.max());
+        portal->get_condition().set_min_captured_molecules(std::max(1, settings.num_molecules / (10 * settings.num_portals)));
+        level_data.add_portal(portal);
+    }
+
+    for (int i = 0; i < settings.num_brownian_boxes; ++i)
+    {
+        Eigen::AlignedBox<float, 3> const box = random_element_box(rng, extent, element_size);
+        level_data.add_brownian_element(new Brownian_box(box.min(), box.max(), 10.0f, 25.0f));
+    }
+
+    // molecules go into the cells of a regular grid, randomly picked and jittered, so they don't overlap
+    float const margin = 2.0f;
+    Eigen::Vector3f const usable_extent = extent - Eigen::Vector3f::Constant(2.0f * margin);
+
+    float cell_size = std::cbrt(usable_extent.prod() / std::max(1, settings.num_molecules));
+
+    std::vector<Eigen::Vector3f> cell_centers;
+
+    while (cell_size > 0.1f)
+    {
+        cell_centers.clear();
+
+        Eigen::Vector3i const num_cells = (usable_extent / cell_size).cast<int>().cwiseMax(1);
+
+        for (int x = 0; x < num_cells[0]; ++x)
+        {
+            for (int y = 0; y < num_cells[1]; ++y)
+            {
+                for (int z = 0; z < num_cells[2]; ++z)
+                {
+                    Eigen::Vector3f const center = -0.5f * usable_extent + cell_size * Eigen::Vector3f(x + 0.5f, y + 0.5f, z + 0.5f);
+
+                    bool blocked = false;
+
+                    for (Eigen::AlignedBox<float, 3> const& b : blocked_boxes)
+                    {
+                        if (b.exteriorDistance(center) < margin) blocked = true;
+                    }
+
+                    if (!blocked) cell_centers.push_back(center);
+                }
+            }
+        }
+
+        if (int(cell_centers.size()) >= settings.num_molecules) break;
+
+        cell_size *= 0.95f;
+    }
+
+    std::shuffle(cell_centers.begin(), cell_centers.end(), rng);
+
+    float const weight_sum = settings.water_weight + settings.sulfate_weight + settings.salt_weight + settings.dipole_weight;
+
+    std::uniform_real_distribution<float> type_distribution(0.0f, weight_sum > 0.0f ? weight_sum : 1.0f);
+    std::uniform_real_distribution<float> jitter(-0.2f * cell_size, 0.2f * cell_size);
+
+    int const num_molecules = std::min(settings.num_molecules, int(cell_centers.size()));
+
+    for (int i = 0; i < num_molecules; ++i)
+    {
+        Eigen::Vector3f const position = cell_centers[i] + Eigen::Vector3f(jitter(rng), jitter(rng), jitter(rng));
+
+        Molecule m = create_molecule(settings, type_distribution(rng), i, position);
+        m.apply_orientation(random_orientation(rng));
+
+        level_data._molecules.push_back(m);
+    }
+
+    if (num_molecules < settings.num_molecules)
+    {
+        LOG_WARNING("only placed " << num_molecules << " of " << settings.num_molecules << " molecules");
+    }
+}
+
+
+void save_level_data(Level_data const& level_data, std::string const& file_name)
+{
+    std::ofstream out_file(file_name.c_str(), std::fstream::binary | std::fstream::out);
+    boost::archive::xml_oarchive oa(out_file);
+
+    oa << boost::serialization::make_nvp("_level_data", level_data);
+}
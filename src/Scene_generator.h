@@ -0,0 +1,47 @@
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <string>
+
+#include "Level_data.h"
+
+// Synthetic levels for scaling tests: a game field sized for the requested molecule count and density,
+// filled with a mix of molecules from the Molecule factory and randomly placed barriers, portals and Brownian boxes.
+struct Scene_settings
+{
+    Scene_settings() :
+        num_molecules(1000),
+        density(0.03f),
+        water_weight(1.0f),
+        sulfate_weight(0.0f),
+        salt_weight(0.0f),
+        dipole_weight(0.0f),
+        num_barriers(0),
+        num_portals(1),
+        num_brownian_boxes(0),
+        seed(0)
+    { }
+
+    int num_molecules;
+    float density; // molecules per cubic unit, the game field is limited to the ranges of the Level_data parameters
+
+    // relative amounts of the molecule types, one salt unit is a Na+ / Cl- pair
+    float water_weight;
+    float sulfate_weight;
+    float salt_weight;
+    float dipole_weight;
+
+    int num_barriers;
+    int num_portals;
+    int num_brownian_boxes;
+
+    unsigned int seed;
+};
+
+// fills a freshly constructed Level_data
+void generate_scene(Scene_settings const& settings, Level_data & level_data);
+
+// same archive format as Core::save_level(), loadable with Core::load_level()
+void save_level_data(Level_data const& level_data, std::string const& file_name);
+
+#endif // SCENE_GENERATOR_H
@@ -14,50 +14,48 @@ void Score::calculate_score(const float time_factor, const int num_molecules_to_
 {
     float score = 0.0f;
 
-    full_time = sensor_data.get_data(Sensor_data::Type::ColMol).size() * sensor_data.get_check_interval();
+    full_time = sensor_data.get_num_samples() * sensor_data.get_check_interval();
 
     num_molecules_to_capture = num_molecules_to_capture_;
 
     int const points_per_molecule = int(1e6 / num_molecules_to_capture);
 
-    int highest_num_captured = 0;
-
-    std::vector<float> const& collected_molecules = sensor_data.get_data(Sensor_data::Type::ColMol);
-
-    for (size_t i = 0; i < collected_molecules.size(); ++i)
+    // the new highs are recorded as they happen, no need to walk the whole history
+    for (std::pair<unsigned long long, int> const& high : sensor_data.get_collected_highs())
     {
-        float const current_time = i * sensor_data.get_check_interval();
-
-        int const current_captured = int(collected_molecules[i]);
+        float const current_time = high.first * sensor_data.get_check_interval();
 
-        if (current_captured > highest_num_captured)
+        if (high.second > 0)
         {
-            highest_num_captured = current_captured;
-
             int const new_score = int(points_per_molecule * get_score_multiplier(current_time, time_factor) / 100) * 100;
             score += new_score;
             score_at_time.push_back(std::pair<float, int>(current_time, new_score));
         }
     }
 
-    std::vector<float> energy_values = sensor_data.get_data(Sensor_data::Type::EnergyCon);
+    // exactly the samples while they are all in the raw ring buffer, otherwise buckets of the downsampled tiers
+    std::vector<Time_series_bucket> const energy_values = sensor_data.get_data(Sensor_data::Type::EnergyCon).get_buckets(Time_series::Raw_capacity);
+    unsigned long long const num_energy_samples = sensor_data.get_data(Sensor_data::Type::EnergyCon).size();
 
     // energy of 1 or less gets no penalty, energy over 1 gets a penalty of up to 95% of the current time's score possibility
     // 95% equals energy == 5
 
 //    float avg_penalty = 0.0f;
     int penalty_sum = 0;
+    unsigned long long sample_index = 0;
 
-    for (size_t i = 0; i < energy_values.size(); ++i)
+    for (Time_series_bucket const& bucket : energy_values)
     {
-        float const current_time = i * sensor_data.get_check_interval();
+        float const current_time = (sample_index + 0.5f * (bucket._count - 1)) * sensor_data.get_check_interval();
 
-        float const penalty = into_range(energy_values[i] - 1.0f, 0.0f, 4.0f) / 4.0f * 0.95f * get_score_multiplier(current_time, time_factor);
+        float const penalty = into_range(bucket.get_average() - 1.0f, 0.0f, 4.0f) / 4.0f * 0.95f * get_score_multiplier(current_time, time_factor);
 //        avg_penalty += penalty;
-        int const discrete_penalty = int(penalty * score / (energy_values.size() * 100)) * 100;
+        int const discrete_penalty = int(penalty * bucket._count * score / (num_energy_samples * 100)) * 100;
         penalty_sum += discrete_penalty;
 
         penalty_at_time.push_back(std::pair<float, int>(current_time, discrete_penalty));
+
+        sample_index += bucket._count;
     }
 
 //    avg_penalty /= float(energy_values.size());
@@ -75,7 +73,7 @@ void Score::calculate_score(const float time_factor, const int num_molecules_to_
 
     final_score = int(score);
     _penalty = penalty_sum;
-    _energy_bonus = sensor_data.get_energy_bonus().back();
+    _energy_bonus = sensor_data.get_energy_bonus();
 }
 
 std::vector<std::pair<float, int> > const& Score::get_score_at_time() const
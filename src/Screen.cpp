@@ -1,5 +1,7 @@
 #include "Screen.h"
 
+#include "Profiler.h"
+
 
 void Screen::pause()
 {
@@ -34,6 +36,8 @@ void Screen::kill()
 
 void Screen::update(const float time_step)
 {
+    PROFILE_ZONE(get_name());
+
     if (_state != State::Running && _state != State::Paused && _state != State::Faded_out)
     {
         _transition_progress += 1.0f * time_step;
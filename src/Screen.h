@@ -28,6 +28,9 @@ public:
 
     virtual ~Screen() {}
 
+    // profiler zone of update() and debug output, a string literal
+    virtual char const* get_name() const = 0;
+
     Type get_type() const
     {
         return _type;
@@ -2,13 +2,20 @@
 #define SENSOR_DATA_H
 
 #include <vector>
+#include <utility>
 
 #ifndef Q_MOC_RUN
 #include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/version.hpp>
 #endif
 
 #include "Parameter.h"
+#include "Time_series.h"
 
+// Sensor values sampled every check interval. Each type is a bounded Time_series, so runs that never finish
+// (sandbox) don't grow without limit. The new highs of collected molecules are kept for the score.
 class Sensor_data
 {
 public:
@@ -17,30 +24,48 @@ public:
     Sensor_data() : _check_interval(0.2f)
     {
         _data.resize(4);
-        _energy_bonus.push_back(500000);
+        _energy_bonus.add(500000);
     }
 
     void add_value(Type const type, float const value)
     {
-        _data[int(type)].push_back(value);
+        Time_series & series = _data[int(type)];
+
+        if (type == Type::ColMol && (_collected_highs.empty() || int(value) > _collected_highs.back().second))
+        {
+            _collected_highs.push_back(std::pair<unsigned long long, int>(series.size(), int(value)));
+        }
+
+        series.add(value);
     }
 
-    std::vector<float> const& get_data(Type const type) const
+    Time_series const& get_data(Type const type) const
     {
         return _data[int(type)];
     }
 
+    unsigned long long get_num_samples() const
+    {
+        return _data[int(Type::ColMol)].size();
+    }
+
+    // sample index and number of collected molecules whenever it exceeded all previous samples
+    std::vector< std::pair<unsigned long long, int> > const& get_collected_highs() const
+    {
+        return _collected_highs;
+    }
+
     void update_energy_bonus()
     {
-        float const energy_consumption = _data[int(Type::EnergyCon)].back();
+        float const energy_consumption = _data[int(Type::EnergyCon)].get_last();
 
         int const penalty_per_second = 5000;
 
         int const penalty = std::round(penalty_per_second * std::max(0.0f, energy_consumption - 1.0001f) * _check_interval / 100.0f) * 100.0;
 
-        int const new_energy_bonus = std::max(0, _energy_bonus.back() - penalty);
+        int const new_energy_bonus = std::max(0, get_energy_bonus() - penalty);
 
-        _energy_bonus.push_back(new_energy_bonus);
+        _energy_bonus.add(new_energy_bonus);
     }
 
     void clear()
@@ -50,8 +75,10 @@ public:
             v.clear();
         }
 
+        _collected_highs.clear();
+
         _energy_bonus.clear();
-        _energy_bonus.push_back(500000);
+        _energy_bonus.add(500000);
     }
 
     int get_num_data_types() const
@@ -69,24 +96,84 @@ public:
         _game_field_volume = volume;
     }
 
-    std::vector<int> const& get_energy_bonus() const
+    // current bonus, exact integers as floats up to 2^24
+    int get_energy_bonus() const
+    {
+        return int(_energy_bonus.get_last());
+    }
+
+    // the first value is the bonus before the first sample
+    Time_series const& get_energy_bonus_series() const
     {
         return _energy_bonus;
     }
 
+    size_t get_memory_usage() const
+    {
+        size_t result = _energy_bonus.get_memory_usage() + _collected_highs.capacity() * sizeof(std::pair<unsigned long long, int>);
+
+        for (Time_series const& v : _data)
+        {
+            result += v.get_memory_usage();
+        }
+
+        return result;
+    }
+
     template<class Archive>
-    void serialize(Archive & ar, const unsigned int /* version */)
+    void save(Archive & ar, const unsigned int /* version */) const
     {
         ar & BOOST_SERIALIZATION_NVP(_data);
+        ar & BOOST_SERIALIZATION_NVP(_collected_highs);
+        ar & BOOST_SERIALIZATION_NVP(_energy_bonus);
+    }
+
+    template<class Archive>
+    void load(Archive & ar, const unsigned int version)
+    {
+        if (version < 1)
+        {
+            // plain vectors of all samples, replayed into the series
+            std::vector< std::vector<float> > data;
+            ar & boost::serialization::make_nvp("_data", data);
+
+            clear();
+
+            size_t const num_samples = data.empty() ? 0 : data[int(Type::ColMol)].size();
+
+            for (size_t i = 0; i < num_samples; ++i)
+            {
+                for (size_t type = 0; type < data.size(); ++type)
+                {
+                    if (i < data[type].size())
+                    {
+                        add_value(Type(type), data[type][i]);
+                    }
+                }
+
+                update_energy_bonus();
+            }
+
+            return;
+        }
+
+        ar & BOOST_SERIALIZATION_NVP(_data);
+        ar & BOOST_SERIALIZATION_NVP(_collected_highs);
+        ar & BOOST_SERIALIZATION_NVP(_energy_bonus);
     }
 
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
 private:
-    std::vector< std::vector<float> > _data;
+    std::vector<Time_series> _data;
+    std::vector< std::pair<unsigned long long, int> > _collected_highs;
 
-    std::vector<int> _energy_bonus;
+    Time_series _energy_bonus;
 
     float _game_field_volume;
     float _check_interval;
 };
 
+BOOST_CLASS_VERSION(Sensor_data, 1)
+
 #endif // SENSOR_DATA_H
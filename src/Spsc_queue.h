@@ -0,0 +1,65 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded single-producer single-consumer queue without locks: exactly one thread calls push(), exactly one
+// (other) thread calls pop(). Neither blocks, push() fails when the queue is full and pop() when it is empty.
+template<typename T>
+class Spsc_queue
+{
+public:
+    explicit Spsc_queue(size_t const capacity) :
+        _items(capacity + 1),
+        _head(0),
+        _tail(0)
+    { }
+
+    // moves from item only on success
+    bool push(T & item)
+    {
+        size_t const tail = _tail.load(std::memory_order_relaxed);
+        size_t const next = (tail + 1) % _items.size();
+
+        if (next == _head.load(std::memory_order_acquire)) return false;
+
+        _items[tail] = std::move(item);
+        _tail.store(next, std::memory_order_release);
+
+        return true;
+    }
+
+    bool pop(T & item)
+    {
+        size_t const head = _head.load(std::memory_order_relaxed);
+
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+
+        item = std::move(_items[head]);
+        _head.store((head + 1) % _items.size(), std::memory_order_release);
+
+        return true;
+    }
+
+    // only exact when neither side is active
+    bool is_empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    Spsc_queue(Spsc_queue const&);
+    Spsc_queue & operator=(Spsc_queue const&);
+
+    std::vector<T> _items;
+
+    // padded apart, the consumer writes _head and the producer _tail
+    std::atomic<size_t> _head;
+    char _padding[64];
+    std::atomic<size_t> _tail;
+};
+
+#endif // SPSC_QUEUE_H
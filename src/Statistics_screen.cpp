@@ -155,16 +155,7 @@ void Statistics_screen::update_event(const float time_step)
 
     const int index = (_time / _stat_anim_duration) * _score.get_full_time() / _score.sensor_data.get_check_interval();
 
-    int bonus = 0;
-
-    if (index < int(_score.sensor_data.get_energy_bonus().size()))
-    {
-        bonus = _score.sensor_data.get_energy_bonus()[index];
-    }
-    else
-    {
-        bonus = _score.sensor_data.get_energy_bonus().back();
-    }
+    int const bonus = int(_score.sensor_data.get_energy_bonus_series().get_value_at((unsigned long long)(std::max(0, index))));
 
     _penalty_label->set_text(QString("%1").arg(bonus, 7, 10, QChar('0')).toStdString());
     _renderer.generate_label_texture(_penalty_label.get());
@@ -174,7 +165,10 @@ void Statistics_screen::setup_statistics(Sensor_data const& sensor_data, Score c
 {
     for (int i = 0; i < sensor_data.get_num_data_types(); ++i)
     {
-        _statistics[i]->set_values(sensor_data.get_data(Sensor_data::Type(i)));
+        // one point per pixel of the plot at most, from the matching tier of the series
+        int const max_points = std::max(2, int(_viewer.camera()->screenWidth() * _statistics[i]->get_extent()[0]));
+
+        _statistics[i]->set_values(sensor_data.get_data(Sensor_data::Type(i)).get_values(max_points));
     }
 
     Draggable_statistics * stat = _statistics[int(Sensor_data::Type::ColMol)].get();
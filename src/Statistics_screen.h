@@ -9,6 +9,7 @@ class Statistics_screen : public Menu_screen
 {
 public:
     Statistics_screen(My_viewer & viewer, Core & core, Screen * calling_screen, Score const& score);
+    char const* get_name() const override { return "Statistics_screen"; }
 
     void init();
 
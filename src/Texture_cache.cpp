@@ -0,0 +1,282 @@
+#include "Texture_cache.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QSaveFile>
+
+#include "Data_config.h"
+#include "Message_logger.h"
+#include "Utilities.h"
+
+
+namespace
+{
+
+char const Texture_variant_magic[8] = { 'P', 'A', 'R', 'T', 'T', 'E', 'X', '\0' };
+unsigned int const Texture_variant_format_version = 2;
+unsigned int const Texture_variant_byte_order_tag = 0x01020304;
+
+// followed by the raw Color data, which is only read back on machines with the same byte order and Color layout
+struct Texture_variant_header
+{
+    char _magic[8];
+    unsigned int _format_version;
+    unsigned int _byte_order_tag;
+    unsigned int _color_size;
+    int _width;
+    int _height;
+    long long _source_size; // of the image file the variant was made from
+    long long _source_modified; // ms since epoch
+};
+
+}
+
+
+Texture_cache *Texture_cache::get_instance()
+{
+    static Texture_cache * const instance = new Texture_cache;
+
+    return instance;
+}
+
+Texture_cache::Texture_cache()
+{
+    _directory = Data_config::get_instance()->get_absolute_qfilename("texture_cache", false);
+}
+
+void Texture_cache::prefetch(const QString &file_name, const Texture_options &options)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry & entry = _entries[get_key(file_name, options)];
+
+    if (entry._texture != 0 || entry._data.valid()) return;
+
+    entry._data = std::async(std::launch::async, &Texture_cache::load_texture_data, file_name, options, _directory).share();
+}
+
+GLuint Texture_cache::get_texture(GL_functions &gl_functions, const QString &file_name, const Texture_options &options)
+{
+    std::string const key = get_key(file_name, options);
+
+    std::shared_future<Texture_data> data;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        Entry & entry = _entries[key];
+
+        if (entry._texture != 0) return entry._texture;
+
+        if (!entry._data.valid())
+        {
+            std::promise<Texture_data> loaded;
+            loaded.set_value(load_texture_data(file_name, options, _directory));
+            entry._data = loaded.get_future().share();
+        }
+
+        data = entry._data;
+    }
+
+    // a prefetch may still be running, the lock is only needed for the map
+    Texture_data const& result = data.get();
+
+    GLuint texture = 0;
+
+    if (options._with_alpha && result._color4.get_size() > 0)
+    {
+        texture = gl_functions.create_texture(result._color4, options._use_mipmaps);
+    }
+    else if (!options._with_alpha && result._color.get_size() > 0)
+    {
+        texture = gl_functions.create_texture(result._color, options._use_mipmaps);
+    }
+
+    if (texture == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Entry & entry = _entries[key];
+    entry._texture = texture;
+    entry._data = std::shared_future<Texture_data>();
+
+    return texture;
+}
+
+void Texture_cache::clear(GL_functions &gl_functions)
+{
+    std::map<std::string, Entry> entries;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entries.swap(_entries);
+    }
+
+    for (auto & iter : entries)
+    {
+        Entry & entry = iter.second;
+
+        if (entry._texture != 0)
+        {
+            gl_functions.delete_texture(entry._texture);
+        }
+        else if (entry._data.valid())
+        {
+            entry._data.wait();
+        }
+    }
+}
+
+void Texture_cache::set_directory(const QString &directory)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+}
+
+QString Texture_cache::get_directory() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _directory;
+}
+
+std::string Texture_cache::get_key(const QString &file_name, const Texture_options &options)
+{
+    return file_name.toStdString() + "|" + std::to_string(options._scale) + "|" + (options._use_mipmaps ? "m" : "") + (options._with_alpha ? "a" : "");
+}
+
+Texture_cache::Texture_data Texture_cache::load_texture_data(const QString &file_name, const Texture_options &options, const QString &directory)
+{
+    Texture_data data;
+
+    if (!options._with_alpha)
+    {
+        data._color = load_frame_buffer(file_name, options, directory);
+        return data;
+    }
+
+    QImage const image(file_name);
+
+    if (image.isNull())
+    {
+        LOG_WARNING("Couldn't read image: " << file_name.toStdString());
+        return data;
+    }
+
+    data._color4 = convert_to_color4((options._scale == 1.0f) ? image : image.scaled(image.size() * options._scale));
+
+    return data;
+}
+
+Frame_buffer<Color> Texture_cache::load_frame_buffer(const QString &file_name, const Texture_options &options, const QString &directory)
+{
+    if (options._scale == 1.0f)
+    {
+        return convert_to_color(QImage(file_name));
+    }
+
+    Frame_buffer<Color> frame_buffer;
+
+    QString const variant_file_name = get_variant_file_name(file_name, options, directory);
+
+    if (read_variant(variant_file_name, file_name, frame_buffer)) return frame_buffer;
+
+    QImage const image(file_name);
+
+    if (image.isNull())
+    {
+        LOG_WARNING("Couldn't read image: " << file_name.toStdString());
+        return frame_buffer;
+    }
+
+    frame_buffer = convert_to_color(image.scaled(image.size() * options._scale));
+
+    write_variant(variant_file_name, file_name, frame_buffer);
+
+    return frame_buffer;
+}
+
+bool Texture_cache::read_variant(const QString &variant_file_name, const QString &file_name, Frame_buffer<Color> &frame_buffer)
+{
+    QFile in_file(variant_file_name);
+
+    if (!in_file.open(QIODevice::ReadOnly)) return false;
+
+    QFileInfo const source_info(file_name);
+
+    Texture_variant_header header;
+
+    if (in_file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header)) ||
+            std::memcmp(header._magic, Texture_variant_magic, sizeof(Texture_variant_magic)) != 0 ||
+            header._format_version != Texture_variant_format_version ||
+            header._byte_order_tag != Texture_variant_byte_order_tag ||
+            header._color_size != sizeof(Color) ||
+            header._source_size != source_info.size() ||
+            header._source_modified != source_info.lastModified().toMSecsSinceEpoch() ||
+            header._width <= 0 || header._height <= 0)
+    {
+        return false;
+    }
+
+    std::vector<Color> data(size_t(header._width) * size_t(header._height));
+    qint64 const data_size = qint64(data.size() * sizeof(Color));
+
+    if (in_file.read(reinterpret_cast<char*>(data.data()), data_size) != data_size) return false;
+
+    frame_buffer.set_raw_data(header._width, header._height, std::move(data));
+
+    return true;
+}
+
+void Texture_cache::write_variant(const QString &variant_file_name, const QString &file_name, const Frame_buffer<Color> &frame_buffer)
+{
+    QDir const dir(QFileInfo(variant_file_name).absolutePath());
+
+    if (!dir.exists() && !dir.mkpath("."))
+    {
+        LOG_WARNING("Couldn't create the texture cache directory: " << dir.absolutePath().toStdString());
+        return;
+    }
+
+    QFileInfo const source_info(file_name);
+
+    Texture_variant_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header._magic, Texture_variant_magic, sizeof(Texture_variant_magic));
+    header._format_version = Texture_variant_format_version;
+    header._byte_order_tag = Texture_variant_byte_order_tag;
+    header._color_size = sizeof(Color);
+    header._width = frame_buffer.get_width();
+    header._height = frame_buffer.get_height();
+    header._source_size = source_info.size();
+    header._source_modified = source_info.lastModified().toMSecsSinceEpoch();
+
+    qint64 const data_size = qint64(frame_buffer.get_size() * sizeof(Color));
+
+    // written to a temporary file and renamed, like the level cache entries
+    QSaveFile out_file(variant_file_name);
+
+    if (!out_file.open(QIODevice::WriteOnly) ||
+            out_file.write(reinterpret_cast<char const*>(&header), sizeof(header)) != qint64(sizeof(header)) ||
+            out_file.write(reinterpret_cast<char const*>(frame_buffer.get_raw_data()), data_size) != data_size ||
+            !out_file.commit())
+    {
+        LOG_WARNING("Couldn't write texture cache entry: " << variant_file_name.toStdString());
+    }
+}
+
+QString Texture_cache::get_variant_file_name(const QString &file_name, const Texture_options &options, const QString &directory)
+{
+    QFileInfo const info(file_name);
+
+    // images of the same name in different directories get different variants
+    QByteArray const path = info.absoluteFilePath().toUtf8();
+    QString const path_hash = QString::number(hash_data(path.constData(), size_t(path.size())), 16).rightJustified(16, '0');
+
+    return QDir(directory).filePath(QString("%1-%2-%3.tex").arg(info.completeBaseName()).arg(path_hash).arg(int(options._scale * 1000.0f + 0.5f)));
+}
@@ -0,0 +1,85 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <QString>
+
+#include "GL_utilities.h"
+
+// How a texture is made from its image file, part of the cache key
+struct Texture_options
+{
+    explicit Texture_options(float const scale = 1.0f, bool const use_mipmaps = true, bool const with_alpha = false) :
+        _scale(scale),
+        _use_mipmaps(use_mipmaps),
+        _with_alpha(with_alpha)
+    { }
+
+    static Texture_options alpha() { return Texture_options(1.0f, true, true); }
+
+    float _scale;       // < 1 for the blurred backdrops, the image is scaled down and magnified linearly when drawn
+    bool _use_mipmaps;
+    bool _with_alpha;   // RGBA texture, scaled variants with alpha aren't kept on disk
+};
+
+// Textures of image files, decoded, converted and uploaded once and kept for the rest of the run, so switching levels
+// and recreating renderers doesn't reload the backdrops. Textures are shared by all renderers of the viewer's context.
+// Scaled variants are also kept in a directory (data/texture_cache by default) as raw Frame_buffer<Color> data,
+// named after the image, a hash of its path and the scale and validated against the image's size and modification time,
+// the byte order and the size of Color.
+// prefetch() decodes and converts on a worker thread, get_texture() then only waits for it and uploads.
+class Texture_cache
+{
+public:
+    static Texture_cache * get_instance();
+
+    // doesn't need a GL context, can be called from any thread
+    void prefetch(QString const& file_name, Texture_options const& options = Texture_options());
+
+    // Needs the GL context, loads synchronously when the texture wasn't prefetched. The texture belongs to the cache.
+    // Returns 0 for images that couldn't be read.
+    GLuint get_texture(GL_functions & gl_functions, QString const& file_name, Texture_options const& options = Texture_options());
+
+    // deletes all textures, needs the GL context, ~My_viewer() calls it before the context is destroyed
+    void clear(GL_functions & gl_functions);
+
+    void set_directory(QString const& directory);
+    QString get_directory() const;
+
+private:
+    Texture_cache();
+
+    // the converted image, one of the two depending on Texture_options::_with_alpha
+    struct Texture_data
+    {
+        Frame_buffer<Color> _color;
+        Frame_buffer<Color4> _color4;
+    };
+
+    struct Entry
+    {
+        Entry() : _texture(0) { }
+
+        GLuint _texture;
+        std::shared_future<Texture_data> _data; // until uploaded
+    };
+
+    static std::string get_key(QString const& file_name, Texture_options const& options);
+
+    static Texture_data load_texture_data(QString const& file_name, Texture_options const& options, QString const& directory);
+    static Frame_buffer<Color> load_frame_buffer(QString const& file_name, Texture_options const& options, QString const& directory);
+    static bool read_variant(QString const& variant_file_name, QString const& file_name, Frame_buffer<Color> & frame_buffer);
+    static void write_variant(QString const& variant_file_name, QString const& file_name, Frame_buffer<Color> const& frame_buffer);
+    static QString get_variant_file_name(QString const& file_name, Texture_options const& options, QString const& directory);
+
+    QString _directory;
+
+    mutable std::mutex _mutex;
+    std::map<std::string, Entry> _entries;
+};
+
+#endif // TEXTURE_CACHE_H
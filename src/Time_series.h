@@ -0,0 +1,393 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#ifndef Q_MOC_RUN
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/vector.hpp>
+#endif
+
+// min, max and sum of consecutive samples
+struct Time_series_bucket
+{
+    Time_series_bucket() :
+        _min(std::numeric_limits<float>::max()),
+        _max(-std::numeric_limits<float>::max()),
+        _sum(0.0),
+        _count(0)
+    { }
+
+    explicit Time_series_bucket(float const value) :
+        _min(value),
+        _max(value),
+        _sum(value),
+        _count(1)
+    { }
+
+    void add(Time_series_bucket const& other)
+    {
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+        _sum += other._sum;
+        _count += other._count;
+    }
+
+    float get_average() const
+    {
+        return (_count > 0) ? float(_sum / _count) : 0.0f;
+    }
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_min);
+        ar & BOOST_SERIALIZATION_NVP(_max);
+        ar & BOOST_SERIALIZATION_NVP(_sum);
+        ar & BOOST_SERIALIZATION_NVP(_count);
+    }
+
+    float _min;
+    float _max;
+    double _sum;
+    int _count;
+};
+
+
+// Keeps the last capacity values, pushing when full overwrites the oldest. The storage grows up to the capacity.
+template<typename T>
+class Ring_buffer
+{
+public:
+    explicit Ring_buffer(int const capacity = 0) :
+        _capacity(capacity),
+        _next(0)
+    { }
+
+    void push_back(T const& value)
+    {
+        if (int(_values.size()) < _capacity)
+        {
+            _values.push_back(value);
+        }
+        else
+        {
+            _values[_next] = value;
+            _next = (_next + 1) % _capacity;
+        }
+    }
+
+    void clear()
+    {
+        _values.clear();
+        _next = 0;
+    }
+
+    int size() const { return int(_values.size()); }
+    bool empty() const { return _values.empty(); }
+    bool full() const { return int(_values.size()) == _capacity; }
+    int get_capacity() const { return _capacity; }
+
+    // oldest first
+    T const& operator[](int const i) const
+    {
+        return _values[(_next + i) % int(_values.size())];
+    }
+
+    T const& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    size_t get_memory_usage() const
+    {
+        return _values.capacity() * sizeof(T);
+    }
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_values);
+        ar & BOOST_SERIALIZATION_NVP(_capacity);
+        ar & BOOST_SERIALIZATION_NVP(_next);
+    }
+
+private:
+    std::vector<T> _values;
+    int _capacity;
+    int _next;
+};
+
+
+// Bounded store for a sampled value: the last samples in a ring buffer, plus downsampled tiers of min/max/avg
+// buckets. Tier k combines Tier_factor^(k+1) samples per bucket and keeps the last Tier_capacity buckets, the last
+// tier covers the whole run by merging neighbouring buckets when it is full. Appending is O(1) (amortized for the
+// merge), the memory use doesn't depend on the length of the run.
+class Time_series
+{
+public:
+    static int const Raw_capacity = 3000;  // 10 minutes at the 0.2 s sensor interval
+    static int const Tier_capacity = 1024;
+    static int const Tier_factor = 8;
+    static int const Num_tiers = 3;
+
+    Time_series() :
+        _raw(Raw_capacity),
+        _num_samples(0)
+    {
+        int samples_per_bucket = 1;
+
+        for (int i = 0; i < Num_tiers - 1; ++i)
+        {
+            samples_per_bucket *= Tier_factor;
+            _tiers.push_back(Tier(samples_per_bucket, Tier_capacity));
+        }
+
+        _history_samples_per_bucket = samples_per_bucket * Tier_factor;
+    }
+
+    void add(float const value)
+    {
+        Time_series_bucket const sample(value);
+
+        _raw.push_back(value);
+        _total.add(sample);
+        ++_num_samples;
+
+        Time_series_bucket completed = sample;
+        bool carry = true;
+
+        for (Tier & tier : _tiers)
+        {
+            tier._open.add(completed);
+
+            if (tier._open._count < tier._samples_per_bucket)
+            {
+                carry = false;
+                break;
+            }
+
+            completed = tier._open;
+            tier._buckets.push_back(completed);
+            tier._open = Time_series_bucket();
+        }
+
+        if (carry)
+        {
+            add_to_history(completed);
+        }
+    }
+
+    void clear()
+    {
+        *this = Time_series();
+    }
+
+    bool empty() const { return _num_samples == 0; }
+    unsigned long long size() const { return _num_samples; }
+
+    float get_last() const { return _raw.back(); }
+    float get_min() const { return _total._min; }
+    float get_max() const { return _total._max; }
+    float get_average() const { return _total.get_average(); }
+
+    // the raw value when still in the ring buffer, otherwise the average of the finest bucket containing it
+    float get_value_at(unsigned long long const index) const
+    {
+        if (empty()) return 0.0f;
+
+        unsigned long long const i = std::min(index, _num_samples - 1);
+        unsigned long long const first_raw = _num_samples - _raw.size();
+
+        if (i >= first_raw) return _raw[int(i - first_raw)];
+
+        for (Tier const& tier : _tiers)
+        {
+            unsigned long long const num_complete = _num_samples / tier._samples_per_bucket;
+            unsigned long long const bucket = i / tier._samples_per_bucket;
+            unsigned long long const first_bucket = num_complete - tier._buckets.size();
+
+            if (bucket >= first_bucket && bucket < num_complete) return tier._buckets[int(bucket - first_bucket)].get_average();
+        }
+
+        size_t const bucket = std::min(size_t(i / _history_samples_per_bucket), _history.size() - 1);
+
+        return _history.empty() ? _total.get_average() : _history[bucket].get_average();
+    }
+
+    // The whole run in at most max_buckets buckets, oldest first: the raw samples if they fit and are all kept,
+    // otherwise the finest tier that still reaches back to the start, merged down further if needed.
+    std::vector<Time_series_bucket> get_buckets(int const max_buckets) const
+    {
+        std::vector<Time_series_bucket> result;
+
+        if (empty()) return result;
+
+        if (_num_samples <= (unsigned long long)(std::min(_raw.size(), max_buckets)))
+        {
+            for (int i = 0; i < _raw.size(); ++i)
+            {
+                result.push_back(Time_series_bucket(_raw[i]));
+            }
+
+            return result;
+        }
+
+        for (size_t t = 0; t < _tiers.size(); ++t)
+        {
+            Tier const& tier = _tiers[t];
+            unsigned long long const num_complete = _num_samples / tier._samples_per_bucket;
+
+            if (num_complete == (unsigned long long)(tier._buckets.size()) && num_complete + 1 <= (unsigned long long)(max_buckets))
+            {
+                for (int i = 0; i < tier._buckets.size(); ++i)
+                {
+                    result.push_back(tier._buckets[i]);
+                }
+
+                append_open_bucket(result, t + 1, false);
+
+                return result;
+            }
+        }
+
+        result = _history;
+        append_open_bucket(result, _tiers.size(), true);
+
+        return merge_buckets(result, std::max(1, max_buckets));
+    }
+
+    // averages of get_buckets(), for plotting at the resolution of the display
+    std::vector<float> get_values(int const max_points) const
+    {
+        std::vector<Time_series_bucket> const buckets = get_buckets(max_points);
+
+        std::vector<float> result;
+        result.reserve(buckets.size());
+
+        for (Time_series_bucket const& b : buckets)
+        {
+            result.push_back(b.get_average());
+        }
+
+        return result;
+    }
+
+    size_t get_memory_usage() const
+    {
+        size_t result = _raw.get_memory_usage() + _history.capacity() * sizeof(Time_series_bucket);
+
+        for (Tier const& tier : _tiers)
+        {
+            result += tier._buckets.get_memory_usage();
+        }
+
+        return result;
+    }
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /* version */)
+    {
+        ar & BOOST_SERIALIZATION_NVP(_raw);
+        ar & BOOST_SERIALIZATION_NVP(_tiers);
+        ar & BOOST_SERIALIZATION_NVP(_history);
+        ar & BOOST_SERIALIZATION_NVP(_history_open);
+        ar & BOOST_SERIALIZATION_NVP(_history_samples_per_bucket);
+        ar & BOOST_SERIALIZATION_NVP(_total);
+        ar & BOOST_SERIALIZATION_NVP(_num_samples);
+    }
+
+private:
+    struct Tier
+    {
+        Tier(int const samples_per_bucket = 1, int const capacity = 0) :
+            _samples_per_bucket(samples_per_bucket),
+            _buckets(capacity)
+        { }
+
+        template<class Archive>
+        void serialize(Archive & ar, const unsigned int /* version */)
+        {
+            ar & BOOST_SERIALIZATION_NVP(_samples_per_bucket);
+            ar & BOOST_SERIALIZATION_NVP(_buckets);
+            ar & BOOST_SERIALIZATION_NVP(_open);
+        }
+
+        int _samples_per_bucket;
+        Ring_buffer<Time_series_bucket> _buckets;
+        Time_series_bucket _open; // not yet complete
+    };
+
+    void add_to_history(Time_series_bucket const& bucket)
+    {
+        _history_open.add(bucket);
+
+        if (_history_open._count < _history_samples_per_bucket) return;
+
+        _history.push_back(_history_open);
+        _history_open = Time_series_bucket();
+
+        if (int(_history.size()) == Tier_capacity)
+        {
+            _history = merge_buckets(_history, Tier_capacity / 2);
+            _history_samples_per_bucket *= 2;
+        }
+    }
+
+    // the samples not yet in a complete bucket of the last of the first num_tiers tiers or of the history
+    void append_open_bucket(std::vector<Time_series_bucket> & buckets, size_t const num_tiers, bool const history) const
+    {
+        Time_series_bucket open;
+
+        for (size_t t = 0; t < num_tiers; ++t)
+        {
+            open.add(_tiers[t]._open);
+        }
+
+        if (history)
+        {
+            open.add(_history_open);
+        }
+
+        if (open._count > 0)
+        {
+            buckets.push_back(open);
+        }
+    }
+
+    static std::vector<Time_series_bucket> merge_buckets(std::vector<Time_series_bucket> const& buckets, int const max_buckets)
+    {
+        if (int(buckets.size()) <= max_buckets) return buckets;
+
+        int const per_bucket = (int(buckets.size()) + max_buckets - 1) / max_buckets;
+
+        std::vector<Time_series_bucket> result;
+        result.reserve(max_buckets);
+
+        for (size_t i = 0; i < buckets.size(); ++i)
+        {
+            if (i % per_bucket == 0)
+            {
+                result.push_back(Time_series_bucket());
+            }
+
+            result.back().add(buckets[i]);
+        }
+
+        return result;
+    }
+
+    Ring_buffer<float> _raw;
+    std::vector<Tier> _tiers;
+
+    std::vector<Time_series_bucket> _history; // whole run, the last tier
+    Time_series_bucket _history_open;
+    int _history_samples_per_bucket;
+
+    Time_series_bucket _total;
+    unsigned long long _num_samples;
+};
+
+#endif // TIME_SERIES_H
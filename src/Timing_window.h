@@ -0,0 +1,117 @@
+#ifndef TIMING_WINDOW_H
+#define TIMING_WINDOW_H
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+// Sliding window over the last samples (e.g. milliseconds per frame), adding a sample is O(1).
+// The statistics are computed on demand, the percentiles partially sort a copy of the window.
+class Timing_window
+{
+public:
+    explicit Timing_window(int const capacity = 240) :
+        _values(capacity, 0.0f),
+        _next(0),
+        _size(0)
+    { }
+
+    void add(float const value)
+    {
+        _values[_next] = value;
+        _next = (_next + 1) % int(_values.size());
+        _size = std::min(_size + 1, int(_values.size()));
+    }
+
+    void clear()
+    {
+        _next = 0;
+        _size = 0;
+    }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    float get_last() const
+    {
+        return empty() ? 0.0f : _values[(_next + int(_values.size()) - 1) % int(_values.size())];
+    }
+
+    float get_mean() const
+    {
+        if (empty()) return 0.0f;
+
+        float sum = 0.0f;
+
+        for (int i = 0; i < _size; ++i)
+        {
+            sum += _values[i];
+        }
+
+        return sum / _size;
+    }
+
+    float get_max() const
+    {
+        return empty() ? 0.0f : *std::max_element(_values.begin(), _values.begin() + _size);
+    }
+
+    // p in [0, 1], nearest rank
+    float get_percentile(float const p) const
+    {
+        if (empty()) return 0.0f;
+
+        std::vector<float> values(_values.begin(), _values.begin() + _size);
+
+        int const rank = std::min(_size - 1, int(p * _size));
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+
+        return values[rank];
+    }
+
+    // oldest first
+    std::vector<float> get_values() const
+    {
+        std::vector<float> result;
+        result.reserve(_size);
+
+        int const first = (_size < int(_values.size())) ? 0 : _next;
+
+        for (int i = 0; i < _size; ++i)
+        {
+            result.push_back(_values[(first + i) % int(_values.size())]);
+        }
+
+        return result;
+    }
+
+private:
+    std::vector<float> _values;
+    int _next;
+    int _size;
+};
+
+
+// adds the milliseconds until the end of the scope to the given value
+class Scoped_timer
+{
+public:
+    explicit Scoped_timer(float & elapsed_milliseconds) :
+        _elapsed_milliseconds(elapsed_milliseconds),
+        _start(std::chrono::steady_clock::now())
+    { }
+
+    ~Scoped_timer()
+    {
+        _elapsed_milliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+    Scoped_timer(Scoped_timer const&);
+    Scoped_timer & operator=(Scoped_timer const&);
+
+    float & _elapsed_milliseconds;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#endif // TIMING_WINDOW_H
@@ -0,0 +1,691 @@
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef Q_MOC_RUN
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#endif
+
+#include "Core.h"
+#include "Level_data.h"
+#include "Level_io.h"
+#include "Profiler.h"
+#include "Timing_window.h"
+#include "Message_logger.h"
+
+
+namespace
+{
+char const Trajectory_magic[8] = { 'P', 'A', 'R', 'T', 'T', 'R', 'J', '\0' };
+
+template<typename T>
+char * write_value(char * out, T const& value)
+{
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+}
+
+template<typename T>
+char const* read_value(char const* in, T & value)
+{
+    std::memcpy(&value, in, sizeof(T));
+    return in + sizeof(T);
+}
+
+size_t get_shape_definitions_size(char const* data, unsigned int const num_shapes)
+{
+    size_t size = 0;
+
+    for (unsigned int i = 0; i < num_shapes; ++i)
+    {
+        unsigned int archive_size;
+        std::memcpy(&archive_size, data + size + sizeof(unsigned short), sizeof(archive_size));
+
+        size += sizeof(unsigned short) + sizeof(unsigned int) + archive_size;
+    }
+
+    return size;
+}
+}
+
+
+Eigen::AlignedBox3f get_trajectory_bounds(const Level_data &level_data)
+{
+    std::map<Level_data::Plane, Plane_barrier*> const& borders = level_data._game_field_borders;
+
+    if (borders.size() == 6)
+    {
+        return Eigen::AlignedBox3f(Eigen::Vector3f(borders.at(Level_data::Plane::Neg_X)->get_position()[0],
+                                                   borders.at(Level_data::Plane::Neg_Y)->get_position()[1],
+                                                   borders.at(Level_data::Plane::Neg_Z)->get_position()[2]),
+                                   Eigen::Vector3f(borders.at(Level_data::Plane::Pos_X)->get_position()[0],
+                                                   borders.at(Level_data::Plane::Pos_Y)->get_position()[1],
+                                                   borders.at(Level_data::Plane::Pos_Z)->get_position()[2]));
+    }
+
+    Eigen::Vector3f const half_extent(level_data._game_field_width * 0.5f,
+                                      level_data._game_field_depth_handle.get() * 0.5f,
+                                      level_data._game_field_height * 0.5f);
+
+    return Eigen::AlignedBox3f(-half_extent, half_extent);
+}
+
+
+Trajectory_recorder::Trajectory_recorder() :
+    _stop(false),
+    _full_blocks(Queue_capacity),
+    _free_blocks(Queue_capacity + 2),
+    _record_forces(false),
+    _compression_level(1),
+    _num_block_shapes(0),
+    _num_frames(0),
+    _num_dropped_frames(0),
+    _raw_bytes(0),
+    _compressed_bytes(0),
+    _add_frame_milliseconds(0.0f)
+{ }
+
+Trajectory_recorder::~Trajectory_recorder()
+{
+    stop();
+}
+
+bool Trajectory_recorder::start(const std::string &file_name, const Level_data &level_data, const bool record_forces, const int compression_level)
+{
+    stop();
+
+    std::ostringstream level_archive;
+
+    if (!save_binary_level(level_data, level_archive))
+    {
+        return false;
+    }
+
+    std::string const level = level_archive.str();
+
+    _file.open(file_name.c_str(), std::fstream::binary | std::fstream::out | std::fstream::trunc);
+
+    if (!_file)
+    {
+        LOG_WARNING("Couldn't open trajectory file: " << file_name);
+        return false;
+    }
+
+    _bounds = get_trajectory_bounds(level_data);
+    _record_forces = record_forces;
+    _compression_level = compression_level;
+
+    _shape_indices.clear();
+    _shape_archives.clear();
+    _molecule_shapes.clear();
+    _frame_ids.clear();
+    _frame_shapes.clear();
+    _num_block_shapes = 0;
+
+    _num_frames = 0;
+    _num_dropped_frames = 0;
+    _raw_bytes = 0;
+    _compressed_bytes = 0;
+    _add_frame_milliseconds = 0.0f;
+
+    Trajectory_header header;
+    std::memcpy(header._magic, Trajectory_magic, sizeof(Trajectory_magic));
+    header._format_version = Trajectory_format_version;
+    header._flags = record_forces ? Trajectory_flag_forces : 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        header._bounds_min[i] = _bounds.min()[i];
+        header._bounds_max[i] = _bounds.max()[i];
+    }
+
+    header._level_size = level.size();
+
+    _file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    _file.write(level.data(), std::streamsize(level.size()));
+
+    _stop = false;
+    _writer_thread = std::thread(&Trajectory_recorder::write_blocks, this);
+
+    return true;
+}
+
+void Trajectory_recorder::stop()
+{
+    if (!is_recording()) return;
+
+    // the last block must not be dropped, the writer is still running and frees a queue slot
+    while (_current_block && _current_block->_num_frames > 0 && !_full_blocks.push(_current_block))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    _stop = true;
+    _writer_thread.join();
+
+    _current_block.reset();
+    _file.close();
+}
+
+void Trajectory_recorder::add_frame(const Core &core, const std::vector<Eigen::Vector3f> *forces_on_atoms)
+{
+    if (!is_recording()) return;
+
+    PROFILE_ZONE("Trajectory_recorder::add_frame");
+    Scoped_timer const timer(_add_frame_milliseconds);
+
+    std::list<Molecule> const& molecules = core.get_molecules();
+
+    unsigned int const num_atoms = (_record_forces && forces_on_atoms) ?
+                (unsigned int)(std::min(size_t(core.get_num_atoms()), forces_on_atoms->size())) : 0;
+
+    // shapes first, a new one is defined in this frame
+    _frame_ids.resize(molecules.size(), -1);
+    _frame_shapes.resize(molecules.size(), 0);
+
+    {
+        size_t i = 0;
+
+        for (Molecule const& m : molecules)
+        {
+            if (_frame_ids[i] != m.get_id())
+            {
+                _frame_ids[i] = m.get_id();
+                _frame_shapes[i] = get_shape(m);
+            }
+
+            ++i;
+        }
+    }
+
+    if (!_current_block && !_free_blocks.pop(_current_block))
+    {
+        _current_block.reset(new Block);
+        _current_block->_data.reserve(Block_size * 2);
+    }
+
+    if (_current_block->_num_frames == 0)
+    {
+        _num_block_shapes = 0;
+        _current_block->_first_time = core.get_current_time();
+    }
+
+    Trajectory_frame_header header;
+    header._step = core.get_num_steps();
+    header._time = core.get_current_time();
+    header._num_molecules = (unsigned int)(molecules.size());
+    header._num_atoms = num_atoms;
+    header._force_scale = 0.0f;
+    header._num_shapes = (unsigned int)(_shape_archives.size() - _num_block_shapes);
+
+    for (unsigned int i = 0; i < num_atoms; ++i)
+    {
+        header._force_scale = std::max(header._force_scale, (*forces_on_atoms)[i].cwiseAbs().maxCoeff());
+    }
+
+    size_t shapes_size = 0;
+
+    for (size_t i = _num_block_shapes; i < _shape_archives.size(); ++i)
+    {
+        shapes_size += sizeof(unsigned short) + sizeof(unsigned int) + _shape_archives[i].size();
+    }
+
+    std::vector<char> & data = _current_block->_data;
+    size_t const frame_offset = data.size();
+
+    data.resize(frame_offset + sizeof(header) + shapes_size + molecules.size() * Trajectory_molecule_size + num_atoms * Trajectory_atom_force_size);
+
+    char * out = write_value(data.data() + frame_offset, header);
+
+    for (size_t i = _num_block_shapes; i < _shape_archives.size(); ++i)
+    {
+        out = write_value(out, (unsigned short)(i));
+        out = write_value(out, (unsigned int)(_shape_archives[i].size()));
+        std::memcpy(out, _shape_archives[i].data(), _shape_archives[i].size());
+        out += _shape_archives[i].size();
+    }
+
+    _num_block_shapes = _shape_archives.size();
+
+    Eigen::Vector3f const extent = _bounds.max() - _bounds.min();
+    Eigen::Vector3f position_factor;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        position_factor[i] = extent[i] > 0.0f ? 65535.0f / extent[i] : 0.0f;
+    }
+
+    size_t molecule_index = 0;
+
+    for (Molecule const& m : molecules)
+    {
+        out = write_value(out, m.get_id());
+        out = write_value(out, _frame_shapes[molecule_index]);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            float const p = (m._x[i] - _bounds.min()[i]) * position_factor[i];
+            out = write_value(out, (unsigned short)(std::min(std::max(p, 0.0f), 65535.0f) + 0.5f));
+        }
+
+        // q and -q are the same rotation
+        Eigen::Quaternion<float> q = m._q.normalized();
+
+        if (q.w() < 0.0f)
+        {
+            q.coeffs() = -q.coeffs();
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            out = write_value(out, short(std::lround(q.coeffs()[i] * 32767.0f)));
+        }
+
+        ++molecule_index;
+    }
+
+    float const force_factor = header._force_scale > 0.0f ? 32767.0f / header._force_scale : 0.0f;
+
+    for (unsigned int i = 0; i < num_atoms; ++i)
+    {
+        Eigen::Vector3f const& f = (*forces_on_atoms)[i];
+
+        for (int j = 0; j < 3; ++j)
+        {
+            out = write_value(out, short(std::lround(f[j] * force_factor)));
+        }
+    }
+
+    ++_current_block->_num_frames;
+    _current_block->_last_time = header._time;
+    ++_num_frames;
+
+    if (data.size() >= Block_size)
+    {
+        submit_block();
+    }
+}
+
+unsigned short Trajectory_recorder::get_shape(const Molecule &molecule)
+{
+    auto const molecule_iter = _molecule_shapes.find(molecule.get_id());
+
+    if (molecule_iter != _molecule_shapes.end())
+    {
+        return molecule_iter->second;
+    }
+
+    std::string key;
+
+    for (Atom const& a : molecule._atoms)
+    {
+        int const type = int(a._type);
+        key.append(reinterpret_cast<char const*>(&type), sizeof(type));
+        key.append(reinterpret_cast<char const*>(a._r_0.data()), 3 * sizeof(float));
+    }
+
+    auto shape_iter = _shape_indices.find(key);
+
+    if (shape_iter == _shape_indices.end())
+    {
+        std::ostringstream archive;
+
+        {
+            boost::archive::binary_oarchive oa(archive);
+            oa << boost::serialization::make_nvp("molecule", molecule);
+        }
+
+        shape_iter = _shape_indices.insert(std::make_pair(key, (unsigned short)(_shape_archives.size()))).first;
+        _shape_archives.push_back(archive.str());
+    }
+
+    _molecule_shapes[molecule.get_id()] = shape_iter->second;
+
+    return shape_iter->second;
+}
+
+void Trajectory_recorder::submit_block()
+{
+    if (!_current_block || _current_block->_num_frames == 0) return;
+
+    if (!_full_blocks.push(_current_block))
+    {
+        // the writer is behind, dropping is cheaper for the physics than waiting
+        _num_dropped_frames += _current_block->_num_frames;
+        _current_block->_data.clear();
+        _current_block->_num_frames = 0;
+    }
+}
+
+void Trajectory_recorder::write_blocks()
+{
+    std::unique_ptr<Block> block;
+
+    while (true)
+    {
+        if (_full_blocks.pop(block))
+        {
+            write_block(*block);
+
+            block->_data.clear();
+            block->_num_frames = 0;
+
+            // when the free queue is full the block is just deleted
+            _free_blocks.push(block);
+            block.reset();
+        }
+        else if (_stop.load(std::memory_order_acquire))
+        {
+            // a block pushed right before the stop flag
+            while (_full_blocks.pop(block))
+            {
+                write_block(*block);
+            }
+
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+void Trajectory_recorder::write_block(const Block &block)
+{
+    PROFILE_ZONE("Trajectory_recorder::write_block");
+
+    QByteArray const compressed = qCompress(reinterpret_cast<uchar const*>(block._data.data()), int(block._data.size()), _compression_level);
+
+    Trajectory_chunk_header header;
+    header._compressed_size = (unsigned int)(compressed.size());
+    header._raw_size = (unsigned int)(block._data.size());
+    header._num_frames = block._num_frames;
+    header._first_time = block._first_time;
+    header._last_time = block._last_time;
+
+    _file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    _file.write(compressed.constData(), compressed.size());
+
+    _raw_bytes += block._data.size();
+    _compressed_bytes += (unsigned long long)(compressed.size());
+}
+
+
+Trajectory_reader::Trajectory_reader() :
+    _num_frames(0),
+    _loaded_chunk(-1)
+{ }
+
+Trajectory_reader::~Trajectory_reader()
+{ }
+
+bool Trajectory_reader::open(const std::string &file_name)
+{
+    close();
+
+    _file.open(file_name.c_str(), std::fstream::binary | std::fstream::in);
+
+    if (!_file)
+    {
+        LOG_WARNING("Couldn't open trajectory file: " << file_name);
+        return false;
+    }
+
+    if (!_file.read(reinterpret_cast<char*>(&_header), sizeof(_header)) ||
+            std::memcmp(_header._magic, Trajectory_magic, sizeof(Trajectory_magic)) != 0)
+    {
+        LOG_WARNING("Not a trajectory file: " << file_name);
+        close();
+        return false;
+    }
+
+    if (_header._format_version != Trajectory_format_version)
+    {
+        LOG_WARNING("Unsupported trajectory format version " << _header._format_version << ": " << file_name);
+        close();
+        return false;
+    }
+
+    std::vector<char> level(size_t(_header._level_size));
+    std::unique_ptr<Level_data> level_data(new Level_data);
+
+    try
+    {
+        if (!_file.read(level.data(), std::streamsize(level.size())))
+        {
+            throw std::runtime_error("level truncated");
+        }
+
+        load_binary_level(*level_data, level.data(), level.size());
+    }
+    catch (std::exception const& e)
+    {
+        LOG_WARNING("Couldn't read the level of trajectory file: " << file_name << ", reason: " << e.what());
+        close();
+        return false;
+    }
+
+    level_data->update_parameters();
+
+    // only the chunk headers, the data is skipped
+    Chunk chunk;
+
+    while (_file.read(reinterpret_cast<char*>(&chunk._header), sizeof(chunk._header)))
+    {
+        chunk._offset = (unsigned long long)(_file.tellg());
+        _chunks.push_back(chunk);
+        _num_frames += chunk._header._num_frames;
+
+        _file.seekg(std::streamoff(chunk._header._compressed_size), std::ios::cur);
+    }
+
+    _file.clear();
+
+    _level_data = std::move(level_data);
+
+    return true;
+}
+
+void Trajectory_reader::close()
+{
+    _file.close();
+    _file.clear();
+    _level_data.reset();
+    _chunks.clear();
+    _num_frames = 0;
+    _loaded_chunk = -1;
+    _chunk_data.clear();
+    _frame_offsets.clear();
+    _frame_times.clear();
+    _shapes.clear();
+}
+
+float Trajectory_reader::get_start_time() const
+{
+    return _chunks.empty() ? 0.0f : _chunks.front()._header._first_time;
+}
+
+float Trajectory_reader::get_end_time() const
+{
+    return _chunks.empty() ? 0.0f : _chunks.back()._header._last_time;
+}
+
+bool Trajectory_reader::read_frame(const float time, std::list<Molecule> &molecules)
+{
+    if (_chunks.empty()) return false;
+
+    PROFILE_ZONE("Trajectory_reader::read_frame");
+
+    auto const chunk_iter = std::upper_bound(_chunks.begin(), _chunks.end(), time,
+                                             [](float const t, Chunk const& c) { return t < c._header._first_time; });
+
+    int const chunk_index = (chunk_iter == _chunks.begin()) ? 0 : int(chunk_iter - _chunks.begin()) - 1;
+
+    if (!load_chunk(chunk_index) || _frame_offsets.empty()) return false;
+
+    auto const frame_iter = std::upper_bound(_frame_times.begin(), _frame_times.end(), time);
+    size_t const frame_index = (frame_iter == _frame_times.begin()) ? 0 : size_t(frame_iter - _frame_times.begin()) - 1;
+
+    decode_frame(_frame_offsets[frame_index], molecules);
+
+    return true;
+}
+
+size_t Trajectory_reader::get_memory_usage() const
+{
+    return size_t(_chunk_data.capacity()) + _chunks.capacity() * sizeof(Chunk) +
+            _frame_offsets.capacity() * sizeof(size_t) + _frame_times.capacity() * sizeof(float);
+}
+
+bool Trajectory_reader::load_chunk(const int chunk_index)
+{
+    if (chunk_index == _loaded_chunk) return true;
+
+    PROFILE_ZONE("Trajectory_reader::load_chunk");
+
+    Chunk const& chunk = _chunks[chunk_index];
+
+    _loaded_chunk = -1;
+    _frame_offsets.clear();
+    _frame_times.clear();
+
+    QByteArray compressed(int(chunk._header._compressed_size), Qt::Uninitialized);
+
+    _file.seekg(std::streamoff(chunk._offset));
+
+    if (!_file.read(compressed.data(), compressed.size()))
+    {
+        LOG_WARNING("Trajectory chunk " << chunk_index << " truncated");
+        _file.clear();
+        return false;
+    }
+
+    _chunk_data = qUncompress(compressed);
+
+    if (_chunk_data.size() != int(chunk._header._raw_size))
+    {
+        LOG_WARNING("Trajectory chunk " << chunk_index << " corrupt");
+        return false;
+    }
+
+    // frame index, the shape definitions are read here so any frame of the chunk can be decoded
+    char const* const data = _chunk_data.constData();
+    size_t const size = size_t(_chunk_data.size());
+    size_t offset = 0;
+
+    while (offset + sizeof(Trajectory_frame_header) <= size)
+    {
+        Trajectory_frame_header header;
+        char const* in = read_value(data + offset, header);
+
+        _frame_offsets.push_back(offset);
+        _frame_times.push_back(header._time);
+
+        for (unsigned int i = 0; i < header._num_shapes; ++i)
+        {
+            unsigned short index;
+            unsigned int archive_size;
+
+            in = read_value(in, index);
+            in = read_value(in, archive_size);
+
+            if (index >= _shapes.size())
+            {
+                _shapes.resize(index + 1);
+            }
+
+            if (!_shapes[index])
+            {
+                try
+                {
+                    Memory_streambuf buffer(in, archive_size);
+                    std::istream archive(&buffer);
+
+                    boost::archive::binary_iarchive ia(archive);
+
+                    std::unique_ptr<Molecule> shape(new Molecule);
+                    ia >> boost::serialization::make_nvp("molecule", *shape);
+
+                    _shapes[index] = std::move(shape);
+                }
+                catch (std::exception const& e)
+                {
+                    LOG_WARNING("Couldn't read trajectory shape " << index << ": " << e.what());
+                }
+            }
+
+            in += archive_size;
+        }
+
+        offset = size_t(in - data) + header._num_molecules * Trajectory_molecule_size + header._num_atoms * Trajectory_atom_force_size;
+    }
+
+    _loaded_chunk = chunk_index;
+
+    return true;
+}
+
+void Trajectory_reader::decode_frame(const size_t frame_offset, std::list<Molecule> &molecules) const
+{
+    Trajectory_frame_header header;
+    char const* in = read_value(_chunk_data.constData() + frame_offset, header);
+
+    in += get_shape_definitions_size(in, header._num_shapes);
+
+    Eigen::Vector3f const bounds_min(_header._bounds_min[0], _header._bounds_min[1], _header._bounds_min[2]);
+    Eigen::Vector3f const bounds_max(_header._bounds_max[0], _header._bounds_max[1], _header._bounds_max[2]);
+    Eigen::Vector3f const position_factor = (bounds_max - bounds_min) / 65535.0f;
+
+    auto iter = molecules.begin();
+
+    for (unsigned int i = 0; i < header._num_molecules; ++i)
+    {
+        int id;
+        unsigned short shape;
+        unsigned short position[3];
+        short rotation[4];
+
+        in = read_value(in, id);
+        in = read_value(in, shape);
+        in = read_value(in, position);
+        in = read_value(in, rotation);
+
+        if (shape >= _shapes.size() || !_shapes[shape]) continue;
+
+        // molecules keep their place in the list, only new ones are copied from the shape
+        if (iter == molecules.end())
+        {
+            iter = molecules.insert(iter, *_shapes[shape]);
+            iter->set_id(id);
+        }
+        else if (iter->get_id() != id || iter->_atoms.size() != _shapes[shape]->_atoms.size())
+        {
+            *iter = *_shapes[shape];
+            iter->set_id(id);
+        }
+
+        Molecule & m = *iter;
+
+        for (int j = 0; j < 3; ++j)
+        {
+            m._x[j] = bounds_min[j] + float(position[j]) * position_factor[j];
+        }
+
+        Eigen::Quaternion<float> q;
+        q.coeffs() = Eigen::Vector4f(float(rotation[0]), float(rotation[1]), float(rotation[2]), float(rotation[3])) / 32767.0f;
+
+        m.apply_orientation(q.normalized());
+
+        ++iter;
+    }
+
+    molecules.erase(iter, molecules.end());
+}
@@ -0,0 +1,200 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <atomic>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+
+#include <Eigen/Geometry>
+
+#include "Spsc_queue.h"
+
+class Core;
+class Level_data;
+class Molecule;
+
+// Trajectory files: per-step molecule states of a run for offline analysis and playback. The file starts with
+// Trajectory_header and the level at the start of the recording as a binary level (Level_io.h), followed by chunks
+// of a Trajectory_chunk_header and a qCompress()ed (zlib) block of whole frames.
+// A frame is a Trajectory_frame_header, the shape definitions of the frame and per molecule the id (int), the shape
+// (unsigned short), the position as 3 unsigned 16-bit fixed point values relative to the game field bounds in the
+// header and the rotation as 4 signed 16-bit values (w >= 0).
+// A shape is a molecule in body space, defined by its index (unsigned short), the archive size (unsigned int) and
+// a boost binary archive of the Molecule. The first frame of a chunk defines all shapes so far, later frames only
+// the new ones, so every chunk can be decoded on its own.
+// With Trajectory_flag_forces the forces on all atoms of the frame follow as 3 signed 16-bit values each,
+// relative to _force_scale, in the atom order of the molecules. Values are in the byte order of the writer (little endian).
+
+struct Trajectory_header
+{
+    char _magic[8];
+    unsigned int _format_version;
+    unsigned int _flags;
+    float _bounds_min[3];
+    float _bounds_max[3];
+    unsigned long long _level_size;
+};
+
+struct Trajectory_chunk_header
+{
+    unsigned int _compressed_size;
+    unsigned int _raw_size;
+    unsigned int _num_frames;
+    float _first_time;
+    float _last_time;
+};
+
+struct Trajectory_frame_header
+{
+    unsigned long long _step;
+    float _time;
+    unsigned int _num_molecules;
+    unsigned int _num_atoms;   // zero without forces
+    float _force_scale;        // largest force component of the frame
+    unsigned int _num_shapes;
+};
+
+int const Trajectory_format_version = 2;
+unsigned int const Trajectory_flag_forces = 1;
+size_t const Trajectory_molecule_size = sizeof(int) + sizeof(unsigned short) + 3 * sizeof(unsigned short) + 4 * sizeof(short);
+size_t const Trajectory_atom_force_size = 3 * sizeof(short);
+
+// box the positions are quantized in: the game field borders
+Eigen::AlignedBox3f get_trajectory_bounds(Level_data const& level_data);
+
+
+// Streams frames from the physics loop to a file. add_frame() only quantizes into a block, full blocks go through a
+// lock-free queue to a writer thread that compresses and writes them. The physics thread never waits on the disk:
+// when the writer falls behind and the queue is full the frames of a block are dropped and counted.
+class Trajectory_recorder
+{
+public:
+    Trajectory_recorder();
+    ~Trajectory_recorder();
+
+    bool start(std::string const& file_name, Level_data const& level_data, bool const record_forces, int const compression_level = 1);
+
+    // writes the remaining frames and waits for the writer
+    void stop();
+
+    bool is_recording() const { return _writer_thread.joinable(); }
+
+    // forces_on_atoms can be nullptr when the recorder was started without forces
+    void add_frame(Core const& core, std::vector<Eigen::Vector3f> const* forces_on_atoms);
+
+    unsigned long long get_num_frames() const { return _num_frames; }
+    unsigned long long get_num_dropped_frames() const { return _num_dropped_frames; }
+    unsigned long long get_raw_bytes() const { return _raw_bytes; }
+    unsigned long long get_compressed_bytes() const { return _compressed_bytes; }
+
+    // physics thread time spent in add_frame()
+    float get_add_frame_milliseconds() const { return _add_frame_milliseconds; }
+
+private:
+    struct Block
+    {
+        Block() : _num_frames(0), _first_time(0.0f), _last_time(0.0f) { }
+
+        std::vector<char> _data;
+        unsigned int _num_frames;
+        float _first_time;
+        float _last_time;
+    };
+
+    unsigned short get_shape(Molecule const& molecule);
+
+    void submit_block();
+    void write_blocks();
+    void write_block(Block const& block);
+
+    static size_t const Block_size = 1024 * 1024; // raw frame data per compressed chunk
+    static size_t const Queue_capacity = 16;
+
+    std::ofstream _file;
+    std::thread _writer_thread;
+    std::atomic<bool> _stop;
+
+    Spsc_queue< std::unique_ptr<Block> > _full_blocks;  // physics thread -> writer
+    Spsc_queue< std::unique_ptr<Block> > _free_blocks;  // writer -> physics thread, recycled
+    std::unique_ptr<Block> _current_block;
+
+    Eigen::AlignedBox3f _bounds;
+    bool _record_forces;
+    int _compression_level;
+
+    std::map<std::string, unsigned short> _shape_indices;  // by atom types and body space positions
+    std::vector<std::string> _shape_archives;
+    std::unordered_map<int, unsigned short> _molecule_shapes; // by molecule id
+    std::vector<int> _frame_ids;                  // of the last frame, most molecules keep their place in the list
+    std::vector<unsigned short> _frame_shapes;
+    size_t _num_block_shapes;                     // shapes already defined in the current block
+
+    unsigned long long _num_frames;
+    unsigned long long _num_dropped_frames;
+    std::atomic<unsigned long long> _raw_bytes;
+    std::atomic<unsigned long long> _compressed_bytes;
+    float _add_frame_milliseconds;
+};
+
+
+// Reads trajectory files for playback. Only the chunk index is kept for the whole file, the frames are decoded from
+// a single chunk in memory which is replaced when reading outside of it.
+class Trajectory_reader
+{
+public:
+    Trajectory_reader();
+    ~Trajectory_reader();
+
+    // header, level and chunk index
+    bool open(std::string const& file_name);
+    void close();
+
+    bool is_open() const { return _level_data != nullptr; }
+
+    // the level at the start of the recording, the molecules are replaced by read_frame()
+    Level_data & get_level_data() { return *_level_data; }
+    Level_data const& get_level_data() const { return *_level_data; }
+
+    float get_start_time() const;
+    float get_end_time() const;
+    unsigned long long get_num_frames() const { return _num_frames; }
+
+    // molecules of the latest frame at or before the time (the first frame before the start), reuses the molecules
+    bool read_frame(float const time, std::list<Molecule> & molecules);
+
+    size_t get_memory_usage() const;
+
+private:
+    struct Chunk
+    {
+        unsigned long long _offset; // of the compressed data
+        Trajectory_chunk_header _header;
+    };
+
+    bool load_chunk(int const chunk_index);
+    void decode_frame(size_t const frame_offset, std::list<Molecule> & molecules) const;
+
+    std::ifstream _file;
+    Trajectory_header _header;
+    std::unique_ptr<Level_data> _level_data;
+
+    std::vector<Chunk> _chunks;
+    unsigned long long _num_frames;
+
+    int _loaded_chunk;
+    QByteArray _chunk_data;              // uncompressed
+    std::vector<size_t> _frame_offsets;  // into _chunk_data
+    std::vector<float> _frame_times;
+
+    std::vector< std::unique_ptr<Molecule> > _shapes;
+};
+
+#endif // TRAJECTORY_H
@@ -1,6 +1,8 @@
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
+#include <cstddef>
+
 #include <Eigen/Core>
 
 #ifdef WIN32
@@ -36,6 +38,20 @@ inline float wendland_2_1(float const x)
     return a * (3.0f * x + 1.0f);
 }
 
+// 64 bit FNV-1a, the keys of the level and texture caches
+inline unsigned long long hash_data(char const* data, size_t const size)
+{
+    unsigned long long hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
 //float dot(Eigen::Vector3f const& v1, Eigen::Vector3f const& v2)
 //{
 //    return v1.dot(v2);
@@ -0,0 +1,512 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDir>
+#include <QImage>
+
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <cmath>
+
+#include "Core.h"
+#include "Atom_soa.h"
+#include "Force_field.h"
+#include "Force_table.h"
+#include "Spatial_hash.h"
+#include "RegularBspTree.h"
+#include "Particle_system.h"
+#include "Scene_generator.h"
+#include "Level_element_exports.h"
+#include "Message_logger.h"
+
+// Microbenchmarks for the physics kernels, run headless. Each benchmark is run for several sizes, the result
+// is one CSV row per benchmark and size, so runs of different commits can be compared with any table tool.
+// "size" is the number of atoms, except for temperature_grid (Brownian boxes), the data structures (points) and
+// image_convert (image width, the images are 256 pixels high).
+// simulation_step runs Core::update() on a generated scene (Scene_generator) with the given number of atoms,
+// checkpoint_save/checkpoint_restore take and restore a Core::Checkpoint of the stepped scene.
+
+namespace
+{
+
+struct Benchmark_result
+{
+    std::string name;
+    int size;
+    int iterations;
+    double median_ns;
+    double min_ns;
+    double items_per_second;
+};
+
+struct Benchmark_settings
+{
+    double min_batch_seconds;
+    int num_batches;
+    std::string filter; // only names containing it are run
+};
+
+volatile float benchmark_sink = 0.0f; // results are written here so the compiler can't drop the measured code
+
+// runs the function in batches of increasing iteration counts until a batch takes min_batch_seconds,
+// items_per_iteration is the work done per call (e.g. atom pairs) for the throughput column
+void run_benchmark(std::string const& name, int const size, double const items_per_iteration,
+                   std::function<void()> const& function, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos) return;
+
+    function(); // warm-up
+
+    int iterations = 1;
+
+    for (;;)
+    {
+        Clock::time_point const start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i) function();
+
+        double const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (seconds >= settings.min_batch_seconds || iterations >= (1 << 24)) break;
+
+        iterations *= 2;
+    }
+
+    std::vector<double> ns_per_iteration;
+
+    for (int b = 0; b < settings.num_batches; ++b)
+    {
+        Clock::time_point const start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i) function();
+
+        ns_per_iteration.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+    }
+
+    std::sort(ns_per_iteration.begin(), ns_per_iteration.end());
+
+    Benchmark_result result;
+    result.name = name;
+    result.size = size;
+    result.iterations = iterations;
+    result.median_ns = ns_per_iteration[ns_per_iteration.size() / 2];
+    result.min_ns = ns_per_iteration.front();
+    result.items_per_second = items_per_iteration / (result.median_ns * 1e-9);
+
+    results.push_back(result);
+}
+
+
+// water molecules in a cube with about the density of the shipped levels
+std::list<Molecule> create_molecules(int const num_atoms)
+{
+    std::mt19937 rng(0);
+
+    int const num_molecules = std::max(1, num_atoms / 3);
+    float const extent = 3.0f * std::cbrt(float(num_molecules));
+
+    std::uniform_real_distribution<float> position(-0.5f * extent, 0.5f * extent);
+
+    std::list<Molecule> molecules;
+
+    for (int i = 0; i < num_molecules; ++i)
+    {
+        Molecule m = Molecule::create_water(Eigen::Vector3f(position(rng), position(rng), position(rng)));
+        m.set_id(i);
+        molecules.push_back(m);
+    }
+
+    return molecules;
+}
+
+
+void bench_pair_forces(int const num_atoms, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    std::list<Molecule> const molecules = create_molecules(num_atoms);
+
+    Atom_soa atoms;
+    atoms.assign(molecules);
+
+    Force_soa forces;
+    forces.resize(atoms.size());
+
+    double const num_pairs = double(atoms.size()) * double(atoms.size());
+
+    // default strengths from the force parameters
+    Parameter_list const coulomb_parameters = Coulomb_force::get_parameters();
+    Parameter_list const lennard_jones_parameters = Lennard_jones_force::get_parameters();
+
+    Coulomb_force coulomb;
+    coulomb.update_variables(coulomb_parameters);
+
+    Lennard_jones_force lennard_jones;
+    lennard_jones.update_variables(lennard_jones_parameters);
+
+    Force_field<Coulomb_force, Lennard_jones_force> const field(coulomb, lennard_jones);
+
+    run_benchmark("pair_forces_field", atoms.size(), num_pairs, [&]()
+    {
+        forces.set_zero();
+        field.calc_forces(atoms.get_span(), atoms.get_span(), forces.get_span());
+        benchmark_sink = forces.get(0)[0];
+    }, settings, results);
+
+    std::vector< std::unique_ptr<Atomic_force> > atomic_forces;
+    atomic_forces.push_back(std::unique_ptr<Atomic_force>(new Coulomb_force(coulomb)));
+    atomic_forces.push_back(std::unique_ptr<Atomic_force>(new Lennard_jones_force(lennard_jones)));
+
+    Generic_force_field const generic_field(atomic_forces);
+
+    run_benchmark("pair_forces_virtual", atoms.size(), num_pairs, [&]()
+    {
+        forces.set_zero();
+        generic_field.calc_forces(atoms.get_span(), atoms.get_span(), forces.get_span());
+        benchmark_sink = forces.get(0)[0];
+    }, settings, results);
+
+    Force_table table;
+    table.build(coulomb_parameters["Strength"]->get_value<float>(),
+                lennard_jones_parameters["Strength"]->get_value<float>(),
+                lennard_jones_parameters["Radius Factor"]->get_value<float>());
+
+    for (Force_table::Interpolation const interpolation : { Force_table::Interpolation::Linear, Force_table::Interpolation::Cubic })
+    {
+        std::string const name = (interpolation == Force_table::Interpolation::Linear) ? "pair_forces_table_linear" : "pair_forces_table_cubic";
+
+        run_benchmark(name, atoms.size(), num_pairs, [&]()
+        {
+            forces.set_zero();
+            table.calc_forces(atoms.get_span(), atoms.get_span(), forces.get_span(), interpolation);
+            benchmark_sink = forces.get(0)[0];
+        }, settings, results);
+    }
+}
+
+
+void bench_from_state(int const num_atoms, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    std::list<Molecule> molecules = create_molecules(num_atoms);
+
+    run_benchmark("molecule_from_state", num_atoms, double(molecules.size()), [&]()
+    {
+        for (Molecule & m : molecules)
+        {
+            m.from_state(Body_state(), 0.1f);
+        }
+
+        benchmark_sink = molecules.front()._x[0];
+    }, settings, results);
+}
+
+
+void bench_compute_force_and_torque(Core & core, int const num_atoms, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    core.clear();
+
+    for (Molecule const& m : create_molecules(num_atoms))
+    {
+        core.add_molecule(m);
+    }
+
+    std::vector<Eigen::Vector3f> const forces_on_atoms(core.get_num_atoms(), Eigen::Vector3f(0.1f, 0.2f, 0.3f));
+
+    run_benchmark("compute_force_and_torque", core.get_num_atoms(), double(core.get_molecules().size()), [&]()
+    {
+        int atom_index = 0;
+
+        for (Molecule & m : core.get_molecules())
+        {
+            core.compute_force_and_torque(m, atom_index, forces_on_atoms);
+        }
+
+        benchmark_sink = core.get_molecules().front()._force[0];
+    }, settings, results);
+
+    core.clear();
+}
+
+
+void bench_simulation_step(Core & core, int const num_atoms, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    if (!settings.filter.empty() && std::string("simulation_step").find(settings.filter) == std::string::npos &&
+            std::string("checkpoint_save checkpoint_restore").find(settings.filter) == std::string::npos) return;
+
+    Scene_settings scene;
+    scene.num_molecules = std::max(1, num_atoms / 3);
+    scene.num_barriers = 2;
+    scene.num_portals = 1;
+    scene.num_brownian_boxes = 2;
+
+    std::string const file_name = QDir::temp().absoluteFilePath("particular_bench_scene.data").toStdString();
+
+    {
+        Level_data level_data;
+        generate_scene(scene, level_data);
+        save_level_data(level_data, file_name);
+    }
+
+    core.load_level(file_name);
+    core.start_level();
+
+    float const time_step = core.get_parameters()["physics_timestep_ms"]->get_value<int>() / 1000.0f;
+
+    run_benchmark("simulation_step", core.get_num_atoms(), double(core.get_num_atoms()), [&]()
+    {
+        core.update(time_step);
+    }, settings, results);
+
+    Core::Checkpoint checkpoint;
+
+    run_benchmark("checkpoint_save", core.get_num_atoms(), double(core.get_molecules().size()), [&]()
+    {
+        core.save_checkpoint(checkpoint);
+    }, settings, results);
+
+    run_benchmark("checkpoint_restore", core.get_num_atoms(), double(core.get_molecules().size()), [&]()
+    {
+        core.restore_checkpoint(checkpoint);
+    }, settings, results);
+
+    core.clear();
+}
+
+
+void bench_temperature_grid(int const num_boxes, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    Level_data level_data;
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+
+    for (int i = 0; i < num_boxes; ++i)
+    {
+        Eigen::Vector3f const center(position(rng), 0.0f, position(rng) * 0.5f);
+        level_data.add_brownian_element(new Brownian_box(center - Eigen::Vector3f::Constant(3.0f), center + Eigen::Vector3f::Constant(3.0f), 10.0f, 10.0f));
+    }
+
+    Frame_buffer<float> grid = level_data._temperature_grid;
+
+    run_benchmark("temperature_grid", num_boxes, double(grid.get_size()), [&]()
+    {
+        update_temperature_grid(level_data, grid);
+        benchmark_sink = grid.get_data(0);
+    }, settings, results);
+}
+
+
+void bench_image_conversion(int const width, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    QImage image(width, 256, QImage::Format_ARGB32);
+
+    std::mt19937 rng(0);
+
+    for (int y = 0; y < image.height(); ++y)
+    {
+        QRgb * line = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+        for (int x = 0; x < image.width(); ++x)
+        {
+            line[x] = QRgb(rng());
+        }
+    }
+
+    double const num_pixels = double(image.width()) * image.height();
+
+    // the generic conversion through QColor, as the textures were loaded before
+    run_benchmark("image_convert_per_pixel", width, num_pixels, [&]()
+    {
+        benchmark_sink = convert<QColor_to_Color_converter, Color>(image).get_data(0).R;
+    }, settings, results);
+
+    run_benchmark("image_convert_bulk", width, num_pixels, [&]()
+    {
+        benchmark_sink = convert_to_color(image).get_data(0).R;
+    }, settings, results);
+
+    run_benchmark("image_convert_bulk_alpha", width, num_pixels, [&]()
+    {
+        benchmark_sink = convert_to_color4(image).get_data(0).a;
+    }, settings, results);
+}
+
+
+void bench_spatial_structures(int const num_points, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    std::mt19937 rng(0);
+
+    float const extent = 3.0f * std::cbrt(float(num_points));
+    std::uniform_real_distribution<float> position(-0.5f * extent, 0.5f * extent);
+
+    std::vector<Eigen::Vector3f> points(num_points);
+
+    for (Eigen::Vector3f & p : points)
+    {
+        p = Eigen::Vector3f(position(rng), position(rng), position(rng));
+    }
+
+    float const cell_size = 4.0f;
+
+    Spatial_hash<Eigen::Vector3f, int> hash(std::max(64, num_points), cell_size);
+
+    run_benchmark("spatial_hash_build", num_points, double(num_points), [&]()
+    {
+        hash.clear();
+
+        for (int i = 0; i < num_points; ++i)
+        {
+            hash.add_point(points[i], i);
+        }
+    }, settings, results);
+
+    run_benchmark("spatial_hash_query", num_points, double(num_points), [&]()
+    {
+        int found = 0;
+
+        for (Eigen::Vector3f const& p : points)
+        {
+            if (hash.get_closest_point(p + Eigen::Vector3f::Constant(0.1f))) ++found;
+        }
+
+        benchmark_sink = float(found);
+    }, settings, results);
+
+    std::vector<int> data(num_points);
+
+    for (int i = 0; i < num_points; ++i) data[i] = i;
+
+    run_benchmark("bsp_tree_build", num_points, double(num_points), [&]()
+    {
+        Regular_bsp_tree<Eigen::Vector3f, 3, int> tree(Eigen::Vector3f::Constant(-0.5f * extent), Eigen::Vector3f::Constant(0.5f * extent), 10, 10);
+
+        for (int i = 0; i < num_points; ++i)
+        {
+            tree.add_point(points[i], &data[i]);
+        }
+
+        benchmark_sink = float(tree.get_children().size());
+    }, settings, results);
+}
+
+
+void bench_particle_animation(int const num_particles, Benchmark_settings const& settings, std::vector<Benchmark_result> & results)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+
+    std::vector<Targeted_particle> particles(num_particles);
+
+    for (Targeted_particle & p : particles)
+    {
+        p.position = Eigen::Vector3f(position(rng), position(rng), position(rng));
+        p.target = Eigen::Vector3f(position(rng), position(rng), position(rng));
+    }
+
+    Targeted_particle_system system(10.0f);
+    system.init(particles);
+
+    run_benchmark("particle_animation", num_particles, double(num_particles), [&]()
+    {
+        system.animate(0.01f);
+        benchmark_sink = system.get_particles().front().position[0];
+    }, settings, results);
+}
+
+
+std::vector<int> parse_sizes(std::string const& sizes_string)
+{
+    std::vector<int> sizes;
+
+    for (QString const& s : QString::fromStdString(sizes_string).split(",", QString::SkipEmptyParts))
+    {
+        sizes.push_back(s.toInt());
+    }
+
+    return sizes;
+}
+
+std::string get_option(QStringList const& arguments, QString const& name, std::string const& default_value)
+{
+    int const index = arguments.indexOf(name);
+
+    if (index >= 0 && index + 1 < arguments.size())
+    {
+        return arguments[index + 1].toStdString();
+    }
+
+    return default_value;
+}
+
+}
+
+
+int main(int argc, char** argv)
+{
+    QCoreApplication application(argc, argv);
+
+    QStringList const arguments = application.arguments();
+
+    if (arguments.contains("--help"))
+    {
+        std::cout << "Usage: particular_bench [options]\n"
+                  << "  --sizes <n,n,...>      atom counts (default 300,1000,3000)\n"
+                  << "  --filter <text>        only run benchmarks whose name contains the text\n"
+                  << "  --min-time <s>         minimum duration of a measured batch (default 0.2)\n"
+                  << "  --batches <n>          measured batches, the median is reported (default 5)\n"
+                  << "  --output <file>        write the CSV to a file instead of stdout\n";
+        return 0;
+    }
+
+    std::vector<int> const sizes = parse_sizes(get_option(arguments, "--sizes", "300,1000,3000"));
+    std::string const output_file_name = get_option(arguments, "--output", "");
+
+    Benchmark_settings settings;
+    settings.min_batch_seconds = std::stod(get_option(arguments, "--min-time", "0.2"));
+    settings.num_batches = std::max(1, std::stoi(get_option(arguments, "--batches", "5")));
+    settings.filter = get_option(arguments, "--filter", "");
+
+    Core core(false);
+    core.get_parameters()["Force backend"]->set_value(std::string("CPU"));
+    core.get_parameters()["rewind_budget_mb"]->set_value(0); // not part of the measured step
+
+    std::vector<Benchmark_result> results;
+
+    for (int const size : sizes)
+    {
+        std::cerr << "size " << size << std::endl;
+
+        bench_pair_forces(size, settings, results);
+        bench_from_state(size, settings, results);
+        bench_compute_force_and_torque(core, size, settings, results);
+        bench_temperature_grid(std::max(1, size / 100), settings, results);
+        bench_image_conversion(size, settings, results);
+        bench_spatial_structures(size, settings, results);
+        bench_particle_animation(size, settings, results);
+        bench_simulation_step(core, size, settings, results);
+    }
+
+    std::ofstream output_file;
+
+    if (!output_file_name.empty())
+    {
+        output_file.open(output_file_name);
+    }
+
+    std::ostream & out = output_file.is_open() ? output_file : std::cout;
+
+    out << "benchmark,size,iterations,median_ns,min_ns,items_per_second\n";
+
+    for (Benchmark_result const& r : results)
+    {
+        out << r.name << "," << r.size << "," << r.iterations << "," << r.median_ns << "," << r.min_ns << "," << r.items_per_second << "\n";
+    }
+
+    // joins the writer thread, later messages (the core's destructor) are written directly
+    Message_logger::get_instance()->shutdown();
+
+    return 0;
+}
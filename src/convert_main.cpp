@@ -0,0 +1,144 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFileInfo>
+#include <QDir>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+#include "Level_data.h"
+#include "Level_io.h"
+#include "Level_element_exports.h"
+
+// Converts level files between the XML archives and the binary level format (Level_io.h) and prints
+// the file sizes and load times of both forms.
+
+namespace
+{
+
+void print_usage()
+{
+    std::cout << "Usage: particular_convert <level files> [options]\n"
+              << "  --to-xml                   convert binary levels back to XML (default XML to binary)\n"
+              << "  --output-dir <dir>         write the converted files there (default next to the input)\n";
+}
+
+std::string get_option(QStringList const& arguments, QString const& name, std::string const& default_value)
+{
+    int const index = arguments.indexOf(name);
+
+    if (index >= 0 && index + 1 < arguments.size())
+    {
+        return arguments[index + 1].toStdString();
+    }
+
+    return default_value;
+}
+
+// median of a few loads into a fresh Level_data, in milliseconds
+double time_load(std::function<void(Level_data &)> const& load)
+{
+    int const num_runs = 5;
+    std::vector<double> times;
+
+    for (int i = 0; i < num_runs; ++i)
+    {
+        Level_data level_data;
+
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        load(level_data);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    return times[num_runs / 2];
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication application(argc, argv);
+
+    QStringList const arguments = application.arguments();
+
+    if (arguments.size() < 2 || arguments.contains("--help"))
+    {
+        print_usage();
+        return arguments.contains("--help") ? 0 : 1;
+    }
+
+    bool const to_xml = arguments.contains("--to-xml");
+    std::string const output_dir = get_option(arguments, "--output-dir", "");
+
+    int num_failed = 0;
+
+    for (int i = 1; i < arguments.size(); ++i)
+    {
+        if (arguments[i] == "--to-xml") continue;
+        if (arguments[i] == "--output-dir") { ++i; continue; }
+
+        std::string const input_file_name = arguments[i].toStdString();
+        QFileInfo const input_info(arguments[i]);
+
+        std::string xml_file_name;
+        std::string binary_file_name;
+
+        if (to_xml)
+        {
+            binary_file_name = input_file_name;
+            xml_file_name = input_info.dir().filePath(input_info.completeBaseName() + ".data").toStdString();
+        }
+        else
+        {
+            xml_file_name = input_file_name;
+            binary_file_name = get_binary_level_file_name(input_file_name);
+        }
+
+        if (!output_dir.empty())
+        {
+            QDir const dir(QString::fromStdString(output_dir));
+            std::string & output_file_name = to_xml ? xml_file_name : binary_file_name;
+            output_file_name = dir.filePath(QFileInfo(QString::fromStdString(output_file_name)).fileName()).toStdString();
+        }
+
+        try
+        {
+            Level_data level_data;
+
+            if (to_xml)
+            {
+                load_binary_level(level_data, binary_file_name);
+                save_xml_level(level_data, xml_file_name);
+            }
+            else
+            {
+                load_xml_level(level_data, xml_file_name);
+
+                if (!save_binary_level(level_data, binary_file_name))
+                {
+                    ++num_failed;
+                    continue;
+                }
+            }
+
+            double const xml_ms = time_load([&xml_file_name](Level_data & d) { load_xml_level(d, xml_file_name); });
+            double const binary_ms = time_load([&binary_file_name](Level_data & d) { load_binary_level(d, binary_file_name); });
+
+            std::cout << (to_xml ? binary_file_name + " -> " + xml_file_name : xml_file_name + " -> " + binary_file_name) << "\n"
+                      << "  xml_bytes: " << QFileInfo(QString::fromStdString(xml_file_name)).size()
+                      << " binary_bytes: " << QFileInfo(QString::fromStdString(binary_file_name)).size() << "\n"
+                      << "  xml_load_ms: " << xml_ms << " binary_load_ms: " << binary_ms << std::endl;
+        }
+        catch (std::exception const& e)
+        {
+            std::cout << "Couldn't convert " << input_file_name << ": " << e.what() << std::endl;
+            ++num_failed;
+        }
+    }
+
+    return num_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+# Shared settings of the headless targets (particular_sim, particular_bench): no widgets and no GL context.
+# Core is built with PARTICULAR_HEADLESS, which leaves out the options window, the GPU force backend and the level state signal.
+
+QT += \
+    xml
+
+QT -= widgets
+
+CONFIG += \
+    qt \
+    console \
+    warn_on \
+    OpenMesh \
+    eigen3 \
+    boost \
+    c++11
+
+CONFIG -= app_bundle
+
+DEFINES += EIGEN_DISABLE_UNALIGNED_ARRAY_ASSERT PARTICULAR_HEADLESS
+
+profiling {
+    DEFINES += PARTICULAR_PROFILING
+}
+
+win32 {
+    DEFINES += NOMINMAX BOOST_ALL_NO_LIB
+}
+
+EXT_DIR = ../extern
+
+include($$PWD/libs.pri)
+
+INCLUDEPATH += \
+    $${EXT_DIR}
+
+CONFIG(debug, debug|release) {
+    MOC_DIR = build_$${TARGET}/debug/moc
+    OBJECTS_DIR = build_$${TARGET}/debug/obj
+}
+else {
+    MOC_DIR = build_$${TARGET}/release/moc
+    OBJECTS_DIR = build_$${TARGET}/release/obj
+}
+
+!win32 {
+    QMAKE_CXXFLAGS += \
+        -Wall \
+        -Wextra \
+        -fPIC \
+        -ftemplate-depth=512
+    LIBS += -lboost_serialization
+}
+
+win32 {
+    QMAKE_CXXFLAGS += /bigobj /FS
+}
+
+macx {
+    INCLUDEPATH += /opt/local/include
+}
+
+SOURCES += \
+    $$PWD/Atom.cpp \
+    $$PWD/Data_config.cpp \
+    $$PWD/Level_element.cpp \
+    $$PWD/Core.cpp \
+    $$PWD/Molecule_releaser.cpp \
+    $$PWD/Particle_system.cpp \
+    $$PWD/Level_data.cpp \
+    $$PWD/PolygonalCurve.cpp \
+    $$PWD/Score.cpp \
+    $$PWD/Force_table.cpp \
+    $$PWD/Force_field.cpp \
+    $$PWD/Scene_generator.cpp \
+    $$PWD/Geometry_utils.cpp \
+    $$PWD/Color.cpp \
+    $$PWD/Color_utilities.cpp \
+    $$PWD/Frame_buffer.cpp \
+    $$PWD/Parameter.cpp \
+    $$PWD/Profiler.cpp \
+    $$PWD/Memory_accounting.cpp \
+    $$PWD/Input_recording.cpp \
+    $$PWD/Level_io.cpp \
+    $$PWD/Level_cache.cpp \
+    $$PWD/Checkpoint_buffer.cpp \
+    $$PWD/Rewind_buffer.cpp \
+    $$PWD/Trajectory.cpp \
+    $$PWD/Message_logger.cpp
+
+HEADERS += \
+    $$PWD/Atom.h \
+    $$PWD/Core.h \
+    $$PWD/Atomic_force.h \
+    $$PWD/Force_table.h \
+    $$PWD/Force_field.h \
+    $$PWD/Scene_generator.h \
+    $$PWD/Atom_soa.h \
+    $$PWD/Eigen_Matrix_serializer.h \
+    $$PWD/End_condition.h \
+    $$PWD/Level_data.h \
+    $$PWD/Level_element_exports.h \
+    $$PWD/Particle_system.h \
+    $$PWD/unique_ptr_serialization.h \
+    $$PWD/Sensor_data.h \
+    $$PWD/Progress.h \
+    $$PWD/Score.h \
+    $$PWD/Data_config.h \
+    $$PWD/Level_element.h \
+    $$PWD/Molecule_releaser.h \
+    $$PWD/Random_generator.h \
+    $$PWD/Profiler.h \
+    $$PWD/Timing_window.h \
+    $$PWD/Time_series.h \
+    $$PWD/Memory_accounting.h \
+    $$PWD/Input_recording.h \
+    $$PWD/Level_io.h \
+    $$PWD/Level_cache.h \
+    $$PWD/Checkpoint_buffer.h \
+    $$PWD/Rewind_buffer.h \
+    $$PWD/Trajectory.h \
+    $$PWD/Spsc_queue.h \
+    $$PWD/Mpsc_queue.h \
+    $$PWD/Message_logger.h \
+    $$PWD/Low_discrepancy_sequences.h \
+    $$PWD/Registry.h \
+    $$PWD/Registry_parameters.h \
+    $$PWD/Geometry_utils.h \
+    $$PWD/Color.h \
+    $$PWD/Color_utilities.h \
+    $$PWD/Frame_buffer.h \
+    $$PWD/PolygonalCurve.h \
+    $$PWD/Utilities.h \
+    $$PWD/Parameter.h
@@ -5,6 +5,7 @@
 #include "Before_start_screen.h"
 #include "Main_menu_screen.h"
 #include "Statistics_screen.h"
+#include "Message_logger.h"
 
 Level_picker_screen::Level_picker_screen(My_viewer & viewer, Core & core, Screen *calling_screen) :
     Menu_screen(viewer, core), _calling_screen(calling_screen)
@@ -81,7 +82,7 @@ void Level_picker_screen::init()
 
 void Level_picker_screen::play_level(std::string const& level_name)
 {
-    std::cout << __FUNCTION__ << " name: " << level_name << std::endl;
+    LOG_DEBUG("name: " << level_name);
 
     int const level_index = _core.get_level_names().indexOf(QString::fromStdString(level_name));
 
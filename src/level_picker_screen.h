@@ -10,6 +10,7 @@ class Level_picker_screen : public Menu_screen
 {
 public:
     Level_picker_screen(My_viewer & viewer, Core & core, Screen * calling_screen);
+    char const* get_name() const override { return "Level_picker_screen"; }
 
     void init();
 
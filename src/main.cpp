@@ -10,17 +10,9 @@
 #include "Spatial_hash.h"
 #include "End_condition.h"
 #include "Data_config.h"
-
-BOOST_CLASS_EXPORT_GUID(Box_barrier, "Box_barrier")
-BOOST_CLASS_EXPORT_GUID(Plane_barrier, "Plane_barrier")
-//BOOST_CLASS_EXPORT_GUID(Moving_box_barrier, "Moving_box_barrier")
-BOOST_CLASS_EXPORT_GUID(Molecule_releaser, "Molecule_releaser")
-BOOST_CLASS_EXPORT_GUID(Box_portal, "Box_portal")
-BOOST_CLASS_EXPORT_GUID(Sphere_portal, "Sphere_portal")
-BOOST_CLASS_EXPORT_GUID(Brownian_box, "Brownian_box")
-BOOST_CLASS_EXPORT_GUID(Tractor_barrier, "Tractor_barrier")
-BOOST_CLASS_EXPORT_GUID(Charged_barrier, "Charged_barrier")
-BOOST_CLASS_EXPORT_GUID(Molecule_capture_condition, "Molecule_capture_condition")
+#include "Level_element_exports.h"
+#include "Profiler.h"
+#include "Asset_preloader.h"
 
 //extern "C"
 //{
@@ -45,14 +37,74 @@ int main(int argc, char** argv)
 
     Message_logger::get_instance()->init("log.txt");
 
-    Core core(use_unstable_options);
+    // --profile <file>: capture from the start and write a Chrome trace on exit
+    int const profile_index = arguments.indexOf("--profile");
+    bool const profile = profile_index >= 0 && profile_index + 1 < arguments.size();
+
+    if (profile)
+    {
+        Profiler::get_instance()->set_enabled(true);
+    }
+
+    // shaders, meshes and textures of the first screens are read while the core and the viewer are set up,
+    // the time to the first frame is logged by My_viewer
+    Asset_preloader::get_instance()->start();
+
+    int result = 0;
+
+    // everything that logs is gone before the logger shuts down
+    {
+        Core core(use_unstable_options);
+
+        QGLFormat format;
+        format.setSwapInterval(1);
+
+        My_viewer * viewer = new My_viewer(core, format);
+        viewer->show();
+        viewer->start();
+
+        // --record <file>: record the input of the last started level, written on exit
+        // --replay <file>: play back a recording instead of the main menu
+        int const record_index = arguments.indexOf("--record");
+        bool const record = record_index >= 0 && record_index + 1 < arguments.size();
 
-    QGLFormat format;
-    format.setSwapInterval(1);
+        if (record)
+        {
+            core.start_input_recording();
+        }
+
+        int const replay_index = arguments.indexOf("--replay");
+
+        if (replay_index >= 0 && replay_index + 1 < arguments.size())
+        {
+            viewer->start_input_replay(arguments[replay_index + 1].toStdString());
+        }
+
+        // --playback <file>: show a trajectory recorded by particular_sim --trajectory
+        int const playback_index = arguments.indexOf("--playback");
+
+        if (playback_index >= 0 && playback_index + 1 < arguments.size())
+        {
+            viewer->start_trajectory_playback(arguments[playback_index + 1].toStdString());
+        }
+
+        result = application.exec();
+
+        if (record)
+        {
+            core.save_input_recording(arguments[record_index + 1].toStdString());
+        }
+
+        delete viewer;
+    }
+
+    if (profile)
+    {
+        Profiler::get_instance()->set_enabled(false);
+        Profiler::get_instance()->export_chrome_trace(arguments[profile_index + 1].toStdString());
+    }
 
-    My_viewer * viewer = new My_viewer(core, format);
-    viewer->show();
-    viewer->start();
+    Message_logger::get_instance()->shutdown();
 
-    return application.exec();
+    return result;
 }
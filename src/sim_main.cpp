@@ -0,0 +1,311 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <QFileInfo>
+#include <QDir>
+
+#include <chrono>
+#include <iostream>
+
+#include "Core.h"
+#include "Score.h"
+#include "Data_config.h"
+#include "Scene_generator.h"
+#include "Level_element_exports.h"
+#include "Profiler.h"
+#include "Memory_accounting.h"
+#include "Level_cache.h"
+#include "Trajectory.h"
+#include "Message_logger.h"
+
+// Headless level runner: loads a level, runs the simulation for a fixed simulated time as fast as possible
+// on the CPU force backend and prints the throughput and the end state. No window and no GL context.
+
+namespace
+{
+
+void print_usage()
+{
+    std::cout << "Usage: particular_sim <level file or level name> [options]\n"
+              << "       particular_sim --generate <number of molecules> [scene options] [options]\n"
+              << "  --seconds <s>              simulated seconds to run (default 60)\n"
+              << "  --backend <field|table>    force field kernels or force table lookup (default field)\n"
+              << "  --interpolation <linear|cubic> force table interpolation (default linear)\n"
+              << "  --timestep-ms <ms>         physics time step (default from the simulation settings)\n"
+              << "  --no-midpoint              use the explicit Euler step instead of the midpoint integration\n"
+              << "  --stop-when-finished       stop as soon as the level is finished\n"
+              << "  --profile <file>           write a Chrome trace of the run (needs a CONFIG+=profiling build)\n"
+              << "  --record <file>            write an input recording (level, settings, seed) of the run\n"
+              << "  --no-level-cache           parse XML levels instead of using the precompiled level cache\n"
+              << "  --trajectory <file>        stream the molecule states to a compressed trajectory file\n"
+              << "  --trajectory-interval <n>  physics steps between trajectory frames (default 1)\n"
+              << "  --trajectory-forces        also record the forces on all atoms\n"
+              << "  --replay <file>            replay an input recording from the game or particular_sim instead of a level,\n"
+              << "                             runs the recorded number of steps with the recorded time step and settings,\n"
+              << "                             --backend, --interpolation and --no-midpoint override the recorded ones\n"
+              << "Scene options:\n"
+              << "  --density <d>              molecules per cubic unit (default 0.03)\n"
+              << "  --mix <w,s,n,d>            weights of water, sulfate, Na+/Cl- and dipoles (default 1,0,0,0)\n"
+              << "  --barriers <n> --portals <n> --brownian-boxes <n>   level elements (default 0, 1, 0)\n"
+              << "  --seed <n>                 random seed (default 0)\n"
+              << "  --save <file>              keep the generated level file\n";
+}
+
+std::string get_option(QStringList const& arguments, QString const& name, std::string const& default_value)
+{
+    int const index = arguments.indexOf(name);
+
+    if (index >= 0 && index + 1 < arguments.size())
+    {
+        return arguments[index + 1].toStdString();
+    }
+
+    return default_value;
+}
+
+// When replaying, the recorded settings stay unless the option was passed, and the time step is always the recorded one.
+void apply_simulation_options(QStringList const& arguments, Parameter_list & parameters, bool const replay)
+{
+    parameters["Force backend"]->set_value(std::string("CPU"));
+
+    if (!replay || arguments.contains("--backend"))
+    {
+        parameters["Use force table"]->set_value(get_option(arguments, "--backend", "field") == "table");
+    }
+
+    if (!replay || arguments.contains("--interpolation"))
+    {
+        parameters["Force table interpolation"]->set_value(std::string(get_option(arguments, "--interpolation", "linear") == "cubic" ? "Cubic" : "Linear"));
+    }
+
+    if (arguments.contains("--no-midpoint"))
+    {
+        parameters["Use midpoint"]->set_value(false);
+    }
+
+    std::string const timestep_ms = get_option(arguments, "--timestep-ms", "");
+
+    if (!replay && !timestep_ms.empty())
+    {
+        parameters["physics_timestep_ms"]->set_value(std::stoi(timestep_ms));
+    }
+}
+
+}
+
+
+int main(int argc, char** argv)
+{
+    QCoreApplication application(argc, argv);
+
+    QStringList const arguments = application.arguments();
+
+    if (arguments.size() < 2 || arguments.contains("--help"))
+    {
+        print_usage();
+        return arguments.contains("--help") ? 0 : 1;
+    }
+
+    float const simulated_seconds = std::stof(get_option(arguments, "--seconds", "60"));
+    std::string const backend = get_option(arguments, "--backend", "field");
+
+    if (backend != "field" && backend != "table")
+    {
+        std::cout << "Unknown backend: " << backend << std::endl;
+        print_usage();
+        return 1;
+    }
+
+    Core core(false);
+
+    Level_cache::get_instance()->set_enabled(!arguments.contains("--no-level-cache"));
+
+    Parameter_list & parameters = core.get_parameters();
+
+    std::string const replay_file_name = get_option(arguments, "--replay", "");
+    std::string const record_file_name = get_option(arguments, "--record", "");
+
+    std::string level_file_name;
+
+    if (!replay_file_name.empty())
+    {
+        if (!core.start_input_replay(replay_file_name))
+        {
+            return 1;
+        }
+
+        apply_simulation_options(arguments, parameters, true);
+
+        level_file_name = replay_file_name;
+    }
+    else if (arguments.contains("--generate"))
+    {
+        Scene_settings scene;
+        scene.num_molecules = std::stoi(get_option(arguments, "--generate", "1000"));
+        scene.density = std::stof(get_option(arguments, "--density", "0.03"));
+        scene.num_barriers = std::stoi(get_option(arguments, "--barriers", "0"));
+        scene.num_portals = std::stoi(get_option(arguments, "--portals", "1"));
+        scene.num_brownian_boxes = std::stoi(get_option(arguments, "--brownian-boxes", "0"));
+        scene.seed = std::stoul(get_option(arguments, "--seed", "0"));
+
+        QStringList const mix = QString::fromStdString(get_option(arguments, "--mix", "1,0,0,0")).split(",");
+
+        if (mix.size() == 4)
+        {
+            scene.water_weight = mix[0].toFloat();
+            scene.sulfate_weight = mix[1].toFloat();
+            scene.salt_weight = mix[2].toFloat();
+            scene.dipole_weight = mix[3].toFloat();
+        }
+
+        level_file_name = get_option(arguments, "--save", QDir::temp().absoluteFilePath("particular_generated_scene.data").toStdString());
+
+        Level_data level_data;
+        generate_scene(scene, level_data);
+        save_level_data(level_data, level_file_name);
+    }
+    else
+    {
+        QString const level_argument = arguments[1];
+        level_file_name = QFileInfo(level_argument).exists() ? level_argument.toStdString() : core.get_level_file_name(level_argument.toStdString());
+    }
+
+    double load_milliseconds = 0.0;
+
+    if (replay_file_name.empty())
+    {
+        apply_simulation_options(arguments, parameters, false);
+
+        if (!record_file_name.empty())
+        {
+            core.start_input_recording();
+        }
+
+        std::chrono::steady_clock::time_point const load_start = std::chrono::steady_clock::now();
+        core.load_level(level_file_name);
+        load_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+
+        core.start_level();
+    }
+
+    // no rewind history, also when the replayed recording has it on
+    parameters["rewind_budget_mb"]->set_value(0);
+
+    // the physics timer started by start_level() never fires, there is no event loop
+    float const time_step = parameters["physics_timestep_ms"]->get_value<int>() / 1000.0f * parameters["physics_speed"]->get_value<float>();
+    bool const stop_when_finished = arguments.contains("--stop-when-finished");
+
+    int num_steps = 0;
+    unsigned long long const start_atom_pairs = core.get_num_evaluated_atom_pairs();
+
+    std::string const trajectory_file_name = get_option(arguments, "--trajectory", "");
+
+    if (!trajectory_file_name.empty() &&
+            !core.start_trajectory_recording(trajectory_file_name, std::stoi(get_option(arguments, "--trajectory-interval", "1")), arguments.contains("--trajectory-forces")))
+    {
+        return 1;
+    }
+
+    std::string const profile_file_name = get_option(arguments, "--profile", "");
+
+    if (!profile_file_name.empty())
+    {
+        Profiler::get_instance()->set_enabled(true);
+    }
+
+    std::chrono::steady_clock::time_point const timer_start = std::chrono::steady_clock::now();
+
+    bool const replay = !replay_file_name.empty();
+
+    while (replay ? core.is_replaying_input() : core.get_current_time() < simulated_seconds)
+    {
+        core.update(time_step);
+        ++num_steps;
+
+        if (stop_when_finished && core.get_game_state() == Core::Game_state::Finished) break;
+    }
+
+    std::chrono::steady_clock::time_point const timer_end = std::chrono::steady_clock::now();
+
+    // the writer's remaining blocks are not part of the measured run
+    core.stop_trajectory_recording();
+
+    if (!profile_file_name.empty())
+    {
+        Profiler::get_instance()->set_enabled(false);
+        Profiler::get_instance()->export_chrome_trace(profile_file_name);
+    }
+
+    if (!record_file_name.empty())
+    {
+        core.save_input_recording(record_file_name);
+    }
+
+    double const elapsed_seconds = std::chrono::duration<double>(timer_end - timer_start).count();
+    double const atom_pairs = double(core.get_num_evaluated_atom_pairs() - start_atom_pairs);
+
+    int num_captured_molecules = 0;
+    int num_molecules_to_capture = 0;
+
+    for (Portal const* p : core.get_level_data()._portals)
+    {
+        num_captured_molecules += p->get_condition().get_num_captured_molecules();
+        num_molecules_to_capture += p->get_condition().get_min_captured_molecules();
+    }
+
+    std::cout << "level: " << level_file_name << "\n"
+              << "backend: " << (parameters["Use force table"]->get_value<bool>() ? "table" : "field") << "\n"
+              << "load_ms: " << load_milliseconds << "\n"
+              << "molecules: " << core.get_molecules().size() << "\n"
+              << "atoms: " << core.get_num_atoms() << "\n"
+              << "simulated_seconds: " << core.get_current_time() << "\n"
+              << "wall_seconds: " << elapsed_seconds << "\n"
+              << "steps: " << num_steps << "\n"
+              << "steps_per_second: " << num_steps / elapsed_seconds << "\n"
+              << "atom_pairs_per_second: " << atom_pairs / elapsed_seconds << "\n"
+              << "realtime_factor: " << core.get_current_time() / elapsed_seconds << "\n"
+              << "finished: " << (core.get_game_state() == Core::Game_state::Finished) << "\n"
+              << "captured_molecules: " << num_captured_molecules << " / " << num_molecules_to_capture << "\n";
+
+    // over the last steps only, see Core::get_physics_step_times()
+    Timing_window const& step_times = core.get_physics_step_times();
+
+    std::cout << "step_ms_p50: " << step_times.get_percentile(0.5f) << "\n"
+              << "step_ms_p95: " << step_times.get_percentile(0.95f) << "\n"
+              << "step_ms_p99: " << step_times.get_percentile(0.99f) << "\n"
+              << "force_ms_mean: " << core.get_force_evaluation_times().get_mean() << "\n";
+
+    if (Trajectory_recorder const* recorder = core.get_trajectory_recorder())
+    {
+        std::cout << "trajectory_frames: " << recorder->get_num_frames() << " dropped " << recorder->get_num_dropped_frames() << "\n"
+                  << "trajectory_bytes: " << recorder->get_compressed_bytes() << " raw " << recorder->get_raw_bytes() << "\n"
+                  << "trajectory_add_frame_ms: " << recorder->get_add_frame_milliseconds()
+                  << " (" << recorder->get_add_frame_milliseconds() / (elapsed_seconds * 10.0) << "% of the wall time)\n";
+    }
+
+    Memory_accounting const* memory = Memory_accounting::get_instance();
+
+    std::cout << "memory_bytes_total: " << memory->get_total_current() << " peak " << memory->get_total_peak() << "\n";
+
+    for (int i = 0; i < int(Memory_subsystem::Num_subsystems); ++i)
+    {
+        Memory_subsystem const subsystem = Memory_subsystem(i);
+
+        std::cout << "memory_bytes_" << Memory_accounting::get_name(subsystem) << ": " << memory->get_current(subsystem) << " peak " << memory->get_peak(subsystem) << "\n";
+    }
+
+    if (num_molecules_to_capture > 0)
+    {
+        Score score;
+        score.sensor_data = core.get_sensor_data();
+        score.calculate_score(core.get_level_data()._score_time_factor, num_molecules_to_capture);
+
+        std::cout << "score: " << score.final_score << "\n";
+    }
+
+    std::cout << std::flush;
+
+    // also writes the messages of the profile export and the recording
+    Message_logger::get_instance()->shutdown();
+
+    return 0;
+}